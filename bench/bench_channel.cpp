@@ -0,0 +1,170 @@
+/**
+ * 电机通信链路基准测试
+ * 用MotorEmulator代替实机，运行未修改的send_command_and_wait()与channel_thread()，
+ * 输出每个电机的往返时延p50/p99/p99.9以及通道线程实际达到的循环频率
+ *
+ * 用法: bench_channel [秒数] [应答延时us] [抖动us] [杂散字节概率] [拆帧间隔us] [thread|reactor] [故障电机丢包率]
+ * reactor模式下阶段2改为运行motor_reactor_thread()，并输出每条总线的周期耗时；
+ * thread模式下输出每个电机的调度统计(超时估计、跳过和迟到次数)和每个通道线程的周期循环统计。故障电机为通道0的电机1
+ * 两种模式最后都输出阶段2的时延直方图(往返时延、重试次数、周期间隔和周期占用时间)
+ */
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "motor_emulator.hpp"
+#include "motor_control.hpp"
+#include "serial_init.hpp"
+#include "motor_reactor.hpp"
+#include "motor_scheduler.hpp"
+#include "motor_metrics.hpp"
+#include "periodic_loop.hpp"
+#include "bench_stats.hpp"
+
+/**
+ * 阶段1: 每个通道一个线程，按1khz节拍直接调用send_command_and_wait()，记录每个电机的往返时延
+ */
+static void measure_round_trip(int channel, int loops, std::vector<std::vector<double>>& rtt_us, std::vector<int>& failures) {
+    char port_name[128];
+    snprintf(port_name, sizeof(port_name), "%s%c", g_motor_port_prefix, 'A' + channel);
+    int fd = initialize_serial_port(port_name);
+    if (fd < 0) {
+        for (auto& f : failures) f = loops;
+        return;
+    }
+    fcntl(fd, F_SETFL, 0);
+
+    auto next_send_time = std::chrono::steady_clock::now();
+    for (int n = 0; n < loops; ++n) {
+        next_send_time += std::chrono::milliseconds(1);
+        for (int m = 0; m < MOTORS_PER_CHANNEL; ++m) {
+            Motor::ControlData_t cmd = g_motors[channel][m].createControlPacket(m);
+            Motor::RecvData_t response;
+            auto t0 = std::chrono::steady_clock::now();
+            bool ok = send_command_and_wait(fd, cmd, response, m);
+            auto t1 = std::chrono::steady_clock::now();
+            if (ok) {
+                rtt_us[m].push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+            } else {
+                failures[m]++;
+            }
+        }
+        std::this_thread::sleep_until(next_send_time);
+    }
+    close(fd);
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 5.0;
+    uint32_t latency_us = argc > 2 ? (uint32_t)atoi(argv[2]) : 100;
+    uint32_t jitter_us = argc > 3 ? (uint32_t)atoi(argv[3]) : 20;
+    float garbage_rate = argc > 4 ? (float)atof(argv[4]) : 0.0f;
+    uint32_t split_gap_us = argc > 5 ? (uint32_t)atoi(argv[5]) : 0;
+    bool use_reactor = argc > 6 && strcmp(argv[6], "reactor") == 0;
+    float flaky_drop_rate = argc > 7 ? (float)atof(argv[7]) : 0.0f;
+
+    char link_dir[] = "/tmp/robot_dog_emu_XXXXXX";
+    if (mkdtemp(link_dir) == NULL) {
+        std::cerr << "Failed to create temp dir" << std::endl;
+        return 1;
+    }
+
+    MotorEmulator emulator;
+    emulator.setAllMotorConfig({latency_us, jitter_us, 0.0f, garbage_rate, split_gap_us});
+    emulator.setMotorConfig(0, 1, {latency_us, jitter_us, flaky_drop_rate, garbage_rate, split_gap_us});
+    if (!emulator.start(link_dir)) {
+        return 1;
+    }
+    g_motor_port_prefix = emulator.getPortPrefix();
+
+    std::cout << "Emulated reply latency: " << latency_us << " us + jitter " << jitter_us << " us"
+              << ", garbage rate " << garbage_rate << ", split gap " << split_gap_us << " us" << std::endl;
+
+    // ——— 阶段1: 往返时延 ———
+    int loops = (int)(seconds * 1000);
+    std::vector<std::vector<std::vector<double>>> rtt(NUM_CHANNELS,
+        std::vector<std::vector<double>>(MOTORS_PER_CHANNEL));
+    std::vector<std::vector<int>> failures(NUM_CHANNELS, std::vector<int>(MOTORS_PER_CHANNEL, 0));
+    {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < NUM_CHANNELS; ++i) {
+            threads.emplace_back(measure_round_trip, i, loops, std::ref(rtt[i]), std::ref(failures[i]));
+        }
+        for (auto& t : threads) t.join();
+    }
+
+    std::cout << "\nRound trip (send_command_and_wait), us\n";
+    std::cout << "Channel | Motor | Samples |    p50 |    p99 |  p99.9 |    max | Fail\n";
+    std::cout << "--------|-------|---------|--------|--------|--------|--------|-----\n";
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
+            auto& s = rtt[i][j];
+            std::sort(s.begin(), s.end());
+            printf("%7d | %5d | %7zu | %6.1f | %6.1f | %6.1f | %6.1f | %4d\n",
+                   i, j, s.size(), percentile(s, 50), percentile(s, 99), percentile(s, 99.9),
+                   s.empty() ? 0.0 : s.back(), failures[i][j]);
+        }
+    }
+
+    // ——— 阶段2: 通道线程循环频率 ———
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
+            g_motors[i][j].resetStats();
+        }
+    }
+    g_running = true;
+    std::unique_ptr<MotorMetricsSnapshot_t> metrics_start(new MotorMetricsSnapshot_t);
+    std::unique_ptr<MotorMetricsSnapshot_t> metrics_end(new MotorMetricsSnapshot_t);
+    std::unique_ptr<MotorMetricsSnapshot_t> metrics(new MotorMetricsSnapshot_t);
+    motor_metrics_snapshot(*metrics_start);
+    auto t_start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    if (use_reactor) {
+        threads.emplace_back(motor_reactor_thread);
+    } else {
+        for (int i = 0; i < NUM_CHANNELS; ++i) {
+            threads.emplace_back(channel_thread, i);
+        }
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    g_running = false;
+    for (auto& t : threads) t.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+
+    std::cout << "\n" << (use_reactor ? "motor_reactor_thread" : "channel_thread") << " loop rate over " << std::fixed << std::setprecision(2) << elapsed << " s\n";
+    std::cout << "Channel | Motor | Sent | Received | Rate (Hz)\n";
+    std::cout << "--------|-------|------|----------|----------\n";
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
+            uint64_t sent = g_motors[i][j].getSendCount();
+            uint64_t received = g_motors[i][j].getReceiveCount();
+            printf("%7d | %5d | %4lu | %8lu | %9.1f\n", i, j, sent, received, sent / elapsed);
+        }
+    }
+
+    if (use_reactor) {
+        std::cout << "\nBus cycle time\n";
+        print_reactor_statistics();
+    } else {
+        std::cout << "\nScheduler\n";
+        print_motor_sched_statistics();
+        std::cout << "\nPeriodic loops\n";
+        print_periodic_loop_statistics();
+    }
+
+    std::cout << "\nLatency histograms\n";
+    motor_metrics_snapshot(*metrics_end);
+    motor_metrics_subtract(*metrics_end, *metrics_start, *metrics);
+    print_motor_metrics(*metrics);
+
+    emulator.stop();
+    rmdir(link_dir);
+    return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * IMU读取路径基准测试
+ * 用ImuEmulator代替IMU，未修改的IMU::serial_init()打开PTY，IMU::run_reader()在独立线程中解析，
+ * 另一个线程以1khz轮询read_latest()(与algorithm_control_thread()相同)。每个推送频率输出：
+ * 推送/解析的帧数和丢失数(扣除被有意损坏的帧)、CRC错误数与损坏数的对照、仿真器因线路忙丢弃的组数、
+ * 0x41从设备采样到被解析完成的时延(设备时钟与CLOCK_MONOTONIC相同，不设偏移)。
+ * 最后离线测量parse_byte()的吞吐量
+ *
+ * 用法: bench_imu [秒数] [频率hz(0=依次200/500/1000)] [损坏概率] [拆段字节数] [抖动us] [波特率(0=不限)]
+ */
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+#include "imu.hpp"
+#include "imu_emulator.hpp"
+#include "motor_control.hpp"
+#include "protocol_codec.hpp"
+#include "latency_histogram.hpp"
+#include "rt_util.hpp"
+
+static ImuStats_t stats_delta(const ImuStats_t& a, const ImuStats_t& b) {
+    ImuStats_t d;
+    d.bytes = b.bytes - a.bytes;
+    d.frames_att = b.frames_att - a.frames_att;
+    d.frames_vel = b.frames_vel - a.frames_vel;
+    d.frames_acc = b.frames_acc - a.frames_acc;
+    d.frames_other = b.frames_other - a.frames_other;
+    d.crc8_errors = b.crc8_errors - a.crc8_errors;
+    d.crc16_errors = b.crc16_errors - a.crc16_errors;
+    d.tail_errors = b.tail_errors - a.tail_errors;
+    d.discarded_bytes = b.discarded_bytes - a.discarded_bytes;
+    d.published = b.published - a.published;
+    return d;
+}
+
+/**
+ * 以给定推送模型运行一次，返回是否没有意外丢帧
+ */
+static bool run_once(const char* link_dir, double seconds, const ImuEmulator::ImuConfig_t& cfg) {
+    ImuEmulator emu;
+    emu.setConfig(cfg);
+    if (!emu.start(link_dir)) return false;
+
+    IMU local;
+    local.serial_init(emu.getPortName());
+
+    ImuStats_t before = get_imu_stats();
+    g_running = true;
+    std::thread reader([&local]() { local.run_reader(); });
+
+    // 1khz轮询，记录每个新样本从设备采样到被解析的时延(us)
+    LatencyHistogram age;
+    uint32_t last_seq = 0;
+    uint64_t samples = 0, seq_gaps = 0;
+    int64_t end_ns = steady_ns() + (int64_t)(seconds * 1e9);
+    while (steady_ns() < end_ns) {
+        IMU::ImuSample_t s;
+        if (local.read_latest(s) && s.seq != last_seq) {
+            if (last_seq != 0 && s.seq != last_seq + 1) seq_gaps++;
+            last_seq = s.seq;
+            samples++;
+            age.record((uint32_t)std::max<int64_t>(0, s.stamp_ns / 1000 - s.data.Timestamp));
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(1000));
+    }
+
+    // 暂停推送，等已写出的数据解析完，两边的计数在同一时刻取
+    emu.setPaused(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ImuStats_t d = stats_delta(before, get_imu_stats());
+    uint64_t sent = emu.getFrameCount(0x41) + emu.getFrameCount(0x60) + emu.getFrameCount(0x62);
+    uint64_t corrupt = emu.getCorruptCount();
+    // 恢复推送，读取线程收到数据后检查退出标志
+    g_running = false;
+    emu.setPaused(false);
+    reader.join();
+    emu.stop();
+
+    uint64_t parsed = d.frames_att + d.frames_vel + d.frames_acc;
+    uint64_t errors = d.crc8_errors + d.crc16_errors + d.tail_errors;
+    int64_t lost = (int64_t)sent - (int64_t)corrupt - (int64_t)parsed;
+
+    LatencyHistSnapshot_t snap;
+    age.snapshot(snap);
+    printf("%5u Hz | sent %7lu | parsed %7lu | corrupt %5lu | crc/tail err %5lu | lost %4ld | overrun %5lu"
+           " | %6.1f KB/s | polled %6lu gaps %5lu | age p50 %6.1f p99 %6.1f max %7.1f us\n",
+           cfg.rate_hz, sent, parsed, corrupt, errors, (long)lost, emu.getOverrunCount(),
+           d.bytes / seconds / 1024.0, samples, seq_gaps,
+           (double)latency_hist_quantile(snap, 0.5), (double)latency_hist_quantile(snap, 0.99),
+           (double)latency_hist_max(snap));
+    return lost <= 0;
+}
+
+/**
+ * 离线吞吐量：把预先打包的帧流逐字节送入parse_byte()
+ */
+static void parse_throughput() {
+    const int groups = 100000;
+    std::vector<uint8_t> stream;
+    stream.resize((size_t)groups * 3 * (FDILINK_OVERHEAD + 48));
+    IMU::IMUData_t att = {};
+    IMU::IMUData_MSG_BODY_VEL vel = {};
+    IMU::IMUData_MSG_BODY_ACCELERATION acc = {};
+    size_t len = 0;
+    uint8_t seq = 0;
+    for (int i = 0; i < groups; ++i) {
+        att.Timestamp = i;
+        len += fdilink_encode(stream.data() + len, 0x41, seq++, att);
+        len += fdilink_encode(stream.data() + len, 0x60, seq++, vel);
+        len += fdilink_encode(stream.data() + len, 0x62, seq++, acc);
+    }
+
+    IMU local;
+    uint64_t frames = 0;
+    int64_t t0 = steady_ns();
+    for (size_t i = 0; i < len; ++i) {
+        if (local.parse_byte(stream[i]) >= 0) frames++;
+    }
+    int64_t dt = steady_ns() - t0;
+    printf("\nparse_byte(): %zu bytes, %lu frames in %.2f ms, %.1f MB/s, %.1f ns/frame\n",
+           len, frames, dt / 1e6, len / (dt / 1e9) / 1e6, (double)dt / frames);
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 3.0;
+    uint32_t rate = argc > 2 ? (uint32_t)atoi(argv[2]) : 0;
+    float corrupt = argc > 3 ? (float)atof(argv[3]) : 0.0f;
+    uint32_t split = argc > 4 ? (uint32_t)atoi(argv[4]) : 0;
+    uint32_t jitter = argc > 5 ? (uint32_t)atoi(argv[5]) : 0;
+    uint32_t baud = argc > 6 ? (uint32_t)atoi(argv[6]) : 921600;
+
+    char link_dir[] = "/tmp/robot_dog_imu_XXXXXX";
+    if (mkdtemp(link_dir) == NULL) {
+        std::cerr << "Failed to create temp dir" << std::endl;
+        return 1;
+    }
+
+    std::vector<uint32_t> rates;
+    if (rate > 0) rates.push_back(rate);
+    else rates = {200, 500, 1000};
+
+    std::cout << "IMU emulator: corrupt " << corrupt << ", split " << split << " B, jitter " << jitter
+              << " us, baud " << baud << ", " << seconds << " s per rate\n\n";
+    bool ok = true;
+    for (uint32_t r : rates) {
+        ImuEmulator::ImuConfig_t cfg = {r, jitter, split, split > 0 ? 20u : 0u, corrupt, baud, 0, 0.0};
+        ok = run_once(link_dir, seconds, cfg) && ok;
+    }
+    rmdir(link_dir);
+
+    parse_throughput();
+    std::cout << (ok ? "OK" : "UNEXPECTED LOSS") << std::endl;
+    return ok ? 0 : 1;
+}
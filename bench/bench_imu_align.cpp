@@ -0,0 +1,111 @@
+/**
+ * IMU时间对齐基准测试
+ * ImuEmulator的设备时钟带偏移和漂移，IMU::run_reader()在独立线程中解析并估计时钟映射，
+ * 1khz线程(与algorithm_control_thread()相同的PeriodicLoop)在每个节拍读取最新样本并外推到节拍时刻。
+ * 仿真器可以给出任意时刻的真实姿态，据此输出：
+ *   映射误差：估计的采样时刻 - 真实采样时刻(热身两个估计窗口之后)
+ *   样本年龄：节拍时刻 - 采样时刻
+ *   节拍时刻的横滚/俯仰角与角速度误差：直接使用最新样本 vs 外推
+ *
+ * 用法: bench_imu_align [秒数] [频率hz] [时钟偏移us] [漂移ppm] [抖动us]
+ */
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+#include "imu.hpp"
+#include "imu_clock.hpp"
+#include "imu_emulator.hpp"
+#include "motor_control.hpp"
+#include "periodic_loop.hpp"
+#include "latency_histogram.hpp"
+#include "rt_util.hpp"
+
+/**
+ * @brief 节拍时刻的误差累计
+ */
+typedef struct {
+    double angle_sq;  // 横滚、俯仰角误差平方和(rad^2)
+    double rate_sq;   // 三轴角速度误差平方和((rad/s)^2)
+    double angle_max;
+    long n;
+} AlignError_t;
+
+static void accumulate(AlignError_t& e, const IMU::IMUData_t& est, const IMU::IMUData_t& truth) {
+    double dr = est.Roll - truth.Roll, dp = est.Pitch - truth.Pitch;
+    double w0 = est.RollSpeed - truth.RollSpeed, w1 = est.aPitchSpeedcc_y - truth.aPitchSpeedcc_y;
+    double w2 = est.HeadingSpeed - truth.HeadingSpeed;
+    e.angle_sq += dr * dr + dp * dp;
+    e.rate_sq += w0 * w0 + w1 * w1 + w2 * w2;
+    e.angle_max = std::max(e.angle_max, std::max(std::fabs(dr), std::fabs(dp)));
+    e.n++;
+}
+
+static void print_error(const char* name, const AlignError_t& e) {
+    printf("%-12s | angle rms %7.3f mrad, max %7.3f mrad | rate rms %7.3f mrad/s\n", name,
+           std::sqrt(e.angle_sq / (2 * e.n)) * 1e3, e.angle_max * 1e3, std::sqrt(e.rate_sq / (3 * e.n)) * 1e3);
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 6.0;
+    uint32_t rate = argc > 2 ? (uint32_t)atoi(argv[2]) : IMU_OUTPUT_RATE_HZ;
+    int64_t offset_us = argc > 3 ? atoll(argv[3]) : 123456789;
+    double drift_ppm = argc > 4 ? atof(argv[4]) : 50.0;
+    uint32_t jitter = argc > 5 ? (uint32_t)atoi(argv[5]) : 0;
+
+    char link_dir[] = "/tmp/robot_dog_imu_XXXXXX";
+    if (mkdtemp(link_dir) == NULL) {
+        std::cerr << "Failed to create temp dir" << std::endl;
+        return 1;
+    }
+    ImuEmulator emu;
+    emu.setConfig({rate, jitter, 0, 0, 0.0f, IMU_BAUD_RATE, offset_us, drift_ppm});
+    if (!emu.start(link_dir)) return 1;
+
+    IMU local;
+    local.serial_init(emu.getPortName());
+    std::thread reader([&local]() { local.run_reader(); });
+
+    LatencyHistogram map_err_us;
+    AlignError_t held = {0, 0, 0, 0}, extrap = {0, 0, 0, 0};
+    int64_t warm_ns = steady_ns() + 2LL * IMU_CLOCK_WINDOW_MS * 1000000;
+    int64_t end_ns = steady_ns() + (int64_t)(seconds * 1e9);
+    PeriodicLoop loop("align_probe", std::chrono::milliseconds(1), OverrunPolicy::SKIP);
+    while (steady_ns() < end_ns) {
+        int64_t tick_ns = steady_ns(loop.start());
+        IMU::ImuSample_t s;
+        if (local.read_latest(s) && tick_ns > warm_ns) {
+            int64_t err = s.sample_ns - emu.deviceToSteadyNs(s.data.Timestamp);
+            map_err_us.record((uint32_t)(std::llabs(err) / 1000));
+
+            IMU::IMUData_t now_est, truth;
+            IMU::IMUData_MSG_BODY_VEL vel;
+            IMU::IMUData_MSG_BODY_ACCELERATION acc;
+            int64_t age = imu_extrapolate(s, tick_ns, now_est);
+            imu_age_record(IMU_AGE_CONTROL, age);
+            emu.sampleAt(tick_ns, truth, vel, acc);
+            accumulate(held, s.data, truth);
+            accumulate(extrap, now_est, truth);
+        }
+        loop.wait();
+    }
+
+    g_running = false;
+    reader.join();
+    emu.stop();
+    rmdir(link_dir);
+
+    printf("IMU %u Hz, device clock offset %ld us, drift %+.1f ppm, jitter %u us, %.0f s\n\n",
+           rate, (long)offset_us, drift_ppm, jitter, seconds);
+    LatencyHistSnapshot_t snap;
+    map_err_us.snapshot(snap);
+    printf("clock mapping |error| (us): p50 %u, p99 %u, max %u over %lu ticks\n", latency_hist_quantile(snap, 0.5),
+           latency_hist_quantile(snap, 0.99), latency_hist_max(snap), snap.total);
+    print_imu_age_statistics();
+    print_error("held sample", held);
+    print_error("extrapolated", extrap);
+    return 0;
+}
@@ -0,0 +1,445 @@
+/**
+ * 关节换算基准测试
+ * 对比旧的逐腿逐电机if/else分支换算(原样复制自改造前的motor.cpp)、按标定表的逐关节换算和
+ * 12关节批量换算，输出每次12关节换算的耗时，并检查新旧换算结果的最大差值
+ *
+ * 用法: bench_joint_calibration [迭代次数]
+ */
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include "motor.hpp"
+#include "joint_calibration.hpp"
+#include "rt_util.hpp"
+
+// 防止编译器把结果优化掉
+static volatile float g_sink;
+
+// ——— 旧的分支换算 ———
+
+static void ladder_set_control(Motor::Command_t& c, int16_t id, int16_t num, float tor_des, float spd_des, float pos_des, float k_pos, float k_spd)
+{
+    if(id == 0)
+    {
+        if(num == 0) {
+            c.tor_des =  tor_des / GEAR_RATIO;     // 转子端转矩 = 输出端转矩 / 减速比
+            c.spd_des =  spd_des * GEAR_RATIO;     // 转子端速度 = 输出端速度 * 减速比
+            c.pos_des =  (pos_des + 0.917742) * GEAR_RATIO;     // 转子端位置 = 输出端位置 * 减速比
+            c.k_pos =  k_pos / GEAR_RATIO / GEAR_RATIO;  // 位置增益需要考虑两次减速比
+            c.k_spd =  k_spd / GEAR_RATIO / GEAR_RATIO;   // 速度增益需要考虑两次减速比
+        }
+        else if(num == 1)
+        {
+            c.tor_des =  -tor_des / GEAR_RATIO;     // 转子端转矩 = 输出端转矩 / 减速比
+            c.spd_des =  -spd_des * GEAR_RATIO;     // 转子端速度 = 输出端速度 * 减速比
+            c.pos_des =  -(pos_des - 1.775659) * GEAR_RATIO;     // 转子端位置 = 输出端位置 * 减速比
+            c.k_pos =  k_pos / GEAR_RATIO / GEAR_RATIO;  // 位置增益需要考虑两次减速比
+            c.k_spd =  k_spd / GEAR_RATIO / GEAR_RATIO;   // 速度增益需要考虑两次减速比
+
+        }
+        else if(num == 2)
+        {
+            c.tor_des =  tor_des / GEAR_RATIO / 1.88;     // 转子端转矩 = 输出端转矩 / 减速比
+            c.spd_des =  spd_des * GEAR_RATIO * 1.88;     // 转子端速度 = 输出端速度 * 减速比
+            c.pos_des =  (pos_des + 3.205968) * GEAR_RATIO * 1.88 ;     // 转子端位置 = 输出端位置 * 减速比
+            c.k_pos =  k_pos / GEAR_RATIO / GEAR_RATIO;  // 位置增益需要考虑两次减速比
+            c.k_spd =  k_spd / GEAR_RATIO / GEAR_RATIO;   // 速度增益需要考虑两次减速比
+        }
+        else
+        {
+            // 如果num不在预期范围内，打印错误信息
+            std::cerr << "Error: Invalid motor number " << num << ". Valid numbers are 0, 1, or 2." << std::endl;
+            return;
+        }
+    }
+    else if (id == 1)
+    {
+        if(num == 0) {
+            c.tor_des =  tor_des / GEAR_RATIO;     // 转子端转矩 = 输出端转矩 / 减速比
+            c.spd_des =  spd_des * GEAR_RATIO;     // 转子端速度 = 输出端速度 * 减速比
+            c.pos_des =  (pos_des + 0.83411) * GEAR_RATIO;     // 转子端位置 = 输出端位置 * 减速比
+            c.k_pos =  k_pos / GEAR_RATIO / GEAR_RATIO;  // 位置增益需要考虑两次减速比
+            c.k_spd =  k_spd / GEAR_RATIO / GEAR_RATIO;   // 速度增益需要考虑两次减速比
+        }
+        else if(num == 1)
+        {
+            c.tor_des =  tor_des / GEAR_RATIO;     // 转子端转矩 = 输出端转矩 / 减速比
+            c.spd_des =  spd_des * GEAR_RATIO;     // 转子端速度 = 输出端速度 * 减速比
+            c.pos_des =  (pos_des - 0.950479) * GEAR_RATIO;     // 转子端位置 = 输出端位置 * 减速比
+            c.k_pos =  k_pos / GEAR_RATIO / GEAR_RATIO;  // 位置增益需要考虑两次减速比
+            c.k_spd =  k_spd / GEAR_RATIO / GEAR_RATIO;   // 速度增益需要考虑两次减速比
+
+        }
+        else if(num == 2)
+        {
+            c.tor_des =  -tor_des / GEAR_RATIO / 1.88;     // 转子端转矩 = 输出端转矩 / 减速比
+            c.spd_des =  -spd_des * GEAR_RATIO * 1.88;     // 转子端速度 = 输出端速度 * 减速比
+            c.pos_des =  -(pos_des + 2.6572986) * GEAR_RATIO * 1.88;     // 转子端位置 = 输出端位置 * 减速比
+            c.k_pos =  k_pos / GEAR_RATIO / GEAR_RATIO;  // 位置增益需要考虑两次减速比
+            c.k_spd =  k_spd / GEAR_RATIO / GEAR_RATIO;   // 速度增益需要考虑两次减速比
+        }
+        else
+        {
+            // 如果num不在预期范围内，打印错误信息
+            std::cerr << "Error: Invalid motor number " << num << ". Valid numbers are 0, 1, or 2." << std::endl;
+            return;
+        }
+    }
+    else if (id == 2)
+    {
+        if(num == 0) {
+            c.tor_des =  -tor_des / GEAR_RATIO;     // 转子端转矩 = 输出端转矩 / 减速比
+            c.spd_des =  -spd_des * GEAR_RATIO;     // 转子端速度 = 输出端速度 * 减速比
+            c.pos_des =  -(pos_des + 0.036858) * GEAR_RATIO;     // 转子端位置 = 输出端位置 * 减速比
+            c.k_pos =  k_pos / GEAR_RATIO / GEAR_RATIO;  // 位置增益需要考虑两次减速比
+            c.k_spd =  k_spd / GEAR_RATIO / GEAR_RATIO;   // 速度增益需要考虑两次减速比
+        }
+        else if(num == 1)
+        {
+            c.tor_des =  -tor_des / GEAR_RATIO;     // 转子端转矩 = 输出端转矩 / 减速比
+            c.spd_des =  -spd_des * GEAR_RATIO;     // 转子端速度 = 输出端速度 * 减速比
+            c.pos_des =  -(pos_des - 1.4168) * GEAR_RATIO;     // 转子端位置 = 输出端位置 * 减速比
+            c.k_pos =  k_pos / GEAR_RATIO / GEAR_RATIO;  // 位置增益需要考虑两次减速比
+            c.k_spd =  k_spd / GEAR_RATIO / GEAR_RATIO;   // 速度增益需要考虑两次减速比
+
+        }
+        else if(num == 2)
+        {
+            c.tor_des =  tor_des / GEAR_RATIO / 1.88;     // 转子端转矩 = 输出端转矩 / 减速比
+            c.spd_des =  spd_des * GEAR_RATIO * 1.88;     // 转子端速度 = 输出端速度 * 减速比
+            c.pos_des =  (pos_des + 3.2397) * GEAR_RATIO * 1.88;     // 转子端位置 = 输出端位置 * 减速比
+            c.k_pos =  k_pos / GEAR_RATIO / GEAR_RATIO;  // 位置增益需要考虑两次减速比
+            c.k_spd =  k_spd / GEAR_RATIO / GEAR_RATIO;   // 速度增益需要考虑两次减速比
+        }
+        else
+        {
+            // 如果num不在预期范围内，打印错误信息
+            std::cerr << "Error: Invalid motor number " << num << ". Valid numbers are 0, 1, or 2." << std::endl;
+            return;
+        }
+    }
+    else if (id == 3)
+    {
+        if(num == 0) {
+            c.tor_des =  -tor_des / GEAR_RATIO;     // 转子端转矩 = 输出端转矩 / 减速比
+            c.spd_des =  -spd_des * GEAR_RATIO;     // 转子端速度 = 输出端速度 * 减速比
+            c.pos_des =  -(pos_des - 0.414653) * GEAR_RATIO;     // 转子端位置 = 输出端位置 * 减速比
+            c.k_pos =  k_pos / GEAR_RATIO / GEAR_RATIO;  // 位置增益需要考虑两次减速比
+            c.k_spd =  k_spd / GEAR_RATIO / GEAR_RATIO;   // 速度增益需要考虑两次减速比
+        }
+        else if(num == 1)
+        {
+            c.tor_des =  tor_des / GEAR_RATIO;     // 转子端转矩 = 输出端转矩 / 减速比
+            c.spd_des =  spd_des * GEAR_RATIO;     // 转子端速度 = 输出端速度 * 减速比
+            c.pos_des =  (pos_des - 0.42181) * GEAR_RATIO;     // 转子端位置 = 输出端位置 * 减速比
+            c.k_pos =  k_pos / GEAR_RATIO / GEAR_RATIO;  // 位置增益需要考虑两次减速比
+            c.k_spd =  k_spd / GEAR_RATIO / GEAR_RATIO;   // 速度增益需要考虑两次减速比
+
+        }
+        else if(num == 2)
+        {
+            c.tor_des =  -tor_des / GEAR_RATIO / 1.88;     // 转子端转矩 = 输出端转矩 / 减速比
+            c.spd_des =  -spd_des * GEAR_RATIO * 1.88;     // 转子端速度 = 输出端速度 * 减速比
+            c.pos_des =  -(pos_des + 2.231182) * GEAR_RATIO * 1.88;     // 转子端位置 = 输出端位置 * 减速比
+            c.k_pos =  k_pos / GEAR_RATIO / GEAR_RATIO;  // 位置增益需要考虑两次减速比
+            c.k_spd =  k_spd / GEAR_RATIO / GEAR_RATIO;   // 速度增益需要考虑两次减速比
+        }
+        else
+        {
+            // 如果num不在预期范围内，打印错误信息
+            std::cerr << "Error: Invalid motor number " << num << ". Valid numbers are 0, 1, or 2." << std::endl;
+            return;
+        }
+    }
+    else
+    {
+        // 如果id不在预期范围内，打印错误信息
+        std::cerr << "Error: Invalid motor ID " << id << ". Valid IDs are 0, 1, 2, or 3." << std::endl;
+        return;
+    }
+}
+
+static float ladder_get_torque(float tor, int16_t id, int16_t num)
+{
+    if(id == 0)
+    {
+        if(num == 0)
+            return (tor * GEAR_RATIO); // 转子端转矩 = 输出端转矩 / 减速比
+        else if(num == 1)
+            return -(tor * GEAR_RATIO); // 转子端转矩 = 输出端转矩 / 减速比
+        else if(num == 2)
+            return (tor * GEAR_RATIO * 1.88); // 转子端转矩 = 输出端转矩 / 减速比
+        else
+            return 0.0f; // 如果num不在预期范围内，返回0
+    }
+    else if (id == 1)
+    {
+        if(num == 0)
+            return (tor * GEAR_RATIO); // 转子端转矩 = 输出端转矩 / 减速比
+        else if(num == 1)
+            return (tor * GEAR_RATIO); // 转子端转矩 = 输出端转矩 / 减速比
+        else if(num == 2)
+            return -(tor * GEAR_RATIO * 1.88); // 转子端转矩 = 输出端转矩 / 减速比
+        else
+            return 0.0f; // 如果num不在预期范围内，返回0
+    }
+    else if (id == 2)
+    {
+        if(num == 0)
+            return -(tor * GEAR_RATIO); // 转子端转矩 = 输出端转矩 / 减速比
+        else if(num == 1)
+            return -(tor * GEAR_RATIO); // 转子端转矩 = 输出端转矩 / 减速比
+        else if(num == 2)
+            return (tor * GEAR_RATIO * 1.88); // 转子端转矩 = 输出端转矩 / 减速比
+        else
+            return 0.0f; // 如果num不在预期范围内，返回0
+    }
+    else if (id == 3)
+    {
+        if(num == 0)
+            return -(tor * GEAR_RATIO); // 转子端转矩 = 输出端转矩 / 减速比
+        else if(num == 1)
+            return (tor * GEAR_RATIO); // 转子端转矩 = 输出端转矩 / 减速比
+        else if(num == 2)
+            return -(tor * GEAR_RATIO * 1.88); // 转子端转矩 = 输出端转矩 / 减速比
+        else
+            return 0.0f; // 如果num不在预期范围内，返回0
+    }
+    else
+    {
+        // 如果id不在预期范围内，打印错误信息并返回0
+        std::cerr << "Error: Invalid motor ID " << id << ". Valid IDs are 0, 1, 2, or 3." << std::endl;
+        return 0.0f;
+    }
+}
+
+static float ladder_get_speed(float spd, int16_t id, int16_t num)
+{
+    if(id == 0)
+    {
+        if(num == 0)
+            return (spd / GEAR_RATIO); // 转子端速度 = 输出端速度 * 减速比
+        else if(num == 1)
+            return -(spd / GEAR_RATIO); // 转子端速度 = 输出端速度 * 减速比
+        else if(num == 2)
+            return (spd / GEAR_RATIO / 1.88); // 转子端速度 = 输出端速度 * 减速比
+        else
+            return 0.0f; // 如果num不在预期范围内，返回0
+    }
+    else if (id == 1)
+    {
+        if(num == 0)
+            return (spd / GEAR_RATIO); // 转子端速度 = 输出端速度 * 减速比
+        else if(num == 1)
+            return (spd / GEAR_RATIO); // 转子端速度 = 输出端速度 * 减速比
+        else if(num == 2)
+            return -(spd / GEAR_RATIO / 1.88); // 转子端速度 = 输出端速度 * 减速比
+        else
+            return 0.0f; // 如果num不在预期范围内，返回0
+    }
+    else if (id == 2)
+    {
+        if(num == 0)
+            return -(spd / GEAR_RATIO); // 转子端速度 = 输出端速度 * 减速比
+        else if(num == 1)
+            return -(spd / GEAR_RATIO); // 转子端速度 = 输出端速度 * 减速比
+        else if(num == 2)
+            return (spd / GEAR_RATIO / 1.88); // 转子端速度 = 输出端速度 * 减速比
+        else
+            return 0.0f; // 如果num不在预期范围内，返回0
+    }
+    else if (id == 3)
+    {
+        if(num == 0)
+            return -(spd / GEAR_RATIO); // 转子端速度 = 输出端速度 * 减速比
+        else if(num == 1)
+            return (spd / GEAR_RATIO); // 转子端速度 = 输出端速度 * 减速比
+        else if(num == 2)
+            return -(spd / GEAR_RATIO / 1.88); // 转子端速度 = 输出端速度 * 减速比
+        else
+            return 0.0f; // 如果num不在预期范围内，返回0
+    }
+    else
+    {
+        // 如果id不在预期范围内，打印错误信息并返回0
+        std::cerr << "Error: Invalid motor ID " << id << ". Valid IDs are 0, 1, 2, or 3." << std::endl;
+        return 0.0f;
+    }
+}
+
+static float ladder_get_position(float pos, int16_t id, int16_t num)
+{
+    if(id == 0)
+    {
+        if(num == 0)
+            return (pos / GEAR_RATIO - 0.917742); // 转子端位置 = 输出端位置 * 减速比
+        else if(num == 1)
+            return (-(pos / GEAR_RATIO)  + 1.775659); // 转子端位置 = 输出端位置 * 减速比
+        else if(num == 2)
+            return (pos / GEAR_RATIO / 1.88 - 3.205968); // 转子端位置 = 输出端位置 * 减速比
+        else
+            return 0.0f; // 如果num不在预期范围内，返回0
+    }
+    else if (id == 1)
+    {
+        if(num == 0)
+            return (pos / GEAR_RATIO  - 0.83411); // 转子端位置 = 输出端位置 * 减速比
+        else if(num == 1)
+            return (pos / GEAR_RATIO + 0.950479); // 转子端位置 = 输出端位置 * 减速比
+        else if(num == 2)
+            return (-(pos / GEAR_RATIO / 1.88) - 2.6572986); // 转子端位置 = 输出端位置 * 减速比
+        else
+            return 0.0f; // 如果num不在预期范围内，返回0
+    }
+    else if (id == 2)
+    {
+        if(num == 0)
+            return (-(pos / GEAR_RATIO) - 0.036858); // 转子端位置 = 输出端位置 * 减速比
+        else if(num == 1)
+            return (-(pos / GEAR_RATIO) + 1.4168); // 转子端位置 = 输出端位置 * 减速比
+        else if(num == 2)
+            return (pos / GEAR_RATIO / 1.88 - 3.2397); // 转子端位置 = 输出端位置 * 减速比
+        else
+            return 0.0f; // 如果num不在预期范围内，返回0
+    }
+    else if (id == 3)
+    {
+        if(num == 0)
+            return (-(pos / GEAR_RATIO) + 0.414653); // 转子端位置 = 输出端位置 * 减速比
+        else if(num == 1)
+            return (pos / GEAR_RATIO + 0.42181); // 转子端位置 = 输出端位置 * 减速比
+        else if(num == 2)
+            return (-(pos / GEAR_RATIO / 1.88) - 2.231182); // 转子端位置 = 输出端位置 * 减速比
+        else
+            return 0.0f; // 如果num不在预期范围内，返回0
+    }
+    else
+    {
+        // 如果id不在预期范围内，打印错误信息并返回0
+        std::cerr << "Error: Invalid motor ID " << id << ". Valid IDs are 0, 1, 2, or 3." << std::endl;
+        return 0.0f;
+    }
+}
+
+// ——— 检查新旧换算一致 ———
+
+static double max_diff(double a, float b, double m) {
+    return std::max(m, std::fabs(a - (double)b));
+}
+
+static void check_equivalence() {
+    double d_cmd = 0, d_fbk = 0;
+    Motor motor;
+    for (int k = 0; k < 1000; ++k) {
+        float x = -3.0f + 6.0f * k / 1000.0f;
+        for (int id = 0; id < NUM_CHANNELS; ++id) {
+            for (int num = 0; num < MOTORS_PER_CHANNEL; ++num) {
+                Motor::Command_t ref;
+                ladder_set_control(ref, id, num, x, 2 * x, x, 20.0f, 0.5f);
+                motor.Motor_SetControlParams(id, num, x, 2 * x, x, 20.0f, 0.5f);
+                Motor::Command_t c = motor.getCommand();
+                d_cmd = max_diff(ref.tor_des, c.tor_des, d_cmd);
+                d_cmd = max_diff(ref.spd_des, c.spd_des, d_cmd);
+                d_cmd = max_diff(ref.pos_des, c.pos_des, d_cmd);
+                d_cmd = max_diff(ref.k_pos, c.k_pos, d_cmd);
+                d_cmd = max_diff(ref.k_spd, c.k_spd, d_cmd);
+
+                Motor::RecvData_t r = {};
+                r.fbk.torque = (int16_t)(x * 256);
+                r.fbk.speed = (int16_t)(x * 2560);
+                r.fbk.pos = (int32_t)(x * 327680);
+                motor.updateFeedback(r);
+                Motor::Feedback_t f = motor.getFeedback();
+                d_fbk = max_diff(ladder_get_torque(f.tor, id, num), motor.getTorque(id, num), d_fbk);
+                d_fbk = max_diff(ladder_get_speed(f.spd, id, num), motor.getSpeed(id, num), d_fbk);
+                d_fbk = max_diff(ladder_get_position(f.pos, id, num), motor.getPosition(id, num), d_fbk);
+            }
+        }
+    }
+    printf("Max |ladder - table|: command %.3g, feedback %.3g\n\n", d_cmd, d_fbk);
+}
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? atol(argv[1]) : 2000000;
+
+    check_equivalence();
+
+    // 输入数据按关节顺序准备，每次迭代略微变化避免被常量折叠
+    JointState_t rotor, out;
+    JointCommand_t target, cmd;
+    JointRawFeedback_t raw;
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        rotor.tor[j] = rotor.spd[j] = rotor.pos[j] = 0.1f * j;
+        target.tor[j] = target.spd[j] = target.pos[j] = 0.05f * j;
+        target.k_pos[j] = 20.0f;
+        target.k_spd[j] = 0.5f;
+        raw.torque[j] = raw.speed[j] = (int16_t)(100 * j);
+        raw.pos[j] = 1000 * j;
+    }
+
+    std::cout << "Per 12-joint pass, " << iterations << " iterations\n";
+    std::cout << "Path    | Feedback(ns) | Command(ns)\n";
+    std::cout << "--------|--------------|------------\n";
+
+    // 旧分支换算
+    int64_t t0 = steady_ns();
+    for (long it = 0; it < iterations; ++it) {
+        float acc = 0;
+        for (int id = 0; id < NUM_CHANNELS; ++id) {
+            for (int num = 0; num < MOTORS_PER_CHANNEL; ++num) {
+                int j = id * MOTORS_PER_CHANNEL + num;
+                acc += ladder_get_torque(rotor.tor[j], id, num) + ladder_get_speed(rotor.spd[j], id, num) +
+                       ladder_get_position(rotor.pos[j], id, num);
+            }
+        }
+        g_sink = acc;
+        rotor.pos[it % NUM_JOINTS] += 1e-7f;
+    }
+    int64_t t1 = steady_ns();
+    for (long it = 0; it < iterations; ++it) {
+        Motor::Command_t c;
+        float acc = 0;
+        for (int id = 0; id < NUM_CHANNELS; ++id) {
+            for (int num = 0; num < MOTORS_PER_CHANNEL; ++num) {
+                int j = id * MOTORS_PER_CHANNEL + num;
+                ladder_set_control(c, id, num, target.tor[j], target.spd[j], target.pos[j],
+                                   target.k_pos[j], target.k_spd[j]);
+                acc += c.tor_des + c.spd_des + c.pos_des + c.k_pos + c.k_spd;
+            }
+        }
+        g_sink = acc;
+        target.pos[it % NUM_JOINTS] += 1e-7f;
+    }
+    int64_t t2 = steady_ns();
+    printf("ladder  | %12.1f | %11.1f\n", (double)(t1 - t0) / iterations, (double)(t2 - t1) / iterations);
+
+    // 标定表批量换算
+    t0 = steady_ns();
+    for (long it = 0; it < iterations; ++it) {
+        joint_rotor_to_output(rotor, out);
+        g_sink = out.pos[it % NUM_JOINTS];
+        rotor.pos[it % NUM_JOINTS] += 1e-7f;
+    }
+    t1 = steady_ns();
+    for (long it = 0; it < iterations; ++it) {
+        joint_output_to_rotor(target, cmd);
+        g_sink = cmd.pos[it % NUM_JOINTS];
+        target.pos[it % NUM_JOINTS] += 1e-7f;
+    }
+    t2 = steady_ns();
+    printf("table   | %12.1f | %11.1f\n", (double)(t1 - t0) / iterations, (double)(t2 - t1) / iterations);
+
+    // 原始定点数直接换算到输出端
+    t0 = steady_ns();
+    for (long it = 0; it < iterations; ++it) {
+        joint_raw_to_output(raw, out);
+        g_sink = out.pos[it % NUM_JOINTS];
+        raw.pos[it % NUM_JOINTS]++;
+    }
+    t1 = steady_ns();
+    printf("raw     | %12.1f |           -\n", (double)(t1 - t0) / iterations);
+    return 0;
+}
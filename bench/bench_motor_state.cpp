@@ -0,0 +1,139 @@
+/**
+ * 电机状态交换竞争基准测试
+ * 4个通道线程持续打包命令并写入反馈，1个控制线程持续读取12个电机的反馈快照并写入控制参数，
+ * 分别用全局互斥锁(旧方式)和顺序锁(当前方式)保护，输出各操作耗时分位数、吞吐量和撕裂读次数
+ *
+ * 用法: bench_motor_state [每种模式秒数]
+ */
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "motor_control.hpp"
+#include "rt_util.hpp"
+#include "bench_stats.hpp"
+
+static std::mutex g_bench_mutex;  // 旧方式的全局互斥锁
+
+// 构建三个字段都由同一个计数值k换算而来的反馈包，读者据此检查是否读到新旧混合的数据
+static Motor::RecvData_t make_feedback(int motor, int16_t k) {
+    Motor::RecvData_t r;
+    memset(&r, 0, sizeof(r));
+    r.mode.id = motor;
+    r.fbk.torque = k;
+    r.fbk.speed = k;
+    r.fbk.pos = k;
+    return r;
+}
+
+static bool is_torn(const Motor::Feedback_t& f) {
+    long k_tor = lroundf(f.tor * 256.0f);
+    long k_spd = lroundf(f.spd / 6.28318f * 256.0f);
+    long k_pos = lroundf(f.pos / 6.28318f * 32768.0f);
+    return k_tor != k_spd || k_tor != k_pos;
+}
+
+/**
+ * 运行一种模式
+ * @param locked true使用全局互斥锁，false直接访问(顺序锁)
+ */
+static void run(const char* name, bool locked, double seconds) {
+    std::atomic<bool> running(true);
+    std::vector<std::vector<int64_t>> writer_ns(NUM_CHANNELS);
+    std::vector<int64_t> reader_ns;
+    uint64_t torn = 0;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        threads.emplace_back([&, i]() {
+            auto& samples = writer_ns[i];
+            samples.reserve(1 << 22);
+            int16_t k = 1;
+            while (running) {
+                for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
+                    Motor::RecvData_t r = make_feedback(j, k);
+                    k = k >= 30000 ? 1 : k + 1;
+                    int64_t t0 = steady_ns();
+                    if (locked) {
+                        Motor::ControlData_t cmd;
+                        {
+                            std::lock_guard<std::mutex> lock(g_bench_mutex);
+                            cmd = g_motors[i][j].createControlPacket(j);
+                        }
+                        (void)cmd;
+                        std::lock_guard<std::mutex> lock(g_bench_mutex);
+                        g_motors[i][j].updateFeedback(r);
+                    } else {
+                        Motor::ControlData_t cmd = g_motors[i][j].createControlPacket(j);
+                        (void)cmd;
+                        g_motors[i][j].updateFeedback(r);
+                    }
+                    int64_t t1 = steady_ns();
+                    if (samples.size() < samples.capacity()) samples.push_back(t1 - t0);
+                }
+            }
+        });
+    }
+
+    threads.emplace_back([&]() {
+        reader_ns.reserve(1 << 22);
+        Motor::Feedback_t snapshot[NUM_CHANNELS][MOTORS_PER_CHANNEL];
+        while (running) {
+            int64_t t0 = steady_ns();
+            if (locked) {
+                {
+                    std::lock_guard<std::mutex> lock(g_bench_mutex);
+                    motor_feedback_snapshot(snapshot);
+                }
+                std::lock_guard<std::mutex> lock(g_bench_mutex);
+                for (int i = 0; i < NUM_CHANNELS; ++i)
+                    for (int j = 0; j < MOTORS_PER_CHANNEL; ++j)
+                        g_motors[i][j].Motor_SetControlParams(i, j, 1.0f, 0, 0, 0, 0);
+            } else {
+                motor_feedback_snapshot(snapshot);
+                for (int i = 0; i < NUM_CHANNELS; ++i)
+                    for (int j = 0; j < MOTORS_PER_CHANNEL; ++j)
+                        g_motors[i][j].Motor_SetControlParams(i, j, 1.0f, 0, 0, 0, 0);
+            }
+            int64_t t1 = steady_ns();
+            if (reader_ns.size() < reader_ns.capacity()) reader_ns.push_back(t1 - t0);
+            for (int i = 0; i < NUM_CHANNELS; ++i)
+                for (int j = 0; j < MOTORS_PER_CHANNEL; ++j)
+                    if (is_torn(snapshot[i][j])) torn++;
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    running = false;
+    for (auto& t : threads) t.join();
+
+    std::vector<int64_t> writes;
+    for (auto& w : writer_ns) writes.insert(writes.end(), w.begin(), w.end());
+    std::sort(writes.begin(), writes.end());
+    std::sort(reader_ns.begin(), reader_ns.end());
+
+    printf("%-7s | writer | %9.0f | %7.0f | %7.0f | %8.0f | %9.0f |\n", name, writes.size() / seconds,
+           percentile(writes, 50), percentile(writes, 99), percentile(writes, 99.9),
+           writes.empty() ? 0.0 : (double)writes.back());
+    printf("%-7s | reader | %9.0f | %7.0f | %7.0f | %8.0f | %9.0f | %lu\n", name, reader_ns.size() / seconds,
+           percentile(reader_ns, 50), percentile(reader_ns, 99), percentile(reader_ns, 99.9),
+           reader_ns.empty() ? 0.0 : (double)reader_ns.back(), torn);
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 3.0;
+
+    std::cout << "4 channel writers (packet + feedback per motor), 1 reader (12-joint snapshot + 12 commands)\n";
+    std::cout << "Times in ns\n\n";
+    std::cout << "Mode    | Side   |    ops/s  |    p50  |    p99  |   p99.9  |      max  | Torn\n";
+    std::cout << "--------|--------|-----------|---------|---------|----------|-----------|-----\n";
+    run("mutex", true, seconds);
+    run("seqlock", false, seconds);
+    return 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * 周期循环超期策略基准测试
+ * 用三种超期策略各运行一个1ms周期循环，每隔若干次迭代注入一次超过周期的工作，
+ * 输出迭代次数、超期次数、丢弃的节拍数、唤醒延迟和工作耗时分布。
+ * CATCH_UP策略下超期后会连续执行积压的迭代，唤醒延迟的尾部明显变长。
+ * 最后用rt_spawn()按任务描述启动一个唤醒前自旋的SKIP循环，与只睡眠的skip比较唤醒延迟，并打印执行器报告
+ *
+ * 用法: bench_periodic_loop [每种策略秒数] [注入间隔(迭代数)] [注入工作时长us] [自旋us]
+ */
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include "periodic_loop.hpp"
+#include "rt_executor.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+// 忙等模拟工作，不让出CPU
+static void busy_work(long us) {
+    auto end = Clock::now() + std::chrono::microseconds(us);
+    while (Clock::now() < end) {
+    }
+}
+
+static void run_policy(const char* name, OverrunPolicy policy, double seconds, int spike_every, long spike_us) {
+    PeriodicLoop loop(name, std::chrono::milliseconds(1), policy);
+    auto end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    long n = 0;
+    while (Clock::now() < end) {
+        busy_work(++n % spike_every == 0 ? spike_us : 100);
+        loop.wait();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 3.0;
+    int spike_every = argc > 2 ? atoi(argv[2]) : 100;
+    long spike_us = argc > 3 ? atol(argv[3]) : 3500;
+    uint32_t spin_us = argc > 4 ? (uint32_t)atoi(argv[4]) : 50;
+    if (spike_every < 1) spike_every = 1;
+
+    std::cout << "1 ms loop, 100 us work, " << spike_us << " us spike every " << spike_every
+              << " iterations, " << seconds << " s per policy\n\n";
+
+    run_policy("skip", OverrunPolicy::SKIP, seconds, spike_every, spike_us);
+    run_policy("catch-up", OverrunPolicy::CATCH_UP, seconds, spike_every, spike_us);
+    run_policy("rephase", OverrunPolicy::REPHASE, seconds, spike_every, spike_us);
+
+    // 周期、策略和自旋时间取自任务描述，线程中给出的值被覆盖
+    RtTaskSpec_t spec = {"skip-spin", 1000, 0, 0, 0, 64 * 1024, spin_us, OverrunPolicy::SKIP};
+    std::thread t = rt_spawn(spec, [=]() { run_policy("skip-spin", OverrunPolicy::CATCH_UP, seconds, spike_every, spike_us); });
+    t.join();
+    print_rt_task_report();
+
+    print_periodic_loop_statistics();
+    return 0;
+}
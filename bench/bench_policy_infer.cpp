@@ -0,0 +1,115 @@
+/**
+ * CPU推理耗时基准测试
+ * 依次以各种PolicyCpuMode加载同一个模型(fp16解释执行、fp32解释执行、freeze+optimize_for_inference、
+ * Static Runtime、原生执行器)，每种方式在给定的intra-op线程数下输出：加载和热身耗时、每次forward的p50/p99/max，
+ * 以及与fp32解释执行在同一输入上的输出最大差。输入为固定种子生成的观测和历史，各方式相同
+ *
+ * 用法: bench_policy_infer <模型文件> [次数] [线程数,逗号分隔]
+ */
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include "algorithm_control.hpp"
+#include "latency_histogram.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static const char* mode_names[] = {"fp16 jit", "fp32 jit", "fp32 frozen", "fp32 static", "fp32 native"};
+
+/**
+ * @brief 一种推理方式的测量结果
+ */
+typedef struct {
+    PolicyCpuMode mode;
+    int threads;
+    double init_ms;       // init_policy()耗时，含加载、优化和热身
+    double mean_us;
+    uint32_t p50_us, p99_us, max_us;
+    float max_diff;       // 与fp32解释执行的输出最大差
+} InferResult_t;
+
+/**
+ * 以一种方式加载并测量，out为本方式在固定输入上的输出(float，CPU)
+ */
+static InferResult_t run_mode(const char* model_path, PolicyCpuMode mode, int threads, long iters,
+                              const torch::Tensor& ref_obs, const torch::Tensor& ref_hist, torch::Tensor& out) {
+    InferResult_t r;
+    r.mode = mode;
+    r.threads = threads;
+    std::unique_ptr<RL_ROTDOG> policy(new RL_ROTDOG);
+    policy->model_path = model_path;
+    policy->use_cuda = false;
+    policy->cpu_mode = mode;
+    policy->cpu_threads = threads;
+    auto t0 = Clock::now();
+    policy->init_policy();
+    r.init_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    policy->obs_in.copy_(ref_obs);
+    policy->obs_ring.copy_(ref_hist);
+    out = policy->forward_step().to(torch::kFloat32).clone();
+
+    std::unique_ptr<LatencyHistogram> hist(new LatencyHistogram);
+    double sum_us = 0;
+    for (long i = 0; i < iters; ++i) {
+        auto s = Clock::now();
+        policy->forward_step();
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - s).count();
+        hist->record((uint32_t)us);
+        sum_us += us;
+    }
+    LatencyHistSnapshot_t snap;
+    hist->snapshot(snap);
+    r.mean_us = sum_us / iters;
+    r.p50_us = latency_hist_quantile(snap, 0.5);
+    r.p99_us = latency_hist_quantile(snap, 0.99);
+    r.max_us = latency_hist_max(snap);
+    r.max_diff = 0.0f;
+    return r;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <model.pt> [iters] [threads,...]\n";
+        return 1;
+    }
+    long iters = argc > 2 ? atol(argv[2]) : 5000;
+    std::vector<int> thread_counts;
+    std::stringstream ss(argc > 3 ? argv[3] : "1,2,4");
+    std::string item;
+    while (std::getline(ss, item, ',')) thread_counts.push_back(atoi(item.c_str()));
+
+    // 固定种子的输入，幅度与归一化后的观测相近；历史按{2H,45}环形缓冲的布局给出
+    RL_ROTDOG shape;
+    torch::manual_seed(0);
+    torch::Tensor ref_obs = torch::randn({1, 45}) * 0.5;
+    torch::Tensor ref_hist = torch::randn({shape.history_length, 45}) * 0.5;
+    ref_hist = torch::cat({ref_hist, ref_hist}, 0);
+
+    // fp32解释执行的输出作为参考
+    torch::Tensor ref_out, out;
+    run_mode(argv[1], POLICY_CPU_JIT, thread_counts[0], 1, ref_obs, ref_hist, ref_out);
+
+    std::vector<InferResult_t> results;
+    for (int threads : thread_counts) {
+        for (int m = POLICY_CPU_HALF; m <= POLICY_CPU_NATIVE; ++m) {
+            InferResult_t r = run_mode(argv[1], (PolicyCpuMode)m, threads, iters, ref_obs, ref_hist, out);
+            r.max_diff = (out - ref_out).abs().max().item<float>();
+            results.push_back(r);
+        }
+    }
+
+    printf("\n%ld forwards per mode, batch 1\n\n", iters);
+    std::cout << "mode         | threads | init (ms) | mean (us) |    p50 |    p99 |    max | max |out - fp32 jit|\n";
+    std::cout << "-------------|---------|-----------|-----------|--------|--------|--------|---------------------\n";
+    for (const InferResult_t& r : results) {
+        printf("%-12s | %7d | %9.1f | %9.1f | %6u | %6u | %6u | %.2e\n", mode_names[r.mode], r.threads, r.init_ms,
+               r.mean_us, r.p50_us, r.p99_us, r.max_us, r.max_diff);
+    }
+    return 0;
+}
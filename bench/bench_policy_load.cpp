@@ -0,0 +1,144 @@
+/**
+ * 策略启动耗时基准测试
+ * 比较init_policy()从调用到可以推理的耗时(含热身)：
+ *   torchscript frozen ：torch::jit::load + freeze + optimize_for_inference
+ *   torchscript native ：torch::jit::load + 提取权重到PolicyMlp
+ *   flat mmap          ：映射policy_export导出的扁平权重文件(含CRC校验和模型文件的指纹)，不经过TorchScript
+ *   flat map only      ：只计PolicyMlp::map()
+ * cold在每次加载前用posix_fadvise(POSIX_FADV_DONTNEED)把文件逐出页缓存，近似开机后的第一次启动；
+ * warm紧接着再加载一次。扁平文件不存在时先从模型导出。两种native加载在同一输入上的输出应逐位相同
+ *
+ * 用法: bench_policy_load <模型文件> [扁平权重文件，默认为模型文件名换成.policy] [轮数]
+ */
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "algorithm_control.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief 一种加载方式的冷、热启动耗时(毫秒)
+ */
+typedef struct {
+    const char* name;
+    std::vector<double> cold_ms;
+    std::vector<double> warm_ms;
+} LoadResult_t;
+
+// 把文件逐出页缓存，只影响未被映射的干净页
+static void drop_cache(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+static long file_kb(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (f == nullptr) return -1;
+    fseek(f, 0, SEEK_END);
+    long kb = ftell(f) / 1024;
+    fclose(f);
+    return kb;
+}
+
+static std::unique_ptr<RL_ROTDOG> init(const std::string& model, const std::string& flat, PolicyCpuMode mode,
+                                       double& ms) {
+    std::unique_ptr<RL_ROTDOG> p(new RL_ROTDOG);
+    p->model_path = model;
+    p->flat_path = flat;
+    p->use_cuda = false;
+    p->cpu_mode = mode;
+    auto t0 = Clock::now();
+    p->init_policy();
+    ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    return p;
+}
+
+static double median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <model.pt> [model.policy] [rounds]\n";
+        return 1;
+    }
+    std::string model = argv[1];
+    std::string flat = argc > 2 ? argv[2] : model.substr(0, model.rfind('.')) + ".policy";
+    int rounds = argc > 3 ? atoi(argv[3]) : 3;
+
+    if (access(flat.c_str(), R_OK) != 0) {
+        double ms;
+        std::unique_ptr<RL_ROTDOG> p = init(model, "", POLICY_CPU_NATIVE, ms);
+        PolicySourceId_t source;
+        if (!p->native_active() || !policy_source_id(model.c_str(), source) || !p->native.save(flat.c_str(), source)) {
+            std::cerr << "Could not export " << flat << std::endl;
+            return 1;
+        }
+        std::cout << "exported " << flat << std::endl;
+    }
+
+    LoadResult_t results[4] = {{"torchscript frozen", {}, {}}, {"torchscript native", {}, {}},
+                               {"flat mmap", {}, {}}, {"flat map only", {}, {}}};
+    torch::Tensor out_pt, out_flat;
+    for (int r = 0; r < rounds; ++r) {
+        for (int pass = 0; pass < 2; ++pass) {
+            bool cold = pass == 0;
+            double ms;
+            if (cold) drop_cache(model);
+            init(model, "", POLICY_CPU_FROZEN, ms);
+            (cold ? results[0].cold_ms : results[0].warm_ms).push_back(ms);
+
+            if (cold) drop_cache(model);
+            std::unique_ptr<RL_ROTDOG> pt = init(model, "", POLICY_CPU_NATIVE, ms);
+            (cold ? results[1].cold_ms : results[1].warm_ms).push_back(ms);
+
+            // 映射时还要读一遍模型文件计算指纹
+            if (cold) {
+                drop_cache(flat);
+                drop_cache(model);
+            }
+            std::unique_ptr<RL_ROTDOG> fl = init(model, flat, POLICY_CPU_FROZEN, ms);
+            (cold ? results[2].cold_ms : results[2].warm_ms).push_back(ms);
+            if (!fl->native.mapped()) {
+                std::cerr << flat << " was not mapped" << std::endl;
+                return 1;
+            }
+            out_pt = pt->forward_step().clone();
+            out_flat = fl->forward_step().clone();
+            fl.reset();
+
+            PolicyMlp mlp;
+            if (cold) drop_cache(flat);
+            auto t0 = Clock::now();
+            mlp.map(flat.c_str());
+            ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+            (cold ? results[3].cold_ms : results[3].warm_ms).push_back(ms);
+        }
+    }
+
+    bool same = torch::equal(out_pt, out_flat);
+    printf("\n%s: %ld KB, %s: %ld KB, %d rounds\n\n", model.c_str(), file_kb(model), flat.c_str(), file_kb(flat),
+           rounds);
+    std::cout << "startup            | cold median (ms) | cold max (ms) | warm median (ms) | warm max (ms)\n";
+    std::cout << "-------------------|------------------|---------------|------------------|--------------\n";
+    for (const LoadResult_t& r : results) {
+        printf("%-18s | %16.2f | %13.2f | %16.2f | %13.2f\n", r.name, median(r.cold_ms),
+               *std::max_element(r.cold_ms.begin(), r.cold_ms.end()), median(r.warm_ms),
+               *std::max_element(r.warm_ms.begin(), r.warm_ms.end()));
+    }
+    printf("\nnative output, torchscript vs flat: %s\n", same ? "identical" : "DIFFERENT");
+    return same ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+/**
+ * 原生策略执行器的一致性和耗时
+ * 同一个模型分别以fp32解释执行(参考)和POLICY_CPU_NATIVE加载，用固定种子生成的观测、历史和随机的
+ * 环形缓冲起点，比较每个本机支持的内核(scalar/avx2/avx512)与LibTorch的输出，最大差超过
+ * NATIVE_TOLERANCE时返回1。之后在同一输入上计时：LibTorch的解释执行、freeze、Static Runtime
+ * 和原生执行器的各个内核，输出每次forward的p50/p99/max
+ *
+ * 用法: bench_policy_native <模型文件> [比较次数] [计时次数]
+ */
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include "algorithm_control.hpp"
+#include "latency_histogram.hpp"
+
+#define NATIVE_TOLERANCE 1e-4f  // 与fp32 LibTorch输出的最大允许差，只有求和顺序和exp近似的差别
+
+typedef std::chrono::steady_clock Clock;
+
+static std::unique_ptr<RL_ROTDOG> load(const char* path, PolicyCpuMode mode) {
+    std::unique_ptr<RL_ROTDOG> p(new RL_ROTDOG);
+    p->model_path = path;
+    p->use_cuda = false;
+    p->cpu_mode = mode;
+    p->init_policy();
+    return p;
+}
+
+// 把同一份观测、历史和起点写入策略
+static void set_inputs(RL_ROTDOG& p, const torch::Tensor& obs, const torch::Tensor& ring, int head) {
+    p.obs_in.copy_(obs);
+    p.obs_ring.copy_(ring);
+    p.ring_head = head;
+}
+
+static void time_forward(const char* name, RL_ROTDOG& p, long iters) {
+    std::unique_ptr<LatencyHistogram> hist(new LatencyHistogram);
+    double sum_us = 0;
+    for (long i = 0; i < iters; ++i) {
+        auto t0 = Clock::now();
+        p.forward_step();
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+        hist->record((uint32_t)us);
+        sum_us += us;
+    }
+    LatencyHistSnapshot_t snap;
+    hist->snapshot(snap);
+    printf("%-16s | %9.1f | %6u | %6u | %6u\n", name, sum_us / iters, latency_hist_quantile(snap, 0.5),
+           latency_hist_quantile(snap, 0.99), latency_hist_max(snap));
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <model.pt> [trials] [iters]\n";
+        return 1;
+    }
+    long trials = argc > 2 ? atol(argv[2]) : 1000;
+    long iters = argc > 3 ? atol(argv[3]) : 5000;
+
+    std::unique_ptr<RL_ROTDOG> ref = load(argv[1], POLICY_CPU_JIT);
+    std::unique_ptr<RL_ROTDOG> nat = load(argv[1], POLICY_CPU_NATIVE);
+    if (!nat->native_active()) {
+        std::cerr << "Native executor could not be built from " << argv[1] << std::endl;
+        return 1;
+    }
+    const int H = ref->history_length;
+
+    // 一致性：每次比较换一组输入，各内核使用同一组
+    torch::manual_seed(0);
+    std::vector<PolicyMlpIsa> isas;
+    for (int isa = MLP_ISA_SCALAR; isa <= PolicyMlp::best_isa(); ++isa) isas.push_back((PolicyMlpIsa)isa);
+    std::vector<float> max_diff(isas.size(), 0.0f);
+    float max_ref = 0.0f;
+    for (long t = 0; t < trials; ++t) {
+        torch::Tensor obs = torch::randn({1, 45});
+        torch::Tensor hist = torch::randn({H, 45});
+        torch::Tensor ring = torch::cat({hist, hist}, 0);
+        int head = (int)(t % H);
+        set_inputs(*ref, obs, ring, head);
+        torch::Tensor expect = ref->forward_step().clone();
+        max_ref = std::max(max_ref, expect.abs().max().item<float>());
+        set_inputs(*nat, obs, ring, head);
+        for (size_t k = 0; k < isas.size(); ++k) {
+            nat->native.set_isa(isas[k]);
+            torch::Tensor got = nat->forward_step();
+            max_diff[k] = std::max(max_diff[k], (got - expect).abs().max().item<float>());
+        }
+    }
+    bool ok = true;
+    printf("\nequivalence over %ld random inputs (|output| up to %.2f):\n", trials, max_ref);
+    for (size_t k = 0; k < isas.size(); ++k) {
+        bool pass = max_diff[k] <= NATIVE_TOLERANCE;
+        printf("  native %-7s max |native - libtorch| = %.2e %s\n", PolicyMlp::isa_name(isas[k]), max_diff[k],
+               pass ? "OK" : "FAIL");
+        ok = ok && pass;
+    }
+
+    // 耗时：同一组输入
+    torch::Tensor obs = torch::randn({1, 45}) * 0.5;
+    torch::Tensor hist = torch::randn({H, 45}) * 0.5;
+    torch::Tensor ring = torch::cat({hist, hist}, 0);
+    std::unique_ptr<RL_ROTDOG> frozen = load(argv[1], POLICY_CPU_FROZEN);
+    std::unique_ptr<RL_ROTDOG> stat = load(argv[1], POLICY_CPU_STATIC);
+    set_inputs(*ref, obs, ring, 0);
+    set_inputs(*frozen, obs, ring, 0);
+    set_inputs(*stat, obs, ring, 0);
+    set_inputs(*nat, obs, ring, 0);
+
+    printf("\nforward (us), %ld iterations, 1 thread\n", iters);
+    std::cout << "backend          |      mean |    p50 |    p99 |    max\n";
+    time_forward("libtorch jit", *ref, iters);
+    time_forward("libtorch frozen", *frozen, iters);
+    time_forward("libtorch static", *stat, iters);
+    for (PolicyMlpIsa isa : isas) {
+        nat->native.set_isa(isa);
+        std::string name = std::string("native ") + PolicyMlp::isa_name(isa);
+        time_forward(name.c_str(), *nat, iters);
+    }
+    std::cout << (ok ? "OK" : "MISMATCH") << std::endl;
+    return ok ? 0 : 1;
+}
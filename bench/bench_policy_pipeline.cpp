@@ -0,0 +1,172 @@
+/**
+ * 策略动作交接基准测试
+ * 推理线程以50hz发布动作(关节目标为观测时刻的正弦参考值，发布前睡眠随机的推理时间)，
+ * 控制线程以1khz用ActionInterpolator取用，依次测试每种目标曲线，输出：
+ *   发布/取用/被覆盖的动作数，取用的动作与其观测时刻的参考值不一致的次数(撕裂，应为0)，
+ *   相邻节拍目标的最大变化(按节拍间隔折算到每毫秒，丢弃的节拍不会放大结果)，目标与节拍时刻参考值的RMS/最大误差，
+ *   观测 -> 推理完成、观测 -> 控制节拍首次使用的时延，以及每个节拍update()的耗时
+ *
+ * 用法: bench_policy_pipeline [每种曲线的秒数] [最大推理时间(ms)]
+ */
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "policy_pipeline.hpp"
+#include "periodic_loop.hpp"
+#include "rt_util.hpp"
+
+#define PIPELINE_REF_HZ 1.5    // 参考轨迹的频率，接近步态频率
+#define PIPELINE_REF_AMP 0.3   // 参考轨迹的幅度(rad)
+
+static const char* profile_names[] = {"hold", "linear", "smooth"};
+
+// 关节m在t时刻的参考目标
+static float reference(int m, int64_t t_ns) {
+    return (float)(PIPELINE_REF_AMP * sin(2 * M_PI * PIPELINE_REF_HZ * t_ns * 1e-9 + 0.5 * m));
+}
+
+/**
+ * @brief 一种目标曲线的测量结果
+ */
+typedef struct {
+    PolicyPipelineStats_t counts;
+    uint64_t ticks;
+    uint64_t torn;          // 取用的动作与其观测时刻的参考值不一致
+    double max_jump;        // 相邻节拍目标的最大变化(rad/ms)
+    double rms_err;         // 目标 - 节拍时刻参考值
+    double max_err;
+    double update_ns;       // 每次update()的平均耗时
+    uint64_t update_max_ns;
+    LatencyHistSnapshot_t infer_us, apply_us;
+} PipelineResult_t;
+
+static void run_profile(PolicyActionProfile profile, double seconds, double max_delay_ms, PipelineResult_t& r) {
+    std::atomic<bool> produce(true), consume(true);
+    PolicyPipelineStats_t c0 = get_policy_pipeline_stats();
+    std::unique_ptr<LatencyHistSnapshot_t> i0(new LatencyHistSnapshot_t), a0(new LatencyHistSnapshot_t);
+    get_policy_latency_snapshot(POLICY_LAT_INFER, *i0);
+    get_policy_latency_snapshot(POLICY_LAT_APPLY, *a0);
+
+    std::thread producer([&]() {
+        PeriodicLoop loop("bench_policy", std::chrono::milliseconds(20), OverrunPolicy::REPHASE);
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<double> delay_ms(0.5, max_delay_ms);
+        float target[NUM_JOINTS];
+        while (produce.load()) {
+            int64_t obs_ns = steady_ns();
+            for (int m = 0; m < NUM_JOINTS; ++m) target[m] = reference(m, obs_ns);
+            std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(delay_ms(rng) * 1000)));
+            if (policy_step_accept(target, obs_ns, 0)) policy_action_publish(target, obs_ns);
+            loop.wait();
+        }
+    });
+
+    r.ticks = r.torn = r.update_max_ns = 0;
+    r.max_jump = r.max_err = 0;
+    double sum_sq = 0, sum_update = 0;
+    std::thread consumer([&]() {
+        PeriodicLoop loop("bench_control", std::chrono::milliseconds(1), OverrunPolicy::SKIP);
+        ActionInterpolator interp;
+        interp.set_profile(profile, 20 * 1000000LL);
+        float zero[NUM_JOINTS] = {0};
+        interp.reset(zero);
+        float prev[NUM_JOINTS] = {0};
+        int64_t prev_tick_ns = 0;
+        int actions = 0;
+        while (consume.load()) {
+            int64_t tick_ns = steady_ns(loop.start());
+            int64_t t0 = steady_ns();
+            bool fresh = interp.update(tick_ns);
+            uint64_t dt = (uint64_t)(steady_ns() - t0);
+            sum_update += dt;
+            r.update_max_ns = std::max(r.update_max_ns, dt);
+            const PolicyAction_t& a = interp.current();
+            if (fresh) {
+                actions++;
+                for (int m = 0; m < NUM_JOINTS; ++m) {
+                    if (a.target[m] != reference(m, a.obs_ns)) {
+                        r.torn++;
+                        break;
+                    }
+                }
+            }
+            // 从第二个动作开始统计，之前是从0到第一个动作的过渡
+            if (actions >= 2) {
+                const float* out = interp.target();
+                double dt_ms = (tick_ns - prev_tick_ns) / 1e6;
+                for (int m = 0; m < NUM_JOINTS; ++m) {
+                    double e = out[m] - reference(m, tick_ns);
+                    sum_sq += e * e;
+                    r.max_err = std::max(r.max_err, std::fabs(e));
+                    if (r.ticks > 0) r.max_jump = std::max(r.max_jump, std::fabs(out[m] - prev[m]) / dt_ms);
+                    prev[m] = out[m];
+                }
+                prev_tick_ns = tick_ns;
+                r.ticks++;
+            }
+            loop.wait();
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    produce.store(false);
+    producer.join();
+    // 控制线程取走最后一个动作后再停止，下一种曲线从空的动作槽开始
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    consume.store(false);
+    consumer.join();
+
+    PolicyPipelineStats_t c1 = get_policy_pipeline_stats();
+    r.counts.published = c1.published - c0.published;
+    r.counts.applied = c1.applied - c0.applied;
+    r.counts.superseded = c1.superseded - c0.superseded;
+    r.rms_err = r.ticks > 0 ? sqrt(sum_sq / (r.ticks * NUM_JOINTS)) : 0;
+    r.update_ns = r.ticks > 0 ? sum_update / r.ticks : 0;
+    std::unique_ptr<LatencyHistSnapshot_t> now(new LatencyHistSnapshot_t);
+    get_policy_latency_snapshot(POLICY_LAT_INFER, *now);
+    latency_hist_subtract(*now, *i0, r.infer_us);
+    get_policy_latency_snapshot(POLICY_LAT_APPLY, *now);
+    latency_hist_subtract(*now, *a0, r.apply_us);
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 3.0;
+    double max_delay_ms = argc > 2 ? atof(argv[2]) : 8.0;
+
+    std::unique_ptr<PipelineResult_t[]> results(new PipelineResult_t[3]);
+    for (int p = POLICY_PROFILE_HOLD; p <= POLICY_PROFILE_SMOOTH; ++p) {
+        std::cout << "running " << profile_names[p] << " for " << seconds << " s" << std::endl;
+        run_profile((PolicyActionProfile)p, seconds, max_delay_ms, results[p]);
+    }
+
+    printf("\n50 Hz policy (inference 0.5-%.1f ms) -> 1 kHz control, reference %.1f Hz, %.2f rad\n\n",
+           max_delay_ms, PIPELINE_REF_HZ, PIPELINE_REF_AMP);
+    std::cout << "profile | published | applied | superseded | torn | max rad/ms     | rms err | max err"
+                 " | update mean/max (ns)\n";
+    std::cout << "--------|-----------|---------|------------|------|----------------|---------|--------"
+                 "|---------------------\n";
+    bool ok = true;
+    for (int p = POLICY_PROFILE_HOLD; p <= POLICY_PROFILE_SMOOTH; ++p) {
+        const PipelineResult_t& r = results[p];
+        printf("%-7s | %9lu | %7lu | %10lu | %4lu | %14.4f | %7.4f | %7.4f | %8.0f / %lu\n", profile_names[p],
+               r.counts.published, r.counts.applied, r.counts.superseded, r.torn, r.max_jump, r.rms_err, r.max_err,
+               r.update_ns, r.update_max_ns);
+        ok = ok && r.torn == 0;
+    }
+    std::cout << "\nlatency (us)            |    p50 |    p99 |    max\n";
+    for (int p = POLICY_PROFILE_HOLD; p <= POLICY_PROFILE_SMOOTH; ++p) {
+        const PipelineResult_t& r = results[p];
+        printf("%-7s obs->done       | %6u | %6u | %6u\n", profile_names[p], latency_hist_quantile(r.infer_us, 0.5),
+               latency_hist_quantile(r.infer_us, 0.99), latency_hist_max(r.infer_us));
+        printf("%-7s obs->applied    | %6u | %6u | %6u\n", profile_names[p], latency_hist_quantile(r.apply_us, 0.5),
+               latency_hist_quantile(r.apply_us, 0.99), latency_hist_max(r.apply_us));
+    }
+    std::cout << (ok ? "OK" : "TORN ACTIONS") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+/**
+ * 策略单步开销基准测试
+ * 用合成的IMU和关节数据驱动同一个模型，比较两种handleMessage()：
+ *   legacy  ：原实现的逐步做法(vector逐个push_back、from_blob().to(device)、每步转换为网络类型、
+ *             两次torch::cat移位历史、last_action.clone()、.to(kFloat32).to(kCPU))
+ *   current ：RL_ROTDOG::handleMessage()，观测一次写入预分配的张量存储，历史为环形缓冲
+ * 另外单独计时model.forward()作为下限，每步开销 = 单步耗时 - forward耗时。
+ * 两条路径的历史各自维护，输出的动作应只差舍入(网络为fp16时)
+ *
+ * 用法: bench_policy_step <模型文件> [步数] [cpu|cuda] [CPU推理方式(0=fp16 1=jit 2=frozen 3=static 4=native)]
+ */
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <torch/cuda.h>
+#include "algorithm_control.hpp"
+#include "imu.hpp"
+#include "joint_bus.hpp"
+#include "latency_histogram.hpp"
+
+using namespace torch::indexing;
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * 原handleMessage()的张量操作，模型和缩放系数取自RL_ROTDOG
+ */
+struct LegacyPolicy {
+    torch::Tensor obs_buf;
+    torch::Tensor action_buf;
+    torch::Tensor last_action;
+    std::vector<float> action_temp;
+    float action[12];
+
+    void init(RL_ROTDOG& p) {
+        obs_buf = torch::zeros({p.history_length, 45}, torch::TensorOptions().dtype(torch::kFloat32).device(p.device));
+        action_buf = torch::zeros({p.history_length, 12}, torch::TensorOptions().dtype(p.dtype).device(p.device));
+        last_action = torch::zeros({1, 12}, torch::TensorOptions().dtype(p.dtype).device(p.device));
+        action_temp.assign(12, 0.0f);
+    }
+
+    void step(RL_ROTDOG& p) {
+        std::vector<float> obs;
+        float imu_out;
+        obs.push_back(imu.imu_data.RollSpeed * p.omega_scale);
+        obs.push_back(imu.imu_data.aPitchSpeedcc_y * p.omega_scale);
+        obs.push_back(-imu.imu_data.HeadingSpeed * p.omega_scale);
+        if (imu.imu_data.Heading > M_PI) {
+            imu_out = imu.imu_data.Heading - 2 * M_PI;
+        } else if (imu.imu_data.Heading < -M_PI) {
+            imu_out = imu.imu_data.Heading + 2 * M_PI;
+        } else {
+            imu_out = imu.imu_data.Heading;
+        }
+        obs.push_back(imu.imu_data.Roll * p.eu_ang_scale);
+        obs.push_back(imu.imu_data.Pitch * p.eu_ang_scale);
+        obs.push_back(-imu_out * p.eu_ang_scale);
+        obs.push_back(p.cmd_x * p.lin_vel);
+        obs.push_back(p.cmd_y * p.lin_vel);
+        obs.push_back(p.cmd_rate * p.ang_vel);
+
+        JointBusState_t state;
+        joint_bus_read_state(state);
+        for (int i = 0; i < 12; i++) obs.push_back((state.pos[i] - p.init_pos[i]) * p.pos_scale);
+        for (int i = 0; i < 12; i++) obs.push_back(state.spd[i] * p.vel_scale);
+        for (int i = 0; i < 12; i++) obs.push_back(action_temp[i]);
+
+        auto options = torch::TensorOptions().dtype(torch::kFloat32);
+        torch::Tensor obs_tensor = torch::from_blob(obs.data(), {1, 45}, options).to(p.device);
+        auto obs_buf_batch = obs_buf.unsqueeze(0);
+        std::vector<torch::jit::IValue> inputs;
+        inputs.push_back(obs_tensor.to(p.dtype));
+        inputs.push_back(obs_buf_batch.to(p.dtype));
+        torch::Tensor action_tensor = p.model.forward(inputs).toTensor();
+
+        action_buf = torch::cat({action_buf.index({Slice(1, None), Slice()}), action_tensor}, 0);
+        bool has_nan = false;
+        for (float val : obs) {
+            if (std::isnan(val)) {
+                has_nan = true;
+                break;
+            }
+        }
+        if (has_nan) std::cerr << "Warning: NaN detected in observation data." << std::endl;
+        torch::Tensor action_blend_tensor = 0.8 * action_tensor + 0.2 * last_action;
+        last_action = action_tensor.clone();
+        obs_buf = torch::cat({obs_buf.index({Slice(1, None), Slice()}), obs_tensor}, 0);
+
+        torch::Tensor action_raw = action_blend_tensor.squeeze(0);
+        action_raw = action_raw.to(torch::kFloat32);
+        action_raw = action_raw.to(torch::kCPU);
+        auto action_getter = action_raw.accessor<float, 1>();
+        for (int j = 0; j < 12; j++) {
+            action[j] = action_getter[j] * p.action_scale[j] + p.init_pos[j];
+            action_temp[j] = action_getter[j];
+        }
+    }
+};
+
+/**
+ * 第k步的合成传感器数据：各通道不同频率的正弦，幅度接近实际步态
+ */
+static void feed_inputs(RL_ROTDOG& p, long k) {
+    double t = k * 0.02;
+    imu.imu_data.RollSpeed = 0.3f * (float)sin(2.1 * t);
+    imu.imu_data.aPitchSpeedcc_y = 0.4f * (float)sin(1.7 * t + 0.5);
+    imu.imu_data.HeadingSpeed = 0.2f * (float)sin(0.9 * t);
+    imu.imu_data.Roll = 0.05f * (float)sin(2.1 * t + 1.0);
+    imu.imu_data.Pitch = 0.08f * (float)sin(1.7 * t);
+    imu.imu_data.Heading = (float)fmod(0.2 * t, 2 * M_PI) - (float)M_PI;
+    JointState_t joints;
+    for (int m = 0; m < NUM_JOINTS; ++m) {
+        joints.pos[m] = p.init_pos[joint_motor_to_net(m)] + 0.2f * (float)sin(6.0 * t + 0.4 * m);
+        joints.spd[m] = 1.2f * (float)cos(6.0 * t + 0.4 * m);
+        joints.tor[m] = 0.0f;
+    }
+    joint_bus_inject_feedback(joints, (int64_t)(t * 1e9));
+    p.cmd_x = 0.5f;
+    p.cmd_y = 0.0f;
+    p.cmd_rate = 0.1f * (float)sin(0.3 * t);
+}
+
+static double elapsed_us(Clock::time_point t0, Clock::time_point t1) {
+    return std::chrono::duration<double, std::micro>(t1 - t0).count();
+}
+
+static void print_row(const char* name, LatencyHistogram& h, double sum_us, long n) {
+    LatencyHistSnapshot_t snap;
+    h.snapshot(snap);
+    printf("%-16s | mean %8.1f | p50 %6u | p99 %6u | max %6u\n", name, sum_us / n,
+           latency_hist_quantile(snap, 0.5), latency_hist_quantile(snap, 0.99), latency_hist_max(snap));
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <model.pt> [steps] [cpu|cuda] [cpu mode 0-4]\n";
+        return 1;
+    }
+    long steps = argc > 2 ? atol(argv[2]) : 2000;
+    const long warmup = 50;
+
+    RL_ROTDOG policy;
+    policy.model_path = argv[1];
+    policy.use_cuda = argc > 3 && strcmp(argv[3], "cuda") == 0;
+    if (argc > 4) policy.cpu_mode = (PolicyCpuMode)atoi(argv[4]);
+    policy.init_policy();
+    LegacyPolicy legacy;
+    legacy.init(policy);
+
+    std::unique_ptr<LatencyHistogram> h_legacy(new LatencyHistogram);
+    std::unique_ptr<LatencyHistogram> h_current(new LatencyHistogram);
+    std::unique_ptr<LatencyHistogram> h_forward(new LatencyHistogram);
+    double sum_legacy = 0, sum_current = 0, sum_forward = 0, max_diff = 0;
+    for (long k = 0; k < warmup + steps; ++k) {
+        feed_inputs(policy, k);
+
+        auto t0 = Clock::now();
+        legacy.step(policy);
+        auto t1 = Clock::now();
+        policy.handleMessage();
+        auto t2 = Clock::now();
+        {
+            // 与current相同的输入，只计网络本身(CUDA时等待核函数完成)
+            torch::Tensor out = policy.forward_step();
+            if (policy.device == torch::kCUDA) torch::cuda::synchronize();
+        }
+        auto t3 = Clock::now();
+        if (k < warmup) continue;
+
+        double us_legacy = elapsed_us(t0, t1), us_current = elapsed_us(t1, t2), us_forward = elapsed_us(t2, t3);
+        h_legacy->record((uint32_t)us_legacy);
+        h_current->record((uint32_t)us_current);
+        h_forward->record((uint32_t)us_forward);
+        sum_legacy += us_legacy;
+        sum_current += us_current;
+        sum_forward += us_forward;
+        for (int j = 0; j < 12; ++j) {
+            max_diff = std::max(max_diff, (double)std::fabs(legacy.action[j] - policy.action[j]));
+        }
+    }
+
+    printf("\n%ld policy steps on %s (after %ld warm-up steps)\n\n", steps,
+           policy.device == torch::kCUDA ? "cuda" : "cpu", warmup);
+    std::cout << "step (us)        |     mean |    p50 |    p99 |    max\n";
+    print_row("legacy", *h_legacy, sum_legacy, steps);
+    print_row("current", *h_current, sum_current, steps);
+    print_row("forward only", *h_forward, sum_forward, steps);
+    printf("\noverhead beyond forward: legacy %.1f us, current %.1f us per step\n",
+           (sum_legacy - sum_forward) / steps, (sum_current - sum_forward) / steps);
+    printf("action max |legacy - current| = %.6f rad\n", max_diff);
+    return 0;
+}
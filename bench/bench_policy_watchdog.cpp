@@ -0,0 +1,190 @@
+/**
+ * 推理看门狗故障注入测试
+ * 推理线程以50hz发布动作，按场景注入故障：部分步超过预算(late)、部分步输出NaN(nan)、
+ * 某一步卡住300ms(hang)；控制线程以1khz用ActionInterpolator取用，每个场景分别测试保持和衰减两种目标，输出：
+ *   各原因拒绝的步数与注入的次数，错过的策略步数和连续错过步数的分布，触发保护的次数及从最后一个好动作的观测到触发的时间，
+ *   错过期间目标不符合设定(保持时不等于最后的好动作，衰减时离静止姿态变远)的节拍数(应为0)，
+ *   控制节拍开始相对计划时刻的最大延迟和update()的最大耗时(推理卡住时不应变大)
+ *
+ * 用法: bench_policy_watchdog [每个场景的秒数]
+ */
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "policy_pipeline.hpp"
+#include "periodic_loop.hpp"
+#include "rt_util.hpp"
+
+#define WATCHDOG_PERIOD_MS 20
+#define WATCHDOG_DEADLINE_MS 20
+#define WATCHDOG_DECAY_MS 200
+#define WATCHDOG_MAX_MISSES 5
+#define WATCHDOG_INFER_MS 2     // 正常一步的推理时间
+#define WATCHDOG_LATE_EVERY 10  // late：每10步有一步推理25ms
+#define WATCHDOG_NAN_EVERY 7    // nan：每7步有一步输出NaN
+#define WATCHDOG_HANG_STEP 40   // hang：第40步卡住300ms
+
+enum WatchdogScenario {
+    SCENARIO_LATE = 0,
+    SCENARIO_NAN,
+    SCENARIO_HANG,
+    SCENARIOS
+};
+
+static const char* scenario_names[SCENARIOS] = {"late", "nan", "hang"};
+static const char* fallback_names[] = {"hold", "decay"};
+
+/**
+ * @brief 一个场景的测量结果
+ */
+typedef struct {
+    PolicyPipelineStats_t counts;
+    uint64_t injected;        // 注入的故障步数
+    uint64_t ticks;
+    uint64_t stale_ticks;     // 错过期间的节拍数
+    uint64_t violations;      // 错过期间目标不符合设定的节拍数
+    int64_t escalate_ms;      // 最后一个好动作的观测 -> 触发保护，-1为没有触发
+    int64_t max_late_us;      // 节拍开始相对计划时刻的最大延迟
+    int64_t update_max_ns;
+} WatchdogResult_t;
+
+static void run_scenario(WatchdogScenario scenario, PolicyFallback fallback, double seconds, WatchdogResult_t& r) {
+    std::atomic<bool> produce(true), consume(true);
+    PolicyPipelineStats_t c0 = get_policy_pipeline_stats();
+    r.injected = 0;
+
+    std::thread producer([&]() {
+        PeriodicLoop loop("bench_policy", std::chrono::milliseconds(WATCHDOG_PERIOD_MS), OverrunPolicy::REPHASE);
+        float target[NUM_JOINTS];
+        for (int step = 1; produce.load(); ++step) {
+            int64_t obs_ns = steady_ns();
+            for (int m = 0; m < NUM_JOINTS; ++m) target[m] = 0.3f * sinf(0.1f * step + 0.5f * m);
+            int delay_ms = WATCHDOG_INFER_MS;
+            if (scenario == SCENARIO_LATE && step % WATCHDOG_LATE_EVERY == 0) {
+                delay_ms = WATCHDOG_DEADLINE_MS + 5;
+                r.injected++;
+            } else if (scenario == SCENARIO_NAN && step % WATCHDOG_NAN_EVERY == 0) {
+                target[step % NUM_JOINTS] = NAN;
+                r.injected++;
+            } else if (scenario == SCENARIO_HANG && step == WATCHDOG_HANG_STEP) {
+                delay_ms = 300;
+                r.injected++;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+            if (policy_step_accept(target, obs_ns, (int64_t)WATCHDOG_DEADLINE_MS * 1000000)) {
+                policy_action_publish(target, obs_ns);
+            }
+            loop.wait();
+        }
+    });
+
+    r.ticks = r.stale_ticks = r.violations = 0;
+    r.escalate_ms = -1;
+    r.max_late_us = r.update_max_ns = 0;
+    std::thread consumer([&]() {
+        PeriodicLoop loop("bench_control", std::chrono::milliseconds(1), OverrunPolicy::SKIP);
+        ActionInterpolator interp;
+        interp.set_profile(POLICY_PROFILE_HOLD, 0);
+        interp.set_watchdog((int64_t)WATCHDOG_PERIOD_MS * 1000000, (int64_t)WATCHDOG_DEADLINE_MS * 1000000, fallback,
+                            (int64_t)WATCHDOG_DECAY_MS * 1000000, WATCHDOG_MAX_MISSES);
+        float rest[NUM_JOINTS] = {0};
+        interp.reset(rest);
+        float prev[NUM_JOINTS] = {0};
+        bool prev_stale = false;
+        while (consume.load()) {
+            int64_t tick_ns = steady_ns(loop.start());
+            int64_t t0 = steady_ns();
+            r.max_late_us = std::max(r.max_late_us, (t0 - tick_ns) / 1000);
+            interp.update(tick_ns);
+            r.update_max_ns = std::max(r.update_max_ns, steady_ns() - t0);
+            const float* out = interp.target();
+            const PolicyAction_t& a = interp.current();
+            bool stale = interp.missed() > 0;
+            if (stale) {
+                r.stale_ticks++;
+                for (int m = 0; m < NUM_JOINTS; ++m) {
+                    bool ok = fallback == POLICY_FALLBACK_HOLD
+                                  ? out[m] == a.target[m]
+                                  : !prev_stale || std::fabs(out[m] - rest[m]) <= std::fabs(prev[m] - rest[m]);
+                    if (!ok) {
+                        r.violations++;
+                        break;
+                    }
+                }
+            }
+            if (interp.expired() && r.escalate_ms < 0) r.escalate_ms = (tick_ns - a.obs_ns) / 1000000;
+            for (int m = 0; m < NUM_JOINTS; ++m) prev[m] = out[m];
+            prev_stale = stale;
+            r.ticks++;
+            loop.wait();
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    produce.store(false);
+    producer.join();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    consume.store(false);
+    consumer.join();
+
+    PolicyPipelineStats_t c1 = get_policy_pipeline_stats();
+    r.counts.published = c1.published - c0.published;
+    r.counts.applied = c1.applied - c0.applied;
+    r.counts.superseded = c1.superseded - c0.superseded;
+    for (int k = 0; k < POLICY_REJECT_REASONS; ++k) r.counts.rejected[k] = c1.rejected[k] - c0.rejected[k];
+    r.counts.missed = c1.missed - c0.missed;
+    r.counts.escalations = c1.escalations - c0.escalations;
+    for (int b = 0; b < POLICY_MISS_RUN_BINS; ++b) r.counts.miss_runs[b] = c1.miss_runs[b] - c0.miss_runs[b];
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+
+    WatchdogResult_t results[SCENARIOS][2];
+    for (int s = 0; s < SCENARIOS; ++s) {
+        for (int f = POLICY_FALLBACK_HOLD; f <= POLICY_FALLBACK_DECAY; ++f) {
+            std::cout << "running " << scenario_names[s] << "/" << fallback_names[f] << " for " << seconds << " s"
+                      << std::endl;
+            run_scenario((WatchdogScenario)s, (PolicyFallback)f, seconds, results[s][f]);
+        }
+    }
+
+    printf("\n%d ms policy, %d ms budget, escalation after %d misses, decay %d ms\n\n", WATCHDOG_PERIOD_MS,
+           WATCHDOG_DEADLINE_MS, WATCHDOG_MAX_MISSES, WATCHDOG_DECAY_MS);
+    std::cout << "scenario   | injected | late | nan | published | missed | runs 1..7+           | escalate"
+                 " | stale ticks | bad | tick late max (us) | update max (ns)\n";
+    std::cout << "-----------|----------|------|-----|-----------|--------|----------------------|---------"
+                 "|-------------|-----|--------------------|----------------\n";
+    bool ok = true;
+    for (int s = 0; s < SCENARIOS; ++s) {
+        for (int f = POLICY_FALLBACK_HOLD; f <= POLICY_FALLBACK_DECAY; ++f) {
+            const WatchdogResult_t& r = results[s][f];
+            char runs[64];
+            int n = 0;
+            for (int b = 1; b < POLICY_MISS_RUN_BINS; ++b) {
+                n += snprintf(runs + n, sizeof(runs) - n, "%lu ", r.counts.miss_runs[b]);
+            }
+            char escalate[32];
+            if (r.escalate_ms >= 0) {
+                snprintf(escalate, sizeof(escalate), "%ld ms", r.escalate_ms);
+            } else {
+                snprintf(escalate, sizeof(escalate), "-");
+            }
+            char name[32];
+            snprintf(name, sizeof(name), "%s/%s", scenario_names[s], fallback_names[f]);
+            printf("%-10s | %8lu | %4lu | %3lu | %9lu | %6lu | %-20s | %8s | %11lu | %3lu | %18ld | %ld\n", name,
+                   r.injected, r.counts.rejected[POLICY_REJECT_LATE], r.counts.rejected[POLICY_REJECT_NAN_ACTION],
+                   r.counts.published, r.counts.missed, runs, escalate, r.stale_ticks, r.violations, r.max_late_us,
+                   r.update_max_ns);
+            uint64_t rejected = r.counts.rejected[POLICY_REJECT_LATE] + r.counts.rejected[POLICY_REJECT_NAN_ACTION];
+            bool escalated = r.counts.escalations > 0;
+            ok = ok && rejected == r.injected && r.violations == 0 && escalated == (s == SCENARIO_HANG);
+        }
+    }
+    std::cout << (ok ? "OK" : "WATCHDOG MISMATCH") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+/**
+ * 策略离线回放
+ * 读取telemetry记录的遥测文件，把每个控制周期的IMU数据、关节位置/速度(电机顺序)和键盘指令
+ * 按rl_run()的节拍(默认20ms)送入RL_ROTDOG::handleMessage()，输出每一步的动作和推理耗时。
+ * 不需要电机串口、IMU和GPU；速度倍率为0时不等待，尽可能快地回放
+ *
+ * 每一步的动作与下一步记录中机器人实际使用的动作比较，差值可用于推理改动的回归检查
+ * (回放必须从RL启动前开始，网络的历史观测才与实机一致)
+ *
+ * 用法: bench_replay <遥测文件> <模型文件> [速度倍率] [cpu|cuda] [输出CSV]
+ */
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "algorithm_control.hpp"
+#include "imu.hpp"
+#include "joint_bus.hpp"
+#include "telemetry.hpp"
+#include "latency_histogram.hpp"
+
+#define REPLAY_STEP_NS 20000000LL  // rl_run()的周期
+
+typedef std::chrono::steady_clock Clock;
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <telemetry.bin> <model.pt> [speed] [cpu|cuda] [out.csv]\n";
+        std::cerr << "speed: 0 = as fast as possible (default), 1 = real time\n";
+        return 1;
+    }
+    const char* log_path = argv[1];
+    double speed = argc > 3 ? atof(argv[3]) : 0.0;
+    bool use_cuda = argc > 4 && strcmp(argv[4], "cuda") == 0;
+    const char* out_path = argc > 5 ? argv[5] : nullptr;
+
+    FILE* fp = fopen(log_path, "rb");
+    if (fp == NULL) {
+        std::cerr << "Failed to open " << log_path << std::endl;
+        return 1;
+    }
+    TelemetryFileHeader_t header;
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        memcmp(header.magic, TELEMETRY_MAGIC, sizeof(TELEMETRY_MAGIC)) != 0 ||
+        header.version != TELEMETRY_VERSION || header.record_size != sizeof(TelemetryRecord_t)) {
+        std::cerr << "Unsupported telemetry file " << log_path << " (expected version " << TELEMETRY_VERSION
+                  << ", " << sizeof(TelemetryRecord_t) << " bytes/record)" << std::endl;
+        fclose(fp);
+        return 1;
+    }
+
+    FILE* out = NULL;
+    if (out_path != nullptr) {
+        out = fopen(out_path, "w");
+        if (out == NULL) {
+            std::cerr << "Failed to open " << out_path << std::endl;
+            fclose(fp);
+            return 1;
+        }
+        fprintf(out, "step,stamp_s,latency_us,max_diff");
+        for (int k = 0; k < NUM_JOINTS; ++k) fprintf(out, ",a%d", k);
+        fprintf(out, "\n");
+    }
+
+    RL_ROTDOG policy;
+    policy.model_path = argv[2];
+    policy.use_cuda = use_cuda;
+    policy.init_policy();
+
+    std::unique_ptr<LatencyHistogram> latency_us(new LatencyHistogram);
+    std::unique_ptr<LatencyHistSnapshot_t> snap(new LatencyHistSnapshot_t);
+    TelemetryRecord_t rec;
+    long records = 0, steps = 0;
+    int64_t first_ns = 0, last_ns = 0, next_step_ns = 0;
+    float prev_action[NUM_JOINTS];  // 上一步回放得到的动作，网络顺序
+    bool have_prev = false;
+    double max_diff = 0.0, sum_diff = 0.0;
+    long compared = 0;
+    auto wall_start = Clock::now();
+
+    while (fread(&rec, sizeof(rec), 1, fp) == 1) {
+        if (records++ == 0) {
+            first_ns = rec.stamp_ns;
+            next_step_ns = rec.stamp_ns;
+        }
+        last_ns = rec.stamp_ns;
+        // rl_run()只在RL启动后调用handleMessage()
+        if (rec.rl_start < 1 || rec.stamp_ns < next_step_ns) continue;
+        next_step_ns += REPLAY_STEP_NS;
+        if (next_step_ns <= rec.stamp_ns) next_step_ns = rec.stamp_ns + REPLAY_STEP_NS;
+
+        if (speed > 0) {
+            auto due = wall_start + std::chrono::nanoseconds((int64_t)((rec.stamp_ns - first_ns) / speed));
+            std::this_thread::sleep_until(due);
+        }
+
+        // 上一步的动作与机器人这一时刻实际使用的动作比较
+        double diff = 0.0;
+        if (have_prev) {
+            for (int m = 0; m < NUM_JOINTS; ++m) {
+                diff = std::max(diff, (double)std::fabs(prev_action[joint_motor_to_net(m)] - rec.action[m]));
+            }
+            max_diff = std::max(max_diff, diff);
+            sum_diff += diff;
+            compared++;
+        }
+
+        // 送入本周期的传感器数据
+        imu.imu_data = rec.imu;
+        imu.imu_body_vel = rec.imu_vel;
+        imu.imu_body_acc = rec.imu_acc;
+        JointState_t joints;
+        for (int m = 0; m < NUM_JOINTS; ++m) {
+            joints.pos[m] = rec.pos[m];
+            joints.spd[m] = rec.spd[m];
+            joints.tor[m] = rec.tor[m];
+        }
+        joint_bus_inject_feedback(joints, rec.stamp_ns);
+        policy.cmd_x = rec.cmd[0];
+        policy.cmd_y = rec.cmd[1];
+        policy.cmd_rate = rec.cmd[2];
+
+        auto t0 = Clock::now();
+        policy.handleMessage();
+        auto t1 = Clock::now();
+        uint32_t us = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+        latency_us->record(us);
+
+        for (int k = 0; k < NUM_JOINTS; ++k) prev_action[k] = policy.action[k];
+        have_prev = true;
+        if (out != NULL) {
+            fprintf(out, "%ld,%.6f,%u,%.6f", steps, (rec.stamp_ns - first_ns) * 1e-9, us, diff);
+            for (int k = 0; k < NUM_JOINTS; ++k) fprintf(out, ",%.6f", policy.action[k]);
+            fprintf(out, "\n");
+        }
+        steps++;
+    }
+    fclose(fp);
+    if (out != NULL) fclose(out);
+
+    double wall_s = std::chrono::duration<double>(Clock::now() - wall_start).count();
+    double log_s = (last_ns - first_ns) * 1e-9;
+    latency_us->snapshot(*snap);
+
+    std::cout << "\nReplayed " << steps << " policy steps from " << records << " records\n";
+    printf("Log duration %.2f s, wall time %.2f s, %.1fx real time\n", log_s, wall_s, wall_s > 0 ? log_s / wall_s : 0.0);
+    printf("handleMessage latency (us): p50 %u, p99 %u, p99.9 %u, max %u, mean %.1f\n",
+           latency_hist_quantile(*snap, 0.5), latency_hist_quantile(*snap, 0.99),
+           latency_hist_quantile(*snap, 0.999), latency_hist_max(*snap), latency_hist_mean(*snap));
+    printf("Action vs recorded: max diff %.6f rad, mean step max diff %.6f rad over %ld steps\n",
+           max_diff, compared > 0 ? sum_diff / compared : 0.0, compared);
+    return 0;
+}
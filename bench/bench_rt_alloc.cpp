@@ -0,0 +1,128 @@
+/**
+ * 实时路径内存分配检查
+ * 以RT_ALLOC_TRACE编译(替换malloc等分配函数)。用MotorEmulator代替实机，由执行器启动4个未修改的
+ * channel_thread()和一个按algorithm_control_thread()方式读写关节总线、填写遥测记录的1khz控制线程，
+ * 热身RT_ALLOC_WARMUP_CYCLES个周期后开始计数，结束时输出每个线程的分配次数和热身后的缺页次数。
+ * leak模式下控制线程每100个周期构建一次std::vector观测(改动前handleMessage()的做法)，用于确认能被发现
+ *
+ * 用法: bench_rt_alloc [秒数] [clean|leak] [lock|nolock]
+ * clean模式下任何实时线程出现分配时返回1
+ */
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "motor_emulator.hpp"
+#include "motor_control.hpp"
+#include "joint_bus.hpp"
+#include "telemetry.hpp"
+#include "periodic_loop.hpp"
+#include "rt_executor.hpp"
+#include "rt_memory.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static std::atomic<long> g_probe_faults(0);
+
+// 与algorithm_control_thread()相同的逐周期操作
+static void control_probe(bool leak) {
+    PeriodicLoop loop("control_probe", std::chrono::milliseconds(1), OverrunPolicy::SKIP);
+    uint32_t warmup = RT_ALLOC_WARMUP_CYCLES;
+    long faults_at_arm = 0;
+    long n = 0;
+    float sink = 0;
+    while (g_running) {
+        if (warmup > 0 && --warmup == 0) {
+            rt_alloc_guard_arm("control_probe");
+            struct rusage ru;
+            getrusage(RUSAGE_THREAD, &ru);
+            faults_at_arm = ru.ru_minflt + ru.ru_majflt;
+        }
+
+        JointBusState_t state;
+        joint_bus_read_state(state);
+        JointBusCommand_t cmd = {};
+        for (int k = 0; k < NUM_JOINTS; ++k) cmd.tor[k] = 0.01f * state.pos[k];
+        joint_bus_publish(cmd);
+
+        if (leak && ++n % 100 == 0) {
+            std::vector<float> obs;
+            for (int k = 0; k < 45; ++k) obs.push_back((float)k);
+            sink += obs[n % 45];
+        }
+
+        if (TelemetryRecord_t* rec = telemetry_begin()) {
+            memset(rec, 0, sizeof(*rec));
+            for (int m = 0; m < NUM_JOINTS; ++m) {
+                rec->pos[m] = state.pos[joint_motor_to_net(m)];
+                rec->tor_cmd[m] = cmd.tor[joint_motor_to_net(m)];
+            }
+            rec->joint_oldest_ns = state.oldest_ns;
+            rec->action[0] = sink;
+            telemetry_commit(rec);
+        }
+        loop.wait();
+    }
+    struct rusage ru;
+    getrusage(RUSAGE_THREAD, &ru);
+    g_probe_faults.store(ru.ru_minflt + ru.ru_majflt - faults_at_arm);
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 5.0;
+    bool leak = argc > 2 && strcmp(argv[2], "leak") == 0;
+    bool lock = !(argc > 3 && strcmp(argv[3], "nolock") == 0);
+
+    if (!rt_alloc_trace_enabled()) {
+        std::cerr << "Built without RT_ALLOC_TRACE" << std::endl;
+        return 1;
+    }
+
+    char link_dir[] = "/tmp/robot_dog_emu_XXXXXX";
+    if (mkdtemp(link_dir) == NULL) {
+        std::cerr << "Failed to create temp dir" << std::endl;
+        return 1;
+    }
+    MotorEmulator emulator;
+    emulator.setAllMotorConfig({100, 20, 0.0f, 0.0f, 0});
+    if (!emulator.start(link_dir)) {
+        return 1;
+    }
+    g_motor_port_prefix = emulator.getPortPrefix();
+
+    if (lock) rt_memory_lock(RT_HEAP_PREFAULT / 4);
+    telemetry_start("/tmp/bench_rt_alloc.bin");
+
+    // 无特权时使用普通调度，不影响分配检查
+    static const char* channel_names[NUM_CHANNELS] = {"channel0", "channel1", "channel2", "channel3"};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        RtTaskSpec_t spec = {channel_names[i], 1000, 0, 0, 0, RT_STACK_PREFAULT, 0, OverrunPolicy::SKIP};
+        threads.push_back(rt_spawn(spec, [i]() { channel_thread(i); }));
+    }
+    RtTaskSpec_t probe_spec = {"control_probe", 1000, 0, 0, 0, RT_STACK_PREFAULT, 0, OverrunPolicy::SKIP};
+    threads.push_back(rt_spawn(probe_spec, [leak]() { control_probe(leak); }));
+    print_rt_task_report();
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    g_running = false;
+    for (auto& t : threads) t.join();
+    telemetry_stop();
+    emulator.stop();
+
+    std::cout << "\n" << (leak ? "Leak" : "Clean") << " run, " << seconds << " s, memory "
+              << (lock ? "locked" : "not locked") << ", checking after " << RT_ALLOC_WARMUP_CYCLES << " cycles\n\n";
+    print_periodic_loop_statistics();
+    print_rt_alloc_statistics();
+    uint64_t fresh = rt_alloc_check();
+    std::cout << "control_probe page faults after warm-up: " << g_probe_faults.load() << "\n";
+
+    bool ok = leak ? fresh > 0 : fresh == 0;
+    std::cout << (ok ? "OK" : "UNEXPECTED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+/**
+ * 串口收发路径基准测试
+ * 对比旧收发路径(每条命令tcflush + 1ms select轮询，VMIN=0)与新路径(VMIN=整帧长度 + ppoll，
+ * 只在超时后清空缓冲区)，输出每条命令的系统调用数、唤醒次数、往返时延和唤醒延时。
+ * 唤醒延时 = 线程因数据到达被唤醒的时刻 - 仿真器写出应答最后一段的时刻
+ *
+ * 用法: bench_serial_io [命令数] [应答延时us] [拆帧间隔us]
+ */
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include "motor_emulator.hpp"
+#include "motor_control.hpp"
+#include "serial_init.hpp"
+#include "protocol_codec.hpp"
+#include "rt_util.hpp"
+#include "bench_stats.hpp"
+
+/**
+ * 旧收发路径的复刻（加入统计），用作对照
+ */
+static bool legacy_send_command_and_wait(int fd, Motor::ControlData_t& cmd, Motor::RecvData_t& response,
+                                         int motor_id, SerialIoStats_t& st) {
+    st.commands++;
+    tcflush(fd, TCIFLUSH);
+    st.syscalls++;
+
+    ssize_t bytes_written = write(fd, &cmd, sizeof(Motor::ControlData_t));
+    st.syscalls++;
+    if (bytes_written != sizeof(Motor::ControlData_t)) return false;
+
+    auto start_time = std::chrono::steady_clock::now();
+    uint8_t recv_buffer[MAX_BUFFER_SIZE];
+    while (std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start_time).count() < COMM_TIMEOUT_MS) {
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        FD_SET(fd, &readfds);
+        struct timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 1000;
+
+        int ready = select(fd + 1, &readfds, NULL, NULL, &timeout);
+        st.syscalls++;
+        if (ready > 0 && FD_ISSET(fd, &readfds)) {
+            st.wakeups++;
+            st.last_wake_ns = steady_ns();
+            ssize_t bytes_read = read(fd, recv_buffer, MAX_BUFFER_SIZE);
+            st.syscalls++;
+            if (bytes_read >= (ssize_t)sizeof(Motor::RecvData_t)) {
+                Motor::RecvData_t* recv_packet = reinterpret_cast<Motor::RecvData_t*>(recv_buffer);
+                if (recv_packet->head[0] == 0xFD && recv_packet->head[1] == 0xEE) {
+                    uint16_t calculated_crc = crc_ccitt(MOTOR_CRC_INIT,
+                        reinterpret_cast<uint8_t*>(recv_packet), sizeof(Motor::RecvData_t) - 2);
+                    if (calculated_crc == recv_packet->CRC16 && recv_packet->mode.id == motor_id) {
+                        response = *recv_packet;
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * 在通道A上连续发送count条命令，统计每条命令的开销
+ */
+static void run(const char* name, bool legacy, int count, MotorEmulator& emulator) {
+    char port_name[128];
+    snprintf(port_name, sizeof(port_name), "%sA", g_motor_port_prefix);
+    int fd = initialize_serial_port(port_name);
+    if (fd < 0) return;
+
+    if (legacy) {
+        // 恢复旧的串口配置：VMIN=0，VTIME=1秒
+        struct termios tty;
+        tcgetattr(fd, &tty);
+        tty.c_cc[VMIN] = 0;
+        tty.c_cc[VTIME] = 10;
+        tcsetattr(fd, TCSANOW, &tty);
+    }
+    fcntl(fd, F_SETFL, 0);
+
+    MotorFrameParser parser;
+    SerialIoStats_t st = {0, 0, 0, 0};
+    std::vector<double> rtt_us, wake_us;
+    int failures = 0;
+
+    auto next_send_time = std::chrono::steady_clock::now();
+    for (int n = 0; n < count; ++n) {
+        int motor = n % MOTORS_PER_CHANNEL;
+        if (motor == 0) {
+            next_send_time += std::chrono::milliseconds(1);
+            std::this_thread::sleep_until(next_send_time);
+        }
+        Motor::ControlData_t cmd = g_motors[0][motor].createControlPacket(motor);
+        Motor::RecvData_t response;
+
+        int64_t t0 = steady_ns();
+        bool ok = legacy ? legacy_send_command_and_wait(fd, cmd, response, motor, st)
+                         : send_command_and_wait(fd, cmd, response, motor, parser, &st);
+        int64_t t1 = steady_ns();
+        if (!ok) {
+            failures++;
+            continue;
+        }
+        rtt_us.push_back((t1 - t0) / 1000.0);
+        int64_t reply_ns = emulator.getLastReplyTime(0);
+        if (st.last_wake_ns >= reply_ns) {
+            wake_us.push_back((st.last_wake_ns - reply_ns) / 1000.0);
+        }
+    }
+    close(fd);
+
+    std::sort(rtt_us.begin(), rtt_us.end());
+    std::sort(wake_us.begin(), wake_us.end());
+    printf("%-7s | %8.2f | %8.2f | %6.1f | %6.1f | %6.1f | %6.1f | %6.1f | %4d\n",
+           name, (double)st.syscalls / st.commands, (double)st.wakeups / st.commands,
+           percentile(rtt_us, 50), percentile(rtt_us, 99), percentile(rtt_us, 99.9),
+           percentile(wake_us, 50), percentile(wake_us, 99), failures);
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 6000;
+    uint32_t latency_us = argc > 2 ? (uint32_t)atoi(argv[2]) : 100;
+    uint32_t split_gap_us = argc > 3 ? (uint32_t)atoi(argv[3]) : 0;
+
+    char link_dir[] = "/tmp/robot_dog_emu_XXXXXX";
+    if (mkdtemp(link_dir) == NULL) {
+        std::cerr << "Failed to create temp dir" << std::endl;
+        return 1;
+    }
+    MotorEmulator emulator;
+    emulator.setAllMotorConfig({latency_us, 0, 0.0f, 0.0f, split_gap_us});
+    if (!emulator.start(link_dir)) {
+        return 1;
+    }
+    g_motor_port_prefix = emulator.getPortPrefix();
+
+    std::cout << count << " commands, reply latency " << latency_us << " us, split gap " << split_gap_us << " us\n\n";
+    std::cout << "Path    | Sys/cmd  | Wake/cmd | RTT50  | RTT99  | RTT999 | Wake50 | Wake99 | Fail\n";
+    std::cout << "--------|----------|----------|--------|--------|--------|--------|--------|-----\n";
+    run("legacy", true, count, emulator);
+    run("vmin", false, count, emulator);
+
+    emulator.stop();
+    rmdir(link_dir);
+    return 0;
+}
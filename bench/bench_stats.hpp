@@ -0,0 +1,19 @@
+#ifndef BENCH_STATS_HPP
+#define BENCH_STATS_HPP
+
+#include <vector>
+#include <algorithm>
+
+/**
+ * 基准测试共用的样本统计
+ */
+
+// 从已排序样本中取百分位(p为0~100)，没有样本时返回0
+template <typename T>
+static inline double percentile(const std::vector<T>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t idx = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return (double)sorted[std::min(idx, sorted.size() - 1)];
+}
+
+#endif // BENCH_STATS_HPP
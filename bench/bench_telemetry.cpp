@@ -0,0 +1,117 @@
+/**
+ * 遥测记录基准测试
+ * 生产者线程按1khz(或不限速)填写与algorithm_control_thread()相同的记录，
+ * 测量每条记录telemetry_begin()+填写+telemetry_commit()的耗时分布；结束后读回文件，
+ * 检查文件头、记录数和序号连续性(序号缺口即丢弃的记录)
+ *
+ * 用法: bench_telemetry [秒数] [paced|burst] [输出文件]
+ */
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "telemetry.hpp"
+#include "latency_histogram.hpp"
+#include "periodic_loop.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static void fill_record(TelemetryRecord_t* rec, uint32_t n) {
+    for (int m = 0; m < NUM_JOINTS; ++m) {
+        rec->pos[m] = 0.001f * n + m;
+        rec->spd[m] = -0.5f * m;
+        rec->tor[m] = 0.1f * m;
+        rec->tor_cmd[m] = 0.2f * m;
+        rec->action[m] = 0.3f * m;
+        rec->target[m] = 0.3f * m;
+    }
+    rec->cmd[0] = rec->cmd[1] = rec->cmd[2] = 0;
+    rec->imu_age_us = 0;
+    rec->policy_seq = n / 20;
+    rec->policy_age_us = 0;
+    rec->joint_oldest_ns = 0;
+    rec->flags = TELEMETRY_FLAG_TORQUE_PUBLISHED;
+    rec->rl_start = 10;
+    rec->rl_protect = 0;
+    memset(&rec->imu, 0, sizeof(rec->imu));
+    rec->imu.Timestamp = n;
+    memset(&rec->imu_vel, 0, sizeof(rec->imu_vel));
+    memset(&rec->imu_acc, 0, sizeof(rec->imu_acc));
+}
+
+// 读回文件，返回记录数，并统计序号缺口(包括最后一条记录之后被丢弃的)
+static long verify_file(const char* path, uint64_t total, uint64_t& gaps) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) return -1;
+    TelemetryFileHeader_t header;
+    if (fread(&header, sizeof(header), 1, fp) != 1 || memcmp(header.magic, TELEMETRY_MAGIC, sizeof(TELEMETRY_MAGIC)) != 0 ||
+        header.record_size != sizeof(TelemetryRecord_t)) {
+        fclose(fp);
+        return -1;
+    }
+    TelemetryRecord_t rec;
+    long count = 0;
+    uint32_t expect = 0;
+    gaps = 0;
+    while (fread(&rec, sizeof(rec), 1, fp) == 1) {
+        if (rec.seq != expect) gaps += rec.seq - expect;
+        expect = rec.seq + 1;
+        count++;
+    }
+    gaps += total - expect;
+    fclose(fp);
+    return count;
+}
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 5.0;
+    bool paced = !(argc > 2 && strcmp(argv[2], "burst") == 0);
+    const char* path = argc > 3 ? argv[3] : "/tmp/bench_telemetry.bin";
+
+    if (!telemetry_start(path)) return 1;
+
+    // 耗时以纳秒记入直方图
+    std::unique_ptr<LatencyHistogram> cost_ns(new LatencyHistogram);
+    std::unique_ptr<LatencyHistSnapshot_t> snap(new LatencyHistSnapshot_t);
+    uint64_t attempts = 0;
+
+    std::thread producer([&]() {
+        PeriodicLoop loop("telemetry_producer", std::chrono::milliseconds(1), OverrunPolicy::SKIP);
+        auto end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        while (Clock::now() < end) {
+            auto t0 = Clock::now();
+            if (TelemetryRecord_t* rec = telemetry_begin()) {
+                fill_record(rec, (uint32_t)attempts);
+                telemetry_commit(rec);
+            }
+            auto t1 = Clock::now();
+            cost_ns->record((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+            attempts++;
+            if (paced) loop.wait();
+        }
+    });
+    producer.join();
+    telemetry_stop();
+
+    cost_ns->snapshot(*snap);
+    TelemetryStats_t st = get_telemetry_stats();
+    uint64_t gaps = 0;
+    long in_file = verify_file(path, attempts, gaps);
+
+    std::cout << (paced ? "Paced 1 kHz" : "Burst") << " producer, " << attempts << " records, "
+              << sizeof(TelemetryRecord_t) << " bytes/record\n";
+    std::cout << "Cost per record (ns): p50 " << latency_hist_quantile(*snap, 0.5)
+              << ", p99 " << latency_hist_quantile(*snap, 0.99)
+              << ", p99.9 " << latency_hist_quantile(*snap, 0.999)
+              << ", max " << latency_hist_max(*snap)
+              << ", mean " << latency_hist_mean(*snap) << "\n\n";
+    print_telemetry_statistics();
+    std::cout << "File: " << in_file << " records, " << gaps << " sequence gaps\n";
+
+    bool ok = in_file == (long)st.written && gaps == st.dropped && st.written == st.recorded;
+    std::cout << (ok ? "OK" : "MISMATCH") << std::endl;
+    return ok ? 0 : 1;
+}
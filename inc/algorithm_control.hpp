@@ -6,7 +6,10 @@
 #include <stdio.h>
 #include <torch/torch.h>
 #include <torch/script.h> 
+#include <torch/csrc/jit/runtime/static/impl.h>
 #include "motor.hpp"
+#include "policy_mlp.hpp"
+#include "policy_pipeline.hpp"
 #include "common.hpp"
 #include "motor_control.hpp"
 #include "motor_protect.hpp"
@@ -23,11 +26,34 @@ void rl_run();
 void keyboard_thread();
 
 
+/**
+ * CPU推理方式，CUDA时始终为fp16解释执行
+ */
+enum PolicyCpuMode {
+    POLICY_CPU_HALF = 0,  // fp16，TorchScript解释执行(原做法，x86上没有fp16运算单元，最慢)
+    POLICY_CPU_JIT,       // fp32，TorchScript解释执行
+    POLICY_CPU_FROZEN,    // fp32，torch::jit::freeze + optimize_for_inference
+    POLICY_CPU_STATIC,    // fp32，冻结后由Static Runtime(torch::jit::StaticModule)执行
+    POLICY_CPU_NATIVE,    // fp32，权重提取到PolicyMlp，推理不经过LibTorch
+};
+
 class RL_ROTDOG {
 public:
-    std::string model_path;
+    std::string model_path;   // 为空时init_policy()使用默认模型路径
+    // 扁平权重文件，存在且校验通过时init_policy()直接映射并以原生执行器推理，不加载TorchScript。
+    // 为空时：model_path也为空(机器人上运行)则使用默认路径，否则只从model_path加载
+    std::string flat_path;
+    bool use_cuda = true;     // false时即使有GPU也在CPU上推理
+    PolicyCpuMode cpu_mode = POLICY_CPU_FROZEN;
+    int cpu_threads = POLICY_CPU_THREADS;   // CPU推理的intra-op线程数
+    int warmup_iters = POLICY_WARMUP_ITERS; // init_policy()结束前的热身推理次数
     void init_policy();
     void load_policy();
+    bool map_flat();               // 映射flat_path，成功时切换到CPU原生执行器
+    void warm_up();
+    bool load_native();            // 从model提取网络结构和权重到native，结构不支持时返回false
+    bool native_active() const { return device == torch::kCPU && cpu_mode == POLICY_CPU_NATIVE; }
+    torch::Tensor forward_step();  // 以当前obs_in和历史执行一次网络，不更新历史
     void handleMessage();
     float pd_control(float target_q, float curr_q, float target_qd, float curr_qd);
 
@@ -42,13 +68,35 @@ public:
     float cmd_y = 0.;
     float cmd_rate = 0.;
 
-    std::vector<float> action;
+    std::vector<float> action;     // 本次策略输出的关节目标，由推理线程写；控制线程经policy_action_publish()取用
+    // 控制线程在两次策略输出之间的目标曲线和过渡时长，algorithm_control_thread()启动时读取
+    PolicyActionProfile action_profile = (PolicyActionProfile)POLICY_ACTION_PROFILE;
+    int interp_ms = POLICY_INTERP_MS;
+    // 推理看门狗：每步的预算、错过时的目标、衰减时间常数和触发保护的连续错过步数
+    int deadline_ms = POLICY_DEADLINE_MS;
+    PolicyFallback fallback = (PolicyFallback)POLICY_FALLBACK;
+    int decay_ms = POLICY_DECAY_MS;
+    uint32_t max_misses = POLICY_MAX_MISSES;
     std::vector<float> action_temp;
     std::vector<float> prev_action;
 
-    torch::Tensor action_buf;
-    torch::Tensor obs_buf;
-    torch::Tensor last_action;
+    // 推理用的张量和视图都在init_policy()中创建，handleMessage()只原地写入，不再分配
+    float* obs = nullptr;          // 本周期的观测，指向obs_cpu的存储，45个float一次写完
+    torch::Tensor obs_cpu;         // {1,45} float32，CUDA时为锁页内存
+    torch::Tensor obs_stage;       // {1,45} float32，位于device；CPU时与obs_cpu相同
+    torch::Tensor obs_in;          // {1,45} 网络输入，位于device；CPU fp32时与obs_cpu相同
+    /**
+     * 历史观测环形缓冲，{2*history_length,45}：每行同时写入head和head+history_length两处，
+     * 于是narrow(0, head, history_length)总是连续且按时间顺序排列，模型直接读取，不需要移位
+     */
+    torch::Tensor obs_ring;
+    torch::Tensor action_ring;     // {2*history_length,12} 历史动作，写法同obs_ring
+    int ring_head = 0;             // 最旧一行的下标，范围[0, history_length)
+    std::vector<torch::Tensor> obs_ring_rows, action_ring_rows;  // 每行的视图，共2*history_length个
+    std::vector<std::vector<torch::jit::IValue>> ring_inputs;    // 每个head对应的网络输入{obs_in, 历史视图}
+    torch::Tensor action_stage;    // {1,12} float32，位于device；CPU时与action_cpu相同
+    torch::Tensor action_cpu;      // {1,12} float32，网络输出拷回CPU，CUDA时为锁页内存
+    float last_action[12];         // 上一次的网络输出，用于输出滤波
 
     // default values
     int action_refresh=0;
@@ -71,7 +119,11 @@ public:
     float output_tor[12];
     float new_target = 0.0;
     torch::jit::script::Module model;
+    std::unique_ptr<torch::jit::StaticModule> static_model;  // POLICY_CPU_STATIC时使用
+    PolicyMlp native;              // POLICY_CPU_NATIVE时使用
+    torch::Tensor action_native;   // {1,12} float32，native的输出
     torch::DeviceType device;
+    torch::ScalarType dtype;       // 网络参数和输入的类型，load_policy()中确定
 private:
 
    
@@ -80,4 +132,5 @@ private:
 
 // 全局变量
 extern int rl_start; // RL控制开始标志
+extern RL_ROTDOG rl_rotdog;
 #endif // ALGORITHM_CONTROL_HPP
\ No newline at end of file
@@ -4,9 +4,55 @@
 // 定义系统常量
 #define NUM_CHANNELS 4         // 通道数量
 #define MOTORS_PER_CHANNEL 3   // 每个通道的电机数量
+#define NUM_JOINTS (NUM_CHANNELS * MOTORS_PER_CHANNEL)  // 关节总数
 #define MAX_BUFFER_SIZE 1024   // 最大缓冲区大小
 #define GEAR_RATIO 6.33f       // 减速比
+#define KNEE_RATIO 1.88f       // 膝关节连杆的额外减速比
 #define MAX_RETRY_COUNT 3      // 最大重试次数
 #define COMM_TIMEOUT_MS 5    // 通信超时时间(毫秒)
+#define RESYNC_POLL_US 200     // 解析器中有半帧时等待剩余字节的最长时间(微秒)
+#define RTT_BUCKET_US 20       // 往返时延估计的桶宽(微秒)
+#define RTT_MIN_SAMPLES 16     // 样本数达到后才用估计值代替COMM_TIMEOUT_MS
+#define RTT_TIMEOUT_MIN_US 300 // 估计超时的下限(微秒)
+#define RTT_TIMEOUT_MARGIN_US 100 // 估计超时 = 2 * RTT p99 + 余量(微秒)
+#define REACTOR_TICK_US 1000   // 反应器节拍周期(微秒)，单次应答等待不超过一个节拍
+#define METRICS_REPORT_PERIOD_MS 5000 // 总线时延统计的报告周期(毫秒)
+#define TELEMETRY_RING_SIZE 4096  // 遥测队列容量(条)，1khz下可容纳约4秒的写盘停顿，必须是2的幂
+#define TELEMETRY_WRITE_BATCH 256 // 写盘线程每次写入的最多记录数
+#define TELEMETRY_FLUSH_MS 20     // 队列为空时写盘线程的等待时间(毫秒)
+#define RT_PRIO_BUS 90            // 通道线程/反应器的SCHED_FIFO优先级，总线收发最先得到CPU
+#define RT_PRIO_IMU 87            // IMU读取线程的优先级，高于控制线程，帧到达后立即解析发布
+#define RT_PRIO_CONTROL 85        // 1khz算法控制线程的优先级
+#define RT_PRIO_POLICY 80         // 50hz策略推理线程的优先级，与控制线程同核时可被其抢占
+#define RT_STACK_PREFAULT (256 * 1024) // 实时线程启动时预先写入的栈大小(字节)
+#define RT_CONTROL_SPIN_US 50     // 控制线程唤醒前自旋的时间(微秒)，核心1上只有它和策略线程，自旋只占用策略线程的时间
+#define RT_LOCK_MEMORY 1          // 1: 启动实时线程前锁定内存并预分配堆(rt_memory_lock)
+#define RT_HEAP_PREFAULT (64 * 1024 * 1024) // 启动时预先写入的堆大小(字节)
+#define RT_ALLOC_WARMUP_CYCLES 1000 // 实时线程运行这么多个周期后开始检查内存分配
+#define IMU_BAUD_RATE 921600      // IMU串口波特率，每字节10位，用于计算总线占用
+#define IMU_MAX_OUTPUTS 16        // 输出配置命令中最多的数据包个数
+#define IMU_CONFIGURE_OUTPUTS 0   // 1: 启动时发送输出配置命令(IMU::configure_outputs)。命令类别和负载布局尚未与FDILink手册核对，
+                                  // 默认不发送，设备保持原来的推送频率和数据包
+#define IMU_OUTPUT_RATE_HZ 500    // 启动时配置的IMU推送频率，0x41/0x60/0x62一组100字节，约占总线54%
+#define IMU_BUS_BUDGET 0.8        // 配置的推送占总线的比例超过该值时拒绝配置
+#define IMU_ACK_TIMEOUT_MS 200    // 等待配置命令应答的时间(毫秒)
+#define IMU_CONFIG_RETRIES 3      // 配置命令的最多发送次数
+#define IMU_BUS_MEASURE_MS 500    // 配置前后测量总线占用的时间(毫秒)
+#define IMU_CLOCK_WINDOW_MS 1000  // 设备时钟映射的估计窗口(设备时间，毫秒)，每个窗口取时延最小的一帧
+#define IMU_CLOCK_JUMP_MS 50      // 偏移与估计相差超过该值时认为设备时钟跳变，重新估计
+#define IMU_CLOCK_SKEW_GAIN 0.25  // 漂移估计的平滑系数
+#define IMU_RATE_DOT_ALPHA 0.2f   // 角加速度估计的低通系数，差分放大噪声，取值宜小
+#define IMU_EXTRAP_MAX_US 10000   // 外推的最长时间(微秒)，更旧的样本只外推这么长
+#define POLICY_CPU_THREADS 1      // CPU推理的intra-op线程数，批大小为1的小网络多线程只增加同步开销
+#define POLICY_WARMUP_ITERS 20    // 加载后用全零输入执行的热身推理次数(覆盖每个历史起点)
+#define POLICY_ACTION_PROFILE 0   // 1khz控制在两次策略输出之间的目标：0保持 1线性过渡 2平滑过渡(PolicyActionProfile)
+#define POLICY_INTERP_MS 20       // 线性/平滑过渡的时长(毫秒)，取策略周期时下一次输出到达时恰好过渡完
+#define POLICY_PERIOD_MS 20       // 策略周期(毫秒)，50hz
+#define POLICY_DEADLINE_MS 20     // 每步从观测到推理完成的预算(毫秒)，超过时丢弃该步
+#define POLICY_FALLBACK 1         // 策略步错过时的目标：0保持最后的好动作 1衰减到站立姿态(PolicyFallback)
+#define POLICY_DECAY_MS 200       // 衰减的时间常数(毫秒)
+#define POLICY_MAX_MISSES 5       // 连续错过的策略步数达到该值时触发保护，0为不触发
+#define POLICY_MODEL_PATH "/home/zhu/Desktop/ROBOT_DOG/pre_train/model_jitt.pt"      // TorchScript模型
+#define POLICY_FLAT_PATH "/home/zhu/Desktop/ROBOT_DOG/pre_train/model_jitt.policy"   // policy_export导出的扁平权重
 
 #endif
\ No newline at end of file
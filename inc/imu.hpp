@@ -2,10 +2,15 @@
 #define    IMU_HPP
 
 #include <stdint.h>
-#include <map>
 #include <vector>
+#include "seqlock.hpp"
+#include "common.hpp"
+#include "imu_clock.hpp"
 
-#define LINE(arg...) arg
+// FDILink命令帧的类别，命令与应答的负载见IMU::ImuOutputCmd_t、IMU::ImuAck_t
+// 类别和负载布局尚未与设备手册核对(与仿真器一致)，实机上只在IMU_CONFIGURE_OUTPUTS为1时发送
+#define FDILINK_CMD_OUTPUT 0xA0  // 设置推送的数据包和频率
+#define FDILINK_CMD_ACK    0xA1  // 设备对命令的应答
 
 class IMU {
 public:
@@ -65,20 +70,68 @@ public:
 		float G_force;              // 重力加速度
 	} __attribute__((packed)) IMUData_MSG_BODY_ACCELERATION;
 
+	/**
+	 * @brief 输出配置命令(类别FDILINK_CMD_OUTPUT)
+	 * 设备只推送ids中的数据包，每种都以rate_hz推送，数据长度为3+count
+	 */
+	typedef struct {
+		uint16_t rate_hz;                // 推送频率
+		uint8_t count;                   // 数据包个数
+		uint8_t ids[IMU_MAX_OUTPUTS];    // 数据包类别
+	} __attribute__((packed)) ImuOutputCmd_t;
+
+	/**
+	 * @brief 命令应答(类别FDILINK_CMD_ACK)
+	 */
+	typedef struct {
+		uint8_t cmd_type;  // 被应答命令的类别
+		uint8_t cmd_seq;   // 被应答命令的帧计数
+		uint8_t status;    // 0表示已执行，其他为错误码
+	} __attribute__((packed)) ImuAck_t;
+
 	//后续可以添加更多的IMU数据结构体
 
     #pragma pack()  // 恢复默认的内存对齐
 
+    /**
+     * @brief 最新的IMU数据及其接收时刻
+     * 由IMU读取线程发布，控制线程无锁读取
+     */
+    typedef struct {
+        IMUData_t data;                          // 0x41
+        IMUData_MSG_BODY_VEL body_vel;           // 0x60
+        IMUData_MSG_BODY_ACCELERATION body_acc;  // 0x62
+        int64_t stamp_ns;      // 最近一帧0x41解析完成的steady_clock时刻(纳秒)，0表示尚未收到
+        int64_t vel_stamp_ns;  // 最近一帧0x60解析完成的时刻
+        int64_t acc_stamp_ns;  // 最近一帧0x62解析完成的时刻
+        int64_t sample_ns;     // 0x41的Timestamp映射到steady_clock的采样时刻(纳秒)
+        float rate_dot[3];     // 由相邻0x41估计并低通滤波的角加速度(rad/s^2)，顺序同RollSpeed等
+        uint32_t seq;          // 已收到的0x41帧数，变化表示有新的姿态数据
+    } ImuSample_t;
+
     //构造函数
     IMU();
     //初始化串口
     void serial_init(const char* port_name); 
     //配置串口参数，提高稳定性
     bool configure_imu_serial(int fd);
-    //获取IMU数据包
-    bool get_imu_packet(const std::vector<uint8_t>& id_list); 
+    //逐字节解析FDILink帧，收到一帧校验正确的完整帧时返回其类别，数据在frame_payload()中，否则返回-1
+    int parse_byte(uint8_t byte);
+    //最近一帧的数据段和长度，在parse_byte()返回类别后、解析下一个字节前有效
+    const uint8_t* frame_payload() const { return FDILink_Status.Buffer; }
+    int frame_length() const { return FDILink_Status.FDILink_Frame_Buffer[2]; }
+    //IMU读取线程的主循环：读取串口、逐字节解析，每批数据解析完后发布最新数据，运行到g_running变为false
+    void run_reader();
+    //读取最新的IMU数据，可在任意线程调用，无锁；尚未收到0x41数据时返回false
+    bool read_latest(ImuSample_t& out) const;
     //构建IMU请求数据包，返回帧长度
     int create_imu_packet(uint8_t* buffer, FDILink_Status_t* FDILink, uint8_t type, void* buf, int len);
+    /**
+     * 启动时配置设备推送：测量当前总线占用，发送输出配置命令使设备只以rate_hz推送ids中的数据包，
+     * 等待应答(超时重发)，再测量一次并核对实际推送的类别和频率。在启动读取线程之前调用，
+     * 应答正确且核对通过时返回true，失败时设备保持原来的配置
+     */
+    bool configure_outputs(const uint8_t* ids, int count, uint16_t rate_hz);
 
 	IMUData_t imu_data; // 存储IMU数据的成员变量
 	IMUData_MSG_BODY_VEL imu_body_vel; // 存储IMU角加速度数据的成员变量
@@ -87,115 +140,57 @@ public:
 	// 获取FDILink状态
 	FDILink_Status_t getFDILinkStatus() const { return FDILink_Status; }
 private:
-    FDILink_Status_t FDILink_Status; // 存储FDILink状态的成员变量
+    // 帧头校验失败时，把已收到的帧头字节(除第一个0xFC)重新送入解析器，寻找其中的下一个帧头
+    void resync(int header_bytes);
+    // 按类别把一帧数据拷入rx_sample，返回是否是需要的数据
+    bool apply_frame(int type, int64_t stamp_ns);
+    // 在duration_ms内读取并解析串口数据，按类别统计帧数；wait_ack>=0时收到帧计数为wait_ack的应答即返回
+    int measure_bus(int duration_ms, uint32_t* frames, uint64_t& bytes, int wait_ack = -1);
+
+    FDILink_Status_t FDILink_Status; // 存储FDILink状态的成员变量，由解析器使用
     int imu_fd;
+    ImuSample_t rx_sample;           // 读取线程正在组装的数据，只由读取线程访问
+    ImuClockMap clock_map;           // 设备时钟映射，只由读取线程访问
+    SeqLock<ImuSample_t> latest;     // 最近一次发布的数据
 };
 
+/**
+ * @brief IMU读取线程的统计
+ */
+typedef struct {
+    uint64_t bytes;           // 读到的字节数
+    uint64_t frames_att;      // 0x41帧数
+    uint64_t frames_vel;      // 0x60帧数
+    uint64_t frames_acc;      // 0x62帧数
+    uint64_t frames_other;    // 其他类别或长度不符的帧数
+    uint64_t crc8_errors;     // 帧头CRC8错误
+    uint64_t crc16_errors;    // 数据段CRC16错误
+    uint64_t tail_errors;     // 帧尾错误
+    uint64_t discarded_bytes; // 帧外被丢弃的字节数
+    uint64_t published;       // 发布次数
+} ImuStats_t;
+
+// IMU读取线程函数，使用全局实例imu
+void imu_reader_thread();
+
+/**
+ * 把样本外推到t_ns时刻(steady_clock纳秒)
+ * 角速度按样本中的角加速度线性外推，欧拉角(ZYX)由机体系角速度经欧拉角运动学积分，
+ * 外推时长限制在IMU_EXTRAP_MAX_US以内；四元数和Timestamp保持样本原值
+ * @return 样本年龄 t_ns - sample_ns(纳秒)
+ */
+int64_t imu_extrapolate(const IMU::ImuSample_t& sample, int64_t t_ns, IMU::IMUData_t& out);
+
+// 读取IMU统计，可在任意线程调用
+ImuStats_t get_imu_stats();
+
+// 打印IMU统计
+void print_imu_statistics();
+
 extern IMU imu; // 声明IMU类的全局实例
 
 extern uint64_t imu_tick;
 
-const uint8_t CRC8Table[] ={
-	0,  94, 188, 226, 97, 63, 221, 131,
-	194, 156, 126, 32, 163, 253, 31, 65,
-	157, 195, 33, 127, 252, 162, 64, 30,
-	95, 1, 227, 189, 62, 96, 130, 220,
-	35, 125, 159, 193, 66, 28, 254, 160,
-	225, 191, 93, 3, 128, 222, 60, 98,
-	190, 224, 2, 92, 223, 129, 99, 61,
-	124, 34, 192, 158, 29, 67, 161, 255,
-	70, 24, 250, 164, 39, 121, 155, 197,
-	132, 218, 56, 102, 229, 187, 89, 7,
-	219, 133, 103, 57, 186, 228, 6, 88,
-	25, 71, 165, 251, 120, 38, 196, 154,
-	101, 59, 217, 135, 4, 90, 184, 230,
-	167, 249, 27, 69, 198, 152, 122, 36,
-	248, 166, 68, 26, 153, 199, 37, 123,
-	58, 100, 134, 216, 91, 5, 231, 185,
-	140, 210, 48, 110, 237, 179, 81, 15,
-	78, 16, 242, 172, 47, 113, 147, 205,
-	17, 79, 173, 243, 112, 46, 204, 146,
-	211, 141, 111, 49, 178, 236, 14, 80,
-	175, 241, 19, 77, 206, 144, 114, 44,
-	109, 51, 209, 143, 12, 82, 176, 238,
-	50, 108, 142, 208, 83, 13, 239, 177,
-	240, 174, 76, 18, 145, 207, 45, 115,
-	202, 148, 118, 40, 171, 245, 23, 73,
-	8, 86, 180, 234, 105, 55, 213, 139,
-	87, 9, 235, 181, 54, 104, 138, 212,
-	149, 203, 41, 119, 244, 170, 72, 22,
-	233, 183, 85, 11, 136, 214, 52, 106,
-	43, 117, 151, 201, 74, 20, 246, 168,
-	116, 42, 200, 150, 21, 75, 169, 247,
-	182, 232, 10, 84, 215, 137, 107, 53
-};
-
-const uint16_t CRC16Table[256] =
-{
-	LINE(0x0000, 0x1021, 0x2042, 0x3063),
-	LINE(0x4084, 0x50A5, 0x60C6, 0x70E7),
-	LINE(0x8108, 0x9129, 0xA14A, 0xB16B),
-	LINE(0xC18C, 0xD1AD, 0xE1CE, 0xF1EF),
-	LINE(0x1231, 0x0210, 0x3273, 0x2252),
-	LINE(0x52B5, 0x4294, 0x72F7, 0x62D6),
-	LINE(0x9339, 0x8318, 0xB37B, 0xA35A),
-	LINE(0xD3BD, 0xC39C, 0xF3FF, 0xE3DE),
-	LINE(0x2462, 0x3443, 0x0420, 0x1401),
-	LINE(0x64E6, 0x74C7, 0x44A4, 0x5485),
-	LINE(0xA56A, 0xB54B, 0x8528, 0x9509),
-	LINE(0xE5EE, 0xF5CF, 0xC5AC, 0xD58D),
-	LINE(0x3653, 0x2672, 0x1611, 0x0630),
-	LINE(0x76D7, 0x66F6, 0x5695, 0x46B4),
-	LINE(0xB75B, 0xA77A, 0x9719, 0x8738),
-	LINE(0xF7DF, 0xE7FE, 0xD79D, 0xC7BC),
-	LINE(0x48C4, 0x58E5, 0x6886, 0x78A7),
-	LINE(0x0840, 0x1861, 0x2802, 0x3823),
-	LINE(0xC9CC, 0xD9ED, 0xE98E, 0xF9AF),
-	LINE(0x8948, 0x9969, 0xA90A, 0xB92B),
-	LINE(0x5AF5, 0x4AD4, 0x7AB7, 0x6A96),
-	LINE(0x1A71, 0x0A50, 0x3A33, 0x2A12),
-	LINE(0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E),
-	LINE(0x9B79, 0x8B58, 0xBB3B, 0xAB1A),
-	LINE(0x6CA6, 0x7C87, 0x4CE4, 0x5CC5),
-	LINE(0x2C22, 0x3C03, 0x0C60, 0x1C41),
-	LINE(0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD),
-	LINE(0xAD2A, 0xBD0B, 0x8D68, 0x9D49),
-	LINE(0x7E97, 0x6EB6, 0x5ED5, 0x4EF4),
-	LINE(0x3E13, 0x2E32, 0x1E51, 0x0E70),
-	LINE(0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC),
-	LINE(0xBF1B, 0xAF3A, 0x9F59, 0x8F78),
-	LINE(0x9188, 0x81A9, 0xB1CA, 0xA1EB),
-	LINE(0xD10C, 0xC12D, 0xF14E, 0xE16F),
-	LINE(0x1080, 0x00A1, 0x30C2, 0x20E3),
-	LINE(0x5004, 0x4025, 0x7046, 0x6067),
-	LINE(0x83B9, 0x9398, 0xA3FB, 0xB3DA),
-	LINE(0xC33D, 0xD31C, 0xE37F, 0xF35E),
-	LINE(0x02B1, 0x1290, 0x22F3, 0x32D2),
-	LINE(0x4235, 0x5214, 0x6277, 0x7256),
-	LINE(0xB5EA, 0xA5CB, 0x95A8, 0x8589),
-	LINE(0xF56E, 0xE54F, 0xD52C, 0xC50D),
-	LINE(0x34E2, 0x24C3, 0x14A0, 0x0481),
-	LINE(0x7466, 0x6447, 0x5424, 0x4405),
-	LINE(0xA7DB, 0xB7FA, 0x8799, 0x97B8),
-	LINE(0xE75F, 0xF77E, 0xC71D, 0xD73C),
-	LINE(0x26D3, 0x36F2, 0x0691, 0x16B0),
-	LINE(0x6657, 0x7676, 0x4615, 0x5634),
-	LINE(0xD94C, 0xC96D, 0xF90E, 0xE92F),
-	LINE(0x99C8, 0x89E9, 0xB98A, 0xA9AB),
-	LINE(0x5844, 0x4865, 0x7806, 0x6827),
-	LINE(0x18C0, 0x08E1, 0x3882, 0x28A3),
-	LINE(0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E),
-	LINE(0x8BF9, 0x9BD8, 0xABBB, 0xBB9A),
-	LINE(0x4A75, 0x5A54, 0x6A37, 0x7A16),
-	LINE(0x0AF1, 0x1AD0, 0x2AB3, 0x3A92),
-	LINE(0xFD2E, 0xED0F, 0xDD6C, 0xCD4D),
-	LINE(0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9),
-	LINE(0x7C26, 0x6C07, 0x5C64, 0x4C45),
-	LINE(0x3CA2, 0x2C83, 0x1CE0, 0x0CC1),
-	LINE(0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C),
-	LINE(0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8),
-	LINE(0x6E17, 0x7E36, 0x4E55, 0x5E74),
-	LINE(0x2E93, 0x3EB2, 0x0ED1, 0x1EF0)
-};
+// CRC表与FDILink帧的编解码见protocol_codec.hpp
 
 #endif
\ No newline at end of file
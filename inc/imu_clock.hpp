@@ -0,0 +1,80 @@
+#ifndef IMU_CLOCK_HPP
+#define IMU_CLOCK_HPP
+
+#include <stdint.h>
+#include "latency_histogram.hpp"
+
+/**
+ * IMU时间对齐
+ * 0x41的Timestamp是设备时钟(微秒)，与CLOCK_MONOTONIC之间有未知的偏移和漂移。ImuClockMap由读取线程
+ * 用每帧的(设备时刻, 接收时刻)估计映射：接收时刻 = 采样时刻 + 传输时延，时延只会为正，
+ * 所以每个窗口内时延最小的一帧最接近真实偏移，相邻窗口的最小点之差给出漂移。
+ * 映射后的采样时刻随样本发布(IMU::ImuSample_t::sample_ns)，控制线程和策略线程据此得到样本年龄，
+ * 并用imu_extrapolate()(见imu.hpp)把角速度和姿态外推到控制节拍或观测的时刻
+ */
+
+/**
+ * @brief 设备时钟到CLOCK_MONOTONIC的映射
+ * 只由读取线程访问
+ */
+class ImuClockMap {
+public:
+    ImuClockMap();
+
+    // 清除估计，设备重启或时钟跳变后重新开始
+    void reset();
+
+    /**
+     * 加入一帧，返回该帧采样时刻在CLOCK_MONOTONIC中的估计
+     * @param device_us 帧中的设备时刻
+     * @param rx_ns 解析完成的时刻(steady_clock纳秒)
+     * @param wire_ns 该帧在线路上的传输时间，接收时刻至少比采样时刻晚这么多
+     */
+    int64_t update(int64_t device_us, int64_t rx_ns, int64_t wire_ns);
+
+    // 设备时刻对应的CLOCK_MONOTONIC时刻(纳秒)
+    int64_t to_monotonic(int64_t device_us) const;
+
+private:
+    bool started;
+    int64_t anchor_dev_ns;     // 映射的参考点(设备时刻)
+    int64_t anchor_offset_ns;  // 参考点处的偏移，CLOCK_MONOTONIC - 设备时钟
+    double skew;               // 漂移，每纳秒设备时间偏移的变化量
+    int windows;               // 已结束的窗口数
+    int64_t win_start_dev_ns;  // 当前窗口的起点
+    int64_t win_min_dev_ns;    // 当前窗口中时延最小的一帧
+    int64_t win_min_offset_ns;
+    int64_t prev_min_dev_ns;   // 上一个窗口中时延最小的一帧
+    int64_t prev_min_offset_ns;
+};
+
+// 样本年龄的统计来源，每个来源只有一个写者
+enum ImuAgeSource {
+    IMU_AGE_CONTROL = 0,  // 1khz控制节拍
+    IMU_AGE_POLICY,       // 策略观测
+    IMU_AGE_SOURCES
+};
+
+/**
+ * @brief 设备时钟映射的当前状态
+ */
+typedef struct {
+    int64_t offset_ns;   // 当前的偏移估计，CLOCK_MONOTONIC - 设备时钟
+    double skew_ppm;     // 漂移估计(百万分之一)
+    uint64_t windows;    // 已结束的估计窗口数
+    uint64_t resets;     // 因时钟跳变重新开始的次数
+} ImuClockStats_t;
+
+// 记录一次样本年龄(纳秒)
+void imu_age_record(ImuAgeSource source, int64_t age_ns);
+
+// 读取某个来源的年龄直方图(微秒)，可在任意线程调用
+void get_imu_age_snapshot(ImuAgeSource source, LatencyHistSnapshot_t& out);
+
+// 读取时钟映射状态，可在任意线程调用
+ImuClockStats_t get_imu_clock_stats();
+
+// 打印时钟映射状态和样本年龄分布(自启动以来)
+void print_imu_age_statistics();
+
+#endif // IMU_CLOCK_HPP
@@ -0,0 +1,103 @@
+#ifndef IMU_EMULATOR_HPP
+#define IMU_EMULATOR_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include "imu.hpp"
+
+/**
+ * FDILink IMU仿真器
+ * 用伪终端(PTY)代替/dev/ttyACM0，按设定频率推送0x41、0x60、0x62等帧(与imu.hpp使用同一套CRC表打包)，
+ * 可设置发送抖动、拆段写出和CRC损坏概率，用于在没有IMU的情况下测试IMU::serial_init()和解析器。
+ * 数据为缓慢摆动的合成姿态，Timestamp为设备时钟(微秒)，可设置相对CLOCK_MONOTONIC的偏移和漂移。
+ * 接受输出配置命令(FDILINK_CMD_OUTPUT)，应答后按命令中的类别和频率推送
+ */
+class ImuEmulator {
+public:
+    /**
+     * @brief 推送模型
+     */
+    typedef struct {
+        uint32_t rate_hz;         // 每秒推送的组数，每组依次为已选择的各类帧
+        uint32_t jitter_us;       // 每组发送时刻叠加的均匀随机抖动(微秒)
+        uint32_t split_bytes;     // 每次write()最多写出的字节数，0表示一组一次写出
+        uint32_t split_gap_us;    // 拆段写出时两段之间的间隔(微秒)
+        float corrupt_rate;       // 每帧翻转一个随机比特的概率(0-1)
+        uint32_t baud;            // 模拟的串口波特率(每字节10位)，线路忙于上一组时丢弃本组；0表示不限速
+        int64_t clock_offset_us;  // 设备时钟相对CLOCK_MONOTONIC的偏移(微秒)
+        double clock_drift_ppm;   // 设备时钟的漂移(百万分之一)
+    } ImuConfig_t;
+
+    ImuEmulator();
+    ~ImuEmulator();
+
+    // 创建PTY，并在link_dir下建立ttyIMU符号链接，成功返回true
+    bool start(const char* link_dir);
+
+    // 停止推送线程并关闭PTY
+    void stop();
+
+    // 暂停/恢复推送，暂停期间不写出任何数据(也不计为线路占满)
+    void setPaused(bool p) { paused = p; }
+
+    // 设置推送模型，在start()之前调用
+    void setConfig(const ImuConfig_t& cfg);
+
+    // 设置推送的数据包类别(默认0x41、0x60、0x62)，在start()之前调用；0x41/0x60/0x62以外的类别推送48字节的填充数据
+    void setOutputs(const uint8_t* ids, int count);
+
+    // 获取串口设备名，可直接传给IMU::serial_init()
+    const char* getPortName() const { return port_name.c_str(); }
+
+    // 获取某类帧已推送的帧数(含被损坏的)
+    uint64_t getFrameCount(uint8_t type) const { return frame_count[type].load(); }
+
+    // 获取已执行的输出配置命令数
+    uint64_t getCommandCount() const { return command_count.load(); }
+
+    // 获取被损坏的帧数
+    uint64_t getCorruptCount() const { return corrupt_count.load(); }
+
+    // 获取已写出的字节数
+    uint64_t getByteCount() const { return byte_count.load(); }
+
+    // 获取因线路仍在发送上一组而丢弃的组数
+    uint64_t getOverrunCount() const { return overrun_count.load(); }
+
+    // 设备时钟(微秒)与CLOCK_MONOTONIC纳秒之间的换算
+    int64_t deviceClockUs(int64_t steady_ns) const;
+    int64_t deviceToSteadyNs(int64_t device_us) const;
+
+    // 按时刻生成一组合成数据，也用作外推的真值
+    void sampleAt(int64_t steady_ns, IMU::IMUData_t& att, IMU::IMUData_MSG_BODY_VEL& vel,
+                  IMU::IMUData_MSG_BODY_ACCELERATION& acc) const;
+
+private:
+    // 推送线程
+    void stream_loop();
+
+    // 解析主端收到的命令帧，执行输出配置命令并把应答写入buffer，返回写入的字节数
+    int handle_commands(uint8_t* buffer, uint8_t& seq);
+
+    std::string port_name;
+    int master_fd;
+    int slave_fd;  // 保持从端打开，避免被测程序关闭串口时主端读到EIO
+    ImuConfig_t config;
+    uint8_t output_ids[IMU_MAX_OUTPUTS];   // 推送的数据包类别，只由推送线程访问(start()之后)
+    int output_count;
+    uint8_t rx_buf[512];                   // 主端收到、尚未解析的命令字节
+    int rx_len;
+    std::atomic<uint64_t> frame_count[256];  // 按类别
+    std::atomic<uint64_t> command_count;
+    std::atomic<uint64_t> corrupt_count;
+    std::atomic<uint64_t> byte_count;
+    std::atomic<uint64_t> overrun_count;
+    int64_t start_ns;
+    std::atomic<bool> running;
+    std::atomic<bool> paused;
+    std::thread thread;
+};
+
+#endif // IMU_EMULATOR_HPP
@@ -0,0 +1,60 @@
+#ifndef JOINT_BUS_HPP
+#define JOINT_BUS_HPP
+
+#include <stdint.h>
+#include "common.hpp"
+#include "joint_calibration.hpp"
+
+/**
+ * 关节总线：控制线程与电机通道之间按12个关节整体交换命令和状态
+ *
+ * 电机按通道排列为FR，FL，RR，RL，网络和控制算法按FL，FR，RL，RR排列。
+ * 本接口的命令和状态全部使用网络顺序，腿的重排只在这里做一次。
+ */
+
+// 电机通道(腿)i对应网络顺序中的腿下标
+constexpr int NET_LEG_OF_MOTOR_LEG[NUM_CHANNELS] = {1, 0, 3, 2};
+
+// 电机顺序的关节下标 -> 网络顺序的关节下标
+constexpr int joint_motor_to_net(int motor_joint) {
+    return NET_LEG_OF_MOTOR_LEG[motor_joint / MOTORS_PER_CHANNEL] * MOTORS_PER_CHANNEL +
+           motor_joint % MOTORS_PER_CHANNEL;
+}
+
+// 12个关节的输出端控制参数，按网络顺序
+typedef JointCommand_t JointBusCommand_t;
+
+/**
+ * @brief 12个关节的输出端状态快照，按网络顺序
+ */
+typedef struct {
+    float pos[NUM_JOINTS];   // 位置(rad)
+    float spd[NUM_JOINTS];   // 速度(rad/s)
+    float tor[NUM_JOINTS];   // 转矩(N·m)
+    int64_t stamp_ns;        // 读取快照的时刻(steady_clock纳秒)
+    int64_t oldest_ns;       // 12个反馈中最旧一帧的接收时刻，0表示有电机尚未收到反馈
+} JointBusState_t;
+
+// 发布12个关节的命令，通道线程总是拿到同一次发布的完整命令，可由多个线程调用
+void joint_bus_publish(const JointBusCommand_t& cmd);
+
+// 所有关节使用同一组控制参数
+void joint_bus_publish_uniform(float tor_des, float spd_des, float pos_des, float k_pos, float k_spd);
+
+// 读取12个关节带时间戳的状态快照
+void joint_bus_read_state(JointBusState_t& state);
+
+/**
+ * 离线回放：把一组输出端状态(按电机顺序)换算到转子端后直接写入电机反馈，
+ * 之后joint_bus_read_state()读到的就是这组状态。不能与通道线程同时使用
+ */
+void joint_bus_inject_feedback(const JointState_t& state, int64_t stamp_ns);
+
+/**
+ * 通道线程在每个周期开始时调用，有新发布的命令时写入本通道的电机
+ * @param seen_version 本通道上次应用的命令版本，初始化为0
+ * @return 是否应用了新命令
+ */
+bool joint_bus_apply(int channel, uint32_t& seen_version);
+
+#endif // JOINT_BUS_HPP
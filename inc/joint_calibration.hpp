@@ -0,0 +1,104 @@
+#ifndef JOINT_CALIBRATION_HPP
+#define JOINT_CALIBRATION_HPP
+
+#include <stdint.h>
+#include "common.hpp"
+
+/**
+ * @brief 单个关节的标定参数
+ * 转子端位置 = sign * (输出端位置 + offset) * ratio
+ * 转子端速度 = sign * 输出端速度 * ratio
+ * 转子端转矩 = sign * 输出端转矩 / ratio
+ */
+typedef struct {
+    float sign;    // 转子与输出端的方向关系，+1或-1
+    float offset;  // 零点偏移(弧度)
+    float ratio;   // 总减速比，膝关节额外乘以连杆比
+} JointCalibration_t;
+
+/**
+ * 默认标定表，按电机顺序排列：下标 = 通道(腿) * MOTORS_PER_CHANNEL + 电机编号
+ * 电机顺序为FR，FL，RR，RL，每条腿依次为髋、大腿、膝
+ */
+constexpr JointCalibration_t DEFAULT_JOINT_CALIBRATION[NUM_JOINTS] = {
+    // 腿0
+    { 1.0f,  0.917742f,  GEAR_RATIO},
+    {-1.0f, -1.775659f,  GEAR_RATIO},
+    { 1.0f,  3.205968f,  GEAR_RATIO * KNEE_RATIO},
+    // 腿1
+    { 1.0f,  0.83411f,   GEAR_RATIO},
+    { 1.0f, -0.950479f,  GEAR_RATIO},
+    {-1.0f,  2.6572986f, GEAR_RATIO * KNEE_RATIO},
+    // 腿2
+    {-1.0f,  0.036858f,  GEAR_RATIO},
+    {-1.0f, -1.4168f,    GEAR_RATIO},
+    { 1.0f,  3.2397f,    GEAR_RATIO * KNEE_RATIO},
+    // 腿3
+    {-1.0f, -0.414653f,  GEAR_RATIO},
+    { 1.0f, -0.42181f,   GEAR_RATIO},
+    {-1.0f,  2.231182f,  GEAR_RATIO * KNEE_RATIO},
+};
+
+/**
+ * @brief 由标定表派生的逐关节换算系数
+ * 按数组结构(SoA)存放，批量换算时12个关节连续访问，编译器可直接向量化
+ */
+typedef struct {
+    alignas(64) float offset[NUM_JOINTS];        // 零点偏移
+    alignas(64) float out_per_rotor[NUM_JOINTS]; // 转子端位置/速度 -> 输出端：sign / ratio
+    alignas(64) float rotor_per_out[NUM_JOINTS]; // 输出端位置/速度 -> 转子端：sign * ratio
+    alignas(64) float tor_out_scale[NUM_JOINTS]; // 转子端转矩 -> 输出端：sign * ratio
+    alignas(64) float tor_rotor_scale[NUM_JOINTS];// 输出端转矩 -> 转子端：sign / ratio
+    alignas(64) float raw_tor_scale[NUM_JOINTS]; // 原始转矩定点数 -> 输出端转矩
+    alignas(64) float raw_spd_scale[NUM_JOINTS]; // 原始速度定点数 -> 输出端速度
+    alignas(64) float raw_pos_scale[NUM_JOINTS]; // 原始位置定点数 -> 输出端位置
+} JointCalibrationTable_t;
+
+/**
+ * @brief 12个关节的原始反馈(协议定点数)，按电机顺序
+ */
+typedef struct {
+    int16_t torque[NUM_JOINTS];  // 1/256 N·m
+    int16_t speed[NUM_JOINTS];   // 1/256 转/秒
+    int32_t pos[NUM_JOINTS];     // 1/32768 转
+} JointRawFeedback_t;
+
+/**
+ * @brief 12个关节的状态(浮点)，按电机顺序
+ */
+typedef struct {
+    float tor[NUM_JOINTS];
+    float spd[NUM_JOINTS];
+    float pos[NUM_JOINTS];
+} JointState_t;
+
+/**
+ * @brief 12个关节的控制参数(浮点)，按电机顺序
+ */
+typedef struct {
+    float tor[NUM_JOINTS];
+    float spd[NUM_JOINTS];
+    float pos[NUM_JOINTS];
+    float k_pos[NUM_JOINTS];
+    float k_spd[NUM_JOINTS];
+} JointCommand_t;
+
+// 当前使用的换算系数，启动时由默认标定表生成
+extern JointCalibrationTable_t g_joint_calibration;
+
+// 用新的标定表重新生成换算系数，需在控制线程启动前调用
+void joint_calibration_set(const JointCalibration_t calib[NUM_JOINTS]);
+
+// 从文本文件加载标定表，每行为"通道 电机 sign offset ratio"，#开头为注释
+bool joint_calibration_load(const char* path);
+
+// 批量换算：12个原始反馈 -> 输出端转矩、速度、位置
+void joint_raw_to_output(const JointRawFeedback_t& raw, JointState_t& out);
+
+// 批量换算：12个转子端反馈 -> 输出端
+void joint_rotor_to_output(const JointState_t& rotor, JointState_t& out);
+
+// 批量换算：12个输出端目标 -> 转子端命令，增益只按GEAR_RATIO折算
+void joint_output_to_rotor(const JointCommand_t& target, JointCommand_t& rotor);
+
+#endif // JOINT_CALIBRATION_HPP
@@ -0,0 +1,124 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include <cstring>
+
+/**
+ * 对数-线性分桶的时延直方图(HDR直方图的简化版)
+ * 0~63按1us一个桶精确统计；之后每个2的幂区间分成32个桶，相对误差不超过1/32；
+ * 超过LATENCY_HIST_MAX_US的值记入最后一个桶
+ *
+ * 每个直方图只有一个写者(所在的实时线程)，记录一次只是几条整数运算和两次无竞争的原子写，
+ * 不加锁；其他线程随时可以复制出快照，快照内各桶之间不保证是同一时刻的
+ */
+
+#define LATENCY_HIST_SUB_BITS 5                                   // 每个2的幂区间的桶数 = 2^SUB_BITS
+#define LATENCY_HIST_SUB_COUNT (1 << LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_MAX_BIT 24                                   // 可区分的最大值为2^24-1(约16.7秒)
+#define LATENCY_HIST_MAX_US ((1u << LATENCY_HIST_MAX_BIT) - 1)
+#define LATENCY_HIST_BUCKETS ((LATENCY_HIST_MAX_BIT - LATENCY_HIST_SUB_BITS + 1) * LATENCY_HIST_SUB_COUNT)
+
+/**
+ * @brief 直方图快照，普通内存，可以相减得到一段时间内的分布
+ */
+typedef struct {
+    uint64_t counts[LATENCY_HIST_BUCKETS];
+    uint64_t total;  // 样本数
+    uint64_t sum;    // 样本值之和，用于求平均值
+} LatencyHistSnapshot_t;
+
+// 值所在的桶
+inline int latency_hist_bucket(uint32_t v) {
+    if (v > LATENCY_HIST_MAX_US) v = LATENCY_HIST_MAX_US;
+    if (v < 2 * LATENCY_HIST_SUB_COUNT) return (int)v;
+    int shift = (31 - __builtin_clz(v)) - LATENCY_HIST_SUB_BITS;
+    return 2 * LATENCY_HIST_SUB_COUNT + (shift - 1) * LATENCY_HIST_SUB_COUNT
+           + (int)(v >> shift) - LATENCY_HIST_SUB_COUNT;
+}
+
+// 桶内的最大值，报告分位数时使用，保证不低估
+inline uint32_t latency_hist_bucket_upper(int b) {
+    if (b < 2 * LATENCY_HIST_SUB_COUNT) return (uint32_t)b;
+    int k = b - 2 * LATENCY_HIST_SUB_COUNT;
+    int shift = k / LATENCY_HIST_SUB_COUNT + 1;
+    uint32_t mantissa = (uint32_t)(k % LATENCY_HIST_SUB_COUNT + LATENCY_HIST_SUB_COUNT);
+    return ((mantissa + 1) << shift) - 1;
+}
+
+class LatencyHistogram {
+public:
+    LatencyHistogram() : sum(0) {
+        for (int i = 0; i < LATENCY_HIST_BUCKETS; ++i) counts[i].store(0, std::memory_order_relaxed);
+    }
+
+    // 记录一个样本，只能由唯一的写者线程调用
+    void record(uint32_t v) {
+        std::atomic<uint64_t>& c = counts[latency_hist_bucket(v)];
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        sum.store(sum.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    }
+
+    // 复制一份快照，可在任意线程调用
+    void snapshot(LatencyHistSnapshot_t& out) const {
+        out.sum = sum.load(std::memory_order_relaxed);
+        out.total = 0;
+        for (int i = 0; i < LATENCY_HIST_BUCKETS; ++i) {
+            out.counts[i] = counts[i].load(std::memory_order_relaxed);
+            out.total += out.counts[i];
+        }
+    }
+
+private:
+    std::atomic<uint64_t> counts[LATENCY_HIST_BUCKETS];
+    std::atomic<uint64_t> sum;
+};
+
+// out = now - prev，得到两次快照之间的分布
+inline void latency_hist_subtract(const LatencyHistSnapshot_t& now, const LatencyHistSnapshot_t& prev,
+                                  LatencyHistSnapshot_t& out) {
+    out.total = 0;
+    for (int i = 0; i < LATENCY_HIST_BUCKETS; ++i) {
+        out.counts[i] = now.counts[i] >= prev.counts[i] ? now.counts[i] - prev.counts[i] : 0;
+        out.total += out.counts[i];
+    }
+    out.sum = now.sum >= prev.sum ? now.sum - prev.sum : 0;
+}
+
+// dst += src，用于把同一通道3个电机的分布合并
+inline void latency_hist_merge(LatencyHistSnapshot_t& dst, const LatencyHistSnapshot_t& src) {
+    for (int i = 0; i < LATENCY_HIST_BUCKETS; ++i) dst.counts[i] += src.counts[i];
+    dst.total += src.total;
+    dst.sum += src.sum;
+}
+
+inline void latency_hist_clear(LatencyHistSnapshot_t& s) {
+    memset(&s, 0, sizeof(s));
+}
+
+// q分位(q取0~1)，返回所在桶的上沿；没有样本时返回0
+inline uint32_t latency_hist_quantile(const LatencyHistSnapshot_t& s, double q) {
+    if (s.total == 0) return 0;
+    uint64_t target = (uint64_t)(q * (double)(s.total - 1));
+    uint64_t acc = 0;
+    for (int i = 0; i < LATENCY_HIST_BUCKETS; ++i) {
+        acc += s.counts[i];
+        if (acc > target) return latency_hist_bucket_upper(i);
+    }
+    return LATENCY_HIST_MAX_US;
+}
+
+// 最大值所在桶的上沿
+inline uint32_t latency_hist_max(const LatencyHistSnapshot_t& s) {
+    for (int i = LATENCY_HIST_BUCKETS - 1; i >= 0; --i) {
+        if (s.counts[i] != 0) return latency_hist_bucket_upper(i);
+    }
+    return 0;
+}
+
+inline double latency_hist_mean(const LatencyHistSnapshot_t& s) {
+    return s.total > 0 ? (double)s.sum / (double)s.total : 0.0;
+}
+
+#endif // LATENCY_HISTOGRAM_HPP
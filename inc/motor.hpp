@@ -2,6 +2,8 @@
 #define MOTOR_HPP
 
 #include <stdint.h>
+#include <atomic>
+#include "seqlock.hpp"
 
 // Motor 类定义，用于控制和监控电机
 class Motor {
@@ -72,6 +74,31 @@ public:
 
     #pragma pack()  // 恢复默认的内存对齐
 
+    /**
+     * @brief 转子端控制参数
+     * 控制线程写入，通道线程打包发送
+     */
+    typedef struct {
+        float tor_des;  // 目标转矩
+        float spd_des;  // 目标速度
+        float pos_des;  // 目标位置
+        float k_pos;    // 位置增益
+        float k_spd;    // 速度增益
+    } Command_t;
+
+    /**
+     * @brief 转子端反馈数据
+     * 通道线程写入，控制线程读取
+     */
+    typedef struct {
+        float tor;         // 当前转矩
+        float spd;         // 当前速度
+        float pos;         // 当前位置
+        float temp;        // 当前温度
+        uint16_t err;      // 错误代码
+        int64_t stamp_ns;  // 收到反馈的时刻(steady_clock纳秒)，0表示尚未收到
+    } Feedback_t;
+
     // 构造函数
     Motor();
 
@@ -94,22 +121,34 @@ public:
     float getPosition(int16_t id,int16_t num) const;
     
     // 获取当前温度
-    float getTemperature() const { return temp; }
+    float getTemperature() const { return feedback.load().temp; }
     
     // 获取当前错误代码
-    uint16_t getError() const { return err; }
+    uint16_t getError() const { return feedback.load().err; }
+
+    // 获取一份完整的转子端反馈数据（不会读到写一半的数据）
+    Feedback_t getFeedback() const { return feedback.load(); }
+
+    // 直接写入一份转子端反馈，供离线回放使用，不能与该电机的通道线程同时调用
+    void setFeedback(const Feedback_t& f) { feedback.store(f); }
+
+    // 获取一份完整的转子端控制参数
+    Command_t getCommand() const { return command.load(); }
+
+    // 直接写入一份已换算到转子端的控制参数
+    void setCommand(const Command_t& c) { command.store_shared(c); }
 
     // 获取发送计数
-    uint64_t getSendCount() const { return send_count; }
+    uint64_t getSendCount() const { return send_count.load(std::memory_order_relaxed); }
     
     // 获取接收计数
-    uint64_t getReceiveCount() const { return receive_count; }
+    uint64_t getReceiveCount() const { return receive_count.load(std::memory_order_relaxed); }
 
-    // 增加发送计数
-    void incrementSendCount() { ++send_count; }
+    // 增加发送计数（只由该电机所在的通道线程调用）
+    void incrementSendCount() { send_count.store(send_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
     
-    // 增加接收计数
-    void incrementReceiveCount() { ++receive_count; }
+    // 增加接收计数（只由该电机所在的通道线程调用）
+    void incrementReceiveCount() { receive_count.store(receive_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
     
     // 重置统计信息
     void resetStats();
@@ -119,30 +158,17 @@ public:
 
 
 private:
-    // 控制参数
-    float tor_des;  // 目标转矩
-    float spd_des;  // 目标速度
-    float pos_des;  // 目标位置
-    float k_pos;    // 位置增益
-    float k_spd;    // 速度增益
-
-    // 反馈数据
-    float tor;      // 当前转矩
-    float spd;      // 当前速度
-    float pos;      // 当前位置
-    float temp;     // 当前温度
-    uint16_t err;   // 错误代码
+    // 控制参数，多个控制线程可能同时写入，用顺序锁交换，通道线程读取时不加锁
+    SeqLock<Command_t> command;
+
+    // 反馈数据，只由通道线程写入（无等待），控制线程读取时不加锁
+    SeqLock<Feedback_t> feedback;
 
     // 统计信息
-    uint64_t send_count;     // 发送计数
-    uint64_t receive_count;  // 接收计数
+    std::atomic<uint64_t> send_count;     // 发送计数
+    std::atomic<uint64_t> receive_count;  // 接收计数
 };
 
-// CRC 相关函数声明
-// 计算单个字节的CRC值
-uint16_t crc_ccitt_byte(uint16_t crc, const uint8_t c);
-
-// 计算一串数据的CRC值
-uint16_t crc_ccitt(uint16_t crc, const uint8_t *buffer, uint16_t len);
+// CRC计算见protocol_codec.hpp
 
 #endif // MOTOR_H
\ No newline at end of file
@@ -6,14 +6,17 @@
 #include "motor.hpp"
 #include "common.hpp"
 #include <atomic>  
-#include <mutex>   
 
 // 函数声明
 void channel_thread(int channel);
 
+// 读取全部电机的反馈快照，每个电机都是完整的一帧反馈，不加锁
+void motor_feedback_snapshot(Motor::Feedback_t out[NUM_CHANNELS][MOTORS_PER_CHANNEL]);
+
 // 全局变量声明
-extern std::vector<std::vector<Motor>> g_motors;
+// 电机的控制参数与反馈数据都由顺序锁保护，各线程直接访问，不再需要全局互斥锁
+extern Motor g_motors[NUM_CHANNELS][MOTORS_PER_CHANNEL];
 extern std::atomic<bool> g_running;
-extern std::mutex g_motor_mutex;
+extern const char* g_motor_port_prefix; // 电机串口设备名前缀，默认/dev/ttyMotor，仿真时指向PTY链接目录
 
 #endif
\ No newline at end of file
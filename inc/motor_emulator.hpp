@@ -0,0 +1,88 @@
+#ifndef MOTOR_EMULATOR_HPP
+#define MOTOR_EMULATOR_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "motor.hpp"
+#include "common.hpp"
+
+/**
+ * 电机总线仿真器
+ * 用伪终端(PTY)代替/dev/ttyMotorA..D，按Motor::ControlData_t/RecvData_t协议应答，
+ * 每个电机的应答延时可单独配置，用于在没有实机的情况下测量1khz通信链路
+ */
+class MotorEmulator {
+public:
+    /**
+     * @brief 单个电机的应答模型
+     */
+    typedef struct {
+        uint32_t latency_us;  // 收到完整命令到开始应答的延时(微秒)
+        uint32_t jitter_us;   // 在latency_us基础上叠加的均匀随机抖动(微秒)
+        float drop_rate;      // 丢弃应答的概率(0-1)，用于模拟丢包
+        float garbage_rate;   // 在应答前插入杂散字节的概率(0-1)，用于模拟帧错位
+        uint32_t split_gap_us;// 应答拆成两段写出时两段之间的间隔(微秒)，0表示整帧写出
+    } MotorConfig_t;
+
+    MotorEmulator();
+    ~MotorEmulator();
+
+    // 创建4路PTY，并在link_dir下建立ttyMotorA..D符号链接，成功返回true
+    bool start(const char* link_dir);
+
+    // 停止应答线程并关闭PTY
+    void stop();
+
+    // 设置某个电机的应答模型，channel为腿编号，motor为每条腿上的电机编号
+    void setMotorConfig(int channel, int motor, const MotorConfig_t& cfg);
+
+    // 设置所有电机的应答模型
+    void setAllMotorConfig(const MotorConfig_t& cfg);
+
+    // 获取串口设备名前缀，可直接赋给g_motor_port_prefix
+    const char* getPortPrefix() const { return port_prefix.c_str(); }
+
+    // 获取某个电机收到的有效命令数
+    uint64_t getRequestCount(int channel, int motor) const { return request_count[channel][motor].load(); }
+
+    // 获取某个电机被主动丢弃的应答数
+    uint64_t getDropCount(int channel, int motor) const { return drop_count[channel][motor].load(); }
+
+    // 获取某通道最近一次应答写完的时刻(steady_clock纳秒)
+    int64_t getLastReplyTime(int channel) const { return last_reply_ns[channel].load(); }
+
+    // 获取CRC或帧头错误的命令数
+    uint64_t getBadFrameCount(int channel) const { return bad_frame_count[channel].load(); }
+
+private:
+    // 电机仿真状态(转子端，协议原始单位)
+    typedef struct {
+        int16_t torque;
+        int16_t speed;
+        int32_t pos;
+    } MotorState_t;
+
+    // 单个通道的应答线程
+    void channel_loop(int channel);
+
+    // 根据命令更新电机状态并构建应答包
+    Motor::RecvData_t create_response(int channel, const Motor::ControlData_t& cmd);
+
+    std::string link_dir;
+    std::string port_prefix;
+    int master_fd[NUM_CHANNELS];
+    int slave_fd[NUM_CHANNELS];  // 保持从端打开，避免被测程序关闭串口时主端读到EIO
+    MotorConfig_t config[NUM_CHANNELS][MOTORS_PER_CHANNEL];
+    MotorState_t state[NUM_CHANNELS][MOTORS_PER_CHANNEL];
+    std::atomic<uint64_t> request_count[NUM_CHANNELS][MOTORS_PER_CHANNEL];
+    std::atomic<uint64_t> drop_count[NUM_CHANNELS][MOTORS_PER_CHANNEL];
+    std::atomic<uint64_t> bad_frame_count[NUM_CHANNELS];
+    std::atomic<int64_t> last_reply_ns[NUM_CHANNELS];
+    std::atomic<bool> running;
+    std::vector<std::thread> threads;
+};
+
+#endif // MOTOR_EMULATOR_HPP
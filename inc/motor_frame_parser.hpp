@@ -0,0 +1,54 @@
+#ifndef MOTOR_FRAME_PARSER_HPP
+#define MOTOR_FRAME_PARSER_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include "motor.hpp"
+
+/**
+ * 电机应答帧流式解析器
+ * 每个通道一个实例，串口数据直接读入内部环形缓冲区，
+ * 按0xFD 0xEE帧头重同步并原地校验CRC，完整帧以指针形式返回，不做拷贝
+ */
+class MotorFrameParser {
+public:
+    static const size_t BUFFER_SIZE = 256;  // 缓冲区大小，可容纳16个完整应答帧
+    static const size_t FRAME_SIZE = sizeof(Motor::RecvData_t);
+
+    MotorFrameParser();
+
+    // 丢弃缓冲区中所有数据
+    void reset() { head = 0; tail = 0; }
+
+    // 从串口读取数据到缓冲区，返回read()的结果
+    ssize_t read_from(int fd);
+
+    // 获取可写入的连续空间，写入后调用commit()
+    uint8_t* write_ptr();
+    size_t write_space() const { return BUFFER_SIZE - tail; }
+    void commit(size_t n) { tail += n; }
+
+    // 取出下一个帧头和CRC都正确的应答帧，没有完整帧时返回nullptr
+    // 返回的指针在下一次写入缓冲区前有效
+    const Motor::RecvData_t* next_frame();
+
+    // 缓冲区中尚未解析的字节数
+    size_t pending() const { return tail - head; }
+
+    // 获取CRC错误计数
+    uint64_t getCrcErrorCount() const { return crc_error_count; }
+
+    // 获取重同步时丢弃的字节数
+    uint64_t getResyncByteCount() const { return resync_byte_count; }
+
+private:
+    uint8_t buffer[BUFFER_SIZE];
+    size_t head;  // 下一个待解析字节
+    size_t tail;  // 下一个写入位置
+
+    uint64_t crc_error_count;
+    uint64_t resync_byte_count;
+};
+
+#endif // MOTOR_FRAME_PARSER_HPP
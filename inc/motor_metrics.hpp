@@ -0,0 +1,63 @@
+#ifndef MOTOR_METRICS_HPP
+#define MOTOR_METRICS_HPP
+
+#include <stdint.h>
+#include <cstdio>
+#include "common.hpp"
+#include "latency_histogram.hpp"
+
+/**
+ * 电机总线时延统计
+ * 每个电机：命令到应答的往返时延、每条命令完成前的重试次数
+ * 每个通道：相邻两个周期开始时刻的间隔、一个周期内收发占用的时间
+ * 由通道线程或反应器线程无锁记录，非实时的报告线程定期取快照打印或导出
+ */
+
+/**
+ * @brief 某一时刻全部直方图和收发计数的快照
+ * 约160KB，只在非实时线程中分配
+ */
+typedef struct {
+    double stamp_s;  // 快照时刻(steady_clock，秒)
+    LatencyHistSnapshot_t rtt_us[NUM_CHANNELS][MOTORS_PER_CHANNEL];
+    LatencyHistSnapshot_t retries[NUM_CHANNELS][MOTORS_PER_CHANNEL];
+    LatencyHistSnapshot_t period_us[NUM_CHANNELS];
+    LatencyHistSnapshot_t busy_us[NUM_CHANNELS];
+    uint64_t sent[NUM_CHANNELS][MOTORS_PER_CHANNEL];
+    uint64_t received[NUM_CHANNELS][MOTORS_PER_CHANNEL];
+} MotorMetricsSnapshot_t;
+
+// ——— 实时线程调用，只能由该通道的唯一写者线程调用 ———
+
+// 记录一次成功交互的往返时延(微秒)
+void motor_metrics_record_rtt(int channel, int motor, uint32_t rtt_us);
+
+// 一条命令完成(收到应答或放弃)时记录它经历的重试次数
+void motor_metrics_record_retries(int channel, int motor, uint32_t retries);
+
+// 记录与上一周期开始时刻的间隔(微秒)
+void motor_metrics_record_period(int channel, uint32_t period_us);
+
+// 记录一个周期内收发占用的时间(微秒)
+void motor_metrics_record_busy(int channel, uint32_t busy_us);
+
+// ——— 非实时线程调用 ———
+
+// 复制全部直方图和收发计数
+void motor_metrics_snapshot(MotorMetricsSnapshot_t& out);
+
+// out = now - prev，得到两次快照之间的统计
+void motor_metrics_subtract(const MotorMetricsSnapshot_t& now, const MotorMetricsSnapshot_t& prev,
+                            MotorMetricsSnapshot_t& out);
+
+// 打印每个电机和每个通道的分位数表
+void print_motor_metrics(const MotorMetricsSnapshot_t& s);
+
+// 以CSV格式追加一段统计，每个直方图一行；header为true时先写表头
+void export_motor_metrics_csv(FILE* fp, const MotorMetricsSnapshot_t& s, bool header);
+
+// 报告线程：每period_ms毫秒打印一次这段时间内的统计和各周期循环(PeriodicLoop)的累计统计，csv_path非空时同时追加到CSV文件
+// 运行到g_running变为false
+void motor_metrics_reporter_thread(int period_ms, const char* csv_path);
+
+#endif // MOTOR_METRICS_HPP
@@ -0,0 +1,33 @@
+#ifndef MOTOR_REACTOR_HPP
+#define MOTOR_REACTOR_HPP
+
+#include <stdint.h>
+#include "common.hpp"
+
+/**
+ * @brief 单条总线的周期统计
+ * 一个总线周期指该通道3个电机依次完成一问一答
+ */
+typedef struct {
+    uint64_t cycles;      // 完成的总线周期数
+    uint64_t overruns;    // 1ms节拍到来时上一周期仍未完成的次数
+    uint64_t timeouts;    // 应答超时次数
+    uint64_t failures;    // 重试耗尽后放弃的次数
+    uint64_t skips;       // 周期预算不足、顺延到下个周期的电机次数
+    double last_cycle_us; // 最近一个周期耗时(微秒)
+    double min_cycle_us;  // 最短周期耗时
+    double max_cycle_us;  // 最长周期耗时
+    double avg_cycle_us;  // 平均周期耗时
+} ReactorChannelStats_t;
+
+// 反应器线程函数：单线程用epoll管理全部电机串口，替代NUM_CHANNELS个channel_thread
+// 每个1ms节拍同时启动所有总线的一问一答序列，4条RS485总线并行传输
+void motor_reactor_thread();
+
+// 获取某通道的周期统计，可在非实时线程中调用
+ReactorChannelStats_t get_reactor_stats(int channel);
+
+// 打印所有通道的周期统计
+void print_reactor_statistics();
+
+#endif // MOTOR_REACTOR_HPP
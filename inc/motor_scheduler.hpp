@@ -0,0 +1,75 @@
+#ifndef MOTOR_SCHEDULER_HPP
+#define MOTOR_SCHEDULER_HPP
+
+#include <stdint.h>
+#include <chrono>
+#include "common.hpp"
+#include "motor_frame_parser.hpp"
+
+/**
+ * @brief 单个电机的调度统计
+ */
+typedef struct {
+    uint64_t attempts;   // 发送的命令数(含重试)
+    uint64_t successes;  // 收到应答的次数
+    uint64_t timeouts;   // 单次等待超时的次数
+    uint64_t failures;   // 连续MAX_RETRY_COUNT次超时后放弃的次数
+    uint64_t skips;      // 周期预算不足、本周期没有轮到的次数
+    uint64_t lates;      // 应答在周期截止时刻之后才收到的次数
+    uint32_t timeout_us; // 当前估计的应答超时(微秒)
+    uint32_t rtt_p50_us; // 往返时延中位数估计(微秒)
+    uint32_t rtt_p99_us; // 往返时延p99估计(微秒)
+} MotorSchedStats_t;
+
+/**
+ * 往返时延估计器
+ * 按RTT_BUCKET_US宽的桶统计最近的往返时延，样本数达到上限时所有桶减半，
+ * 使估计跟随总线状态缓慢变化。只由所在通道线程访问
+ */
+class RttEstimator {
+public:
+    RttEstimator();
+
+    // 记录一次成功交互的往返时延
+    void add(long rtt_us);
+
+    // 第attempt次尝试(从0开始)使用的超时，样本不足时使用COMM_TIMEOUT_MS
+    long timeout_us(int attempt) const;
+
+    // 往返时延的q分位估计(微秒)，q取0~1
+    long quantile_us(double q) const;
+
+private:
+    static const int NUM_BUCKETS = 128;
+    static const uint32_t MAX_SAMPLES = 1024;
+
+    uint32_t counts[NUM_BUCKETS];
+    uint32_t total;
+};
+
+/**
+ * 通道调度器
+ * 每个周期按轮转顺序与3个电机一问一答，超时由每个电机的RTT估计给出；
+ * 重试只在本周期剩余预算足够时立即进行，预算不足的电机顺延到下个周期优先处理，不再睡眠等待
+ */
+class ChannelScheduler {
+public:
+    explicit ChannelScheduler(int channel);
+
+    // 执行一个周期，cycle_end为本周期的截止时刻
+    void run_cycle(int fd, MotorFrameParser& parser, std::chrono::steady_clock::time_point cycle_end);
+
+private:
+    int channel;
+    int start_motor;                      // 本周期从哪个电机开始
+    int attempt[MOTORS_PER_CHANNEL];      // 当前命令已连续超时的次数，跨周期保留
+    RttEstimator rtt[MOTORS_PER_CHANNEL];
+};
+
+// 读取某个电机的调度统计，可在任意线程调用
+MotorSchedStats_t get_motor_sched_stats(int channel, int motor);
+
+// 打印所有电机的调度统计
+void print_motor_sched_statistics();
+
+#endif // MOTOR_SCHEDULER_HPP
@@ -0,0 +1,85 @@
+#ifndef PERIODIC_LOOP_HPP
+#define PERIODIC_LOOP_HPP
+
+#include <stdint.h>
+#include <chrono>
+#include "latency_histogram.hpp"
+
+#define PERIODIC_LOOP_MAX 16       // 可登记的周期循环数量
+#define PERIODIC_LOOP_NAME_LEN 32  // 循环名称的最大长度(含结尾0)
+
+/**
+ * 超期处理策略：一次迭代的工作超过了本周期的截止时刻时如何安排下一次迭代
+ */
+enum class OverrunPolicy {
+    SKIP,     // 丢弃已错过的节拍，按原相位从下一个未来节拍开始
+    CATCH_UP, // 不丢节拍，立即连续执行积压的迭代直到追上(原来sleep_until的行为)
+    REPHASE,  // 立即开始下一次迭代，以当前时刻为新的相位
+};
+
+/**
+ * @brief 某个周期循环的统计
+ */
+typedef struct {
+    char name[PERIODIC_LOOP_NAME_LEN];
+    uint32_t period_us;
+    OverrunPolicy policy;
+    uint64_t cycles;         // 完成的迭代数
+    uint64_t overruns;       // 工作结束时已超过本周期截止时刻的次数
+    uint64_t missed_ticks;   // SKIP策略丢弃的节拍数
+    LatencyHistSnapshot_t lateness_us; // 实际唤醒时刻比计划时刻晚了多少
+    LatencyHistSnapshot_t work_us;     // 每次迭代的工作耗时
+} PeriodicLoopStats_t;
+
+/**
+ * 周期循环
+ * 替代各实时线程中手写的 next += period; ...; sleep_until(next)，
+ * 在每次等待时记录工作耗时、唤醒延迟和超期次数，并按策略处理超期。用法:
+ *
+ *     PeriodicLoop loop("algorithm", std::chrono::milliseconds(1), OverrunPolicy::SKIP);
+ *     while (g_running) {
+ *         ... // 本周期的工作，截止时刻为loop.deadline()
+ *         loop.wait();
+ *     }
+ *
+ * 同名的循环共用一份统计(线程重启后继续累计)。统计只由所在线程写入，任意线程可读
+ *
+ * 等待使用clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME)。在rt_spawn()启动的线程中，
+ * 周期、超期策略和唤醒前的自旋时间取自该线程的任务描述(见rt_executor.hpp)，构造参数只在直接运行时生效
+ */
+class PeriodicLoop {
+public:
+    PeriodicLoop(const char* name, std::chrono::microseconds period, OverrunPolicy policy, uint32_t spin_us = 0);
+
+    // 结束本次迭代并等待下一个周期开始
+    void wait();
+
+    // 本次迭代的计划开始时刻和截止时刻(下一次迭代的计划开始时刻)
+    std::chrono::steady_clock::time_point start() const { return cycle_start; }
+    std::chrono::steady_clock::time_point deadline() const { return cycle_deadline; }
+
+    // 修改超期处理策略，只能在所在线程调用
+    void setPolicy(OverrunPolicy p);
+
+private:
+    std::chrono::steady_clock::duration period;
+    OverrunPolicy policy;
+    uint32_t spin_us;  // 唤醒前自旋的时间，0为只睡眠
+    int slot;  // 统计所在的登记表位置，登记表已满时为-1
+    std::chrono::steady_clock::time_point cycle_start;
+    std::chrono::steady_clock::time_point cycle_deadline;
+    std::chrono::steady_clock::time_point woke_at;  // 本次迭代实际开始的时刻
+};
+
+// 登记过的周期循环数量
+int periodic_loop_count();
+
+// 读取第index个周期循环的统计，可在任意线程调用
+bool get_periodic_loop_stats(int index, PeriodicLoopStats_t& out);
+
+// 打印全部周期循环的统计
+void print_periodic_loop_statistics();
+
+const char* overrun_policy_name(OverrunPolicy p);
+
+#endif // PERIODIC_LOOP_HPP
@@ -0,0 +1,184 @@
+#ifndef POLICY_MLP_HPP
+#define POLICY_MLP_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * 原生策略执行器
+ * 策略网络(MixedMlpBarlowTwinsActor)只有几十万个参数，批大小为1，LibTorch每个算子的分发开销
+ * 比计算本身还大。PolicyMlp不依赖LibTorch，按加载时给出的层序列执行：
+ *   编码器：最近hist_rows行历史观测和当前观测拼成一行，经过Linear/ELU/LayerNorm序列得到潜变量
+ *   门控：[潜变量, 观测]经过Linear/ELU序列，softmax后得到各专家的系数
+ *   专家层：输入为[潜变量, 上一层输出](第一层为[潜变量, 观测])，各专家的输出按系数加权求和，层间ELU
+ *
+ * 权重在加载时转置并按输出分块打包进一块64字节对齐的连续内存(arena)：每块64个输出(尾块16的倍数)，
+ * 块内按输入行存放，GEMV对每个输入只做一次广播和若干次对齐加载+FMA，权重按顺序流过。
+ * 专家层把K个专家的输出列拼成一个K*out的Linear，一次GEMV后再按系数合并。
+ * 执行时不分配内存，在调用线程上完成；AVX-512/AVX2(+FMA)内核在运行时按CPU选择，其他平台使用
+ * 可被编译器自动向量化的标量内核
+ */
+
+#define POLICY_MLP_MAX_OPS 32   // 三段算子的总数上限
+#define POLICY_MLP_LANES 16     // 输出维数补齐到16的倍数(64字节)
+#define POLICY_MLP_BLOCK 64     // 打包时每块的输出数
+#define POLICY_FLAT_MAGIC "RDPOLICY"  // 扁平权重文件的标识(8字节，不含结尾0)
+#define POLICY_FLAT_VERSION 2     // 2: 文件头记录导出来源的指纹
+#define POLICY_FLAT_ALIGN 4096  // 权重区在文件中的对齐(页)，映射后直接满足内核的64字节对齐
+
+enum PolicyMlpOpType : uint32_t {
+    MLP_OP_LINEAR = 1,
+    MLP_OP_ELU,        // alpha = 1
+    MLP_OP_LAYERNORM,
+};
+
+enum PolicyMlpStage : uint32_t {
+    MLP_STAGE_ENCODER = 0,
+    MLP_STAGE_GATE,
+    MLP_STAGE_EXPERT,
+};
+
+enum PolicyMlpIsa {
+    MLP_ISA_SCALAR = 0,
+    MLP_ISA_AVX2,
+    MLP_ISA_AVX512,
+};
+
+/**
+ * @brief 一个算子，权重以arena中的偏移(float个数)给出
+ */
+typedef struct {
+    uint32_t stage;    // PolicyMlpStage
+    uint32_t type;     // PolicyMlpOpType
+    uint32_t in;       // 输入维数
+    uint32_t out;      // 输出维数；专家层为K*每个专家的输出
+    uint32_t out_pad;  // 补齐到POLICY_MLP_LANES的输出维数
+    uint32_t weight;   // LINEAR：打包后的权重；LAYERNORM：gamma
+    uint32_t bias;     // LINEAR：偏置(补零到out_pad)；LAYERNORM：beta
+    float eps;         // LAYERNORM
+} PolicyMlpOp_t;
+
+/**
+ * @brief 网络的各个维数，由finish()从算子序列推出
+ */
+typedef struct {
+    uint32_t obs_dim;        // 单步观测维数
+    uint32_t hist_rows;      // 编码器使用的历史行数(不含当前观测)
+    uint32_t latent_dim;     // 潜变量维数
+    uint32_t experts;        // 专家数
+    uint32_t action_dim;     // 动作维数
+    uint32_t num_ops;
+    uint32_t arena_floats;   // 权重区大小
+    uint32_t scratch_floats; // 执行时的暂存区大小
+} PolicyMlpDims_t;
+
+/**
+ * @brief 导出来源(TorchScript模型文件)的指纹：文件大小和整个文件的CRC32C
+ */
+typedef struct {
+    uint64_t size;
+    uint32_t crc;
+    uint32_t reserved;
+} PolicySourceId_t;
+
+/**
+ * @brief 扁平权重文件的文件头，之后在arena_offset处是原样的arena
+ * 文件头和权重区各有一个CRC32C，字段均为本机字节序(endian_tag用于识别)
+ */
+typedef struct {
+    char magic[8];             // POLICY_FLAT_MAGIC
+    uint32_t version;          // POLICY_FLAT_VERSION
+    uint32_t header_size;      // sizeof(PolicyFlatHeader_t)
+    uint32_t endian_tag;       // 0x01020304
+    uint32_t op_size;          // sizeof(PolicyMlpOp_t)
+    PolicyMlpDims_t dims;
+    PolicyMlpOp_t ops[POLICY_MLP_MAX_OPS];
+    uint64_t arena_offset;     // 权重区在文件中的偏移，POLICY_FLAT_ALIGN的倍数
+    uint64_t arena_bytes;
+    PolicySourceId_t source;   // 导出来源的指纹，加载时与模型文件比较
+    uint32_t arena_crc;        // 权重区的CRC32C
+    uint32_t header_crc;       // 本字段置0时整个文件头的CRC32C
+} PolicyFlatHeader_t;
+
+// CRC32C(Castagnoli)，x86有SSE4.2、aarch64有CRC扩展时使用硬件指令
+uint32_t policy_crc32c(const void* data, size_t len);
+
+// 计算文件的指纹，文件不可读时打印原因并返回false
+bool policy_source_id(const char* path, PolicySourceId_t& out);
+
+class PolicyMlp {
+public:
+    PolicyMlp();
+    ~PolicyMlp();
+    PolicyMlp(const PolicyMlp&) = delete;
+    PolicyMlp& operator=(const PolicyMlp&) = delete;
+
+    /**
+     * 构建，加载时调用(会分配内存)。算子按执行顺序加入，各段依次为编码器、门控、专家层
+     */
+    void begin(uint32_t obs_dim, uint32_t hist_rows);
+    // w为{out, in}行优先(torch.nn.Linear的weight)，b为{out}
+    bool add_linear(PolicyMlpStage stage, const float* w, const float* b, uint32_t in, uint32_t out);
+    // w为{experts, in, out}，b为{experts, out}(MixedMlp的w*/b*)
+    bool add_expert_linear(const float* w, const float* b, uint32_t experts, uint32_t in, uint32_t out);
+    bool add_elu(PolicyMlpStage stage);
+    bool add_layernorm(PolicyMlpStage stage, const float* gamma, const float* beta, uint32_t n, float eps);
+    // 检查各段维数是否衔接，推出dims()，分配执行用的暂存区；失败时返回false并打印原因
+    bool finish();
+    bool ready() const { return is_ready; }
+
+    /**
+     * 写出扁平权重文件(先写临时文件再改名)，finish()成功后才能调用
+     * @param source 权重所来自的模型文件的指纹，写入文件头
+     */
+    bool save(const char* path, const PolicySourceId_t& source) const;
+    /**
+     * 只读映射扁平权重文件并直接使用其中的权重，不拷贝；只分配暂存区。
+     * 检查标识、版本、结构大小、字节序、文件头CRC和算子的偏移，verify_crc为true时还检查权重区CRC
+     */
+    bool map(const char* path, bool verify_crc = true);
+    bool mapped() const { return map_base != nullptr; }
+    // 映射的文件记录的导出来源，未映射时为全0
+    const PolicySourceId_t& source() const { return src; }
+
+    /**
+     * 执行一次，不分配内存
+     * @param hist 按时间顺序连续存放的最近hist_rows行历史观测
+     * @param obs 当前观测
+     * @param action 输出，action_dim个
+     */
+    void forward(const float* hist, const float* obs, float* action);
+
+    const PolicyMlpDims_t& dims() const { return d; }
+    PolicyMlpIsa isa() const { return kernel_isa; }
+    // 选择内核，CPU不支持时返回false并保持不变
+    bool set_isa(PolicyMlpIsa isa);
+    // 本机支持的最快内核
+    static PolicyMlpIsa best_isa();
+    static const char* isa_name(PolicyMlpIsa isa);
+
+private:
+    bool push_op(const PolicyMlpOp_t& op);
+    uint32_t arena_reserve(uint32_t floats);
+    void release();
+
+    PolicyMlpDims_t d;
+    PolicyMlpOp_t ops[POLICY_MLP_MAX_OPS];
+    bool is_ready;
+    bool failed;             // 构建过程中出错，finish()返回false
+    PolicyMlpIsa kernel_isa;
+
+    float* arena;            // 权重区，64字节对齐；映射时指向只读映射，执行时只读
+    uint32_t arena_cap;      // 构建期间已分配的容量(float个数)
+    void* map_base;          // map()得到的映射，为空时arena由本对象分配
+    size_t map_len;
+    PolicySourceId_t src;    // 映射的文件头中的导出来源
+    float* scratch;          // 暂存区，64字节对齐
+    float* buf_x;            // 拼接后的输入
+    float* buf_a;            // 两个交替使用的中间结果
+    float* buf_b;
+    float* buf_latent;
+    float* buf_coef;         // 专家系数
+};
+
+#endif // POLICY_MLP_HPP
@@ -0,0 +1,162 @@
+#ifndef POLICY_PIPELINE_HPP
+#define POLICY_PIPELINE_HPP
+
+#include <stdint.h>
+#include "common.hpp"
+#include "latency_histogram.hpp"
+
+/**
+ * 策略推理与1khz控制之间的动作交接
+ * rl_run()(50hz)每次推理后把关节目标连同产生它的观测时刻发布到三缓冲的动作槽，
+ * algorithm_control_thread()每个节拍无等待地取用最新的一份，按配置的方式在两次策略输出之间
+ * 保持或插值，得到本节拍PD控制的目标。两侧都不等待对方，控制节拍不会被推理阻塞。
+ * 观测时刻随动作一起传递，用来统计观测 -> 发布(推理)和观测 -> 控制节拍首次使用(端到端)的时延
+ *
+ * 看门狗：推理一侧用policy_step_accept()检查每一步，输出不是有限值或完成时已超过观测时刻+预算的
+ * 不发布(记为拒绝)；控制一侧按最近一个好动作的观测时刻推算之后应到达的策略步，过期未到的计为错过，
+ * 推理卡住或一直被拒绝都会被发现。错过期间按设定保持最后的好动作或让目标衰减到静止姿态，
+ * 连续错过的步数达到上限后expired()为true，由控制线程触发保护。控制线程从不等待推理
+ */
+
+/**
+ * 两次策略输出之间的目标曲线
+ */
+enum PolicyActionProfile {
+    POLICY_PROFILE_HOLD = 0,  // 新动作到达后立即采用并保持(与训练时每个策略周期内目标不变一致)
+    POLICY_PROFILE_LINEAR,    // 从当前目标线性过渡到新动作
+    POLICY_PROFILE_SMOOTH,    // 三次平滑过渡(smoothstep)，过渡的起止处目标速度为0
+};
+
+/**
+ * 策略步错过时的目标
+ */
+enum PolicyFallback {
+    POLICY_FALLBACK_HOLD = 0,  // 保持最后一个好动作
+    POLICY_FALLBACK_DECAY,     // 从错过时的目标按指数衰减到reset()给出的静止姿态
+};
+
+// 推理一侧拒绝一步的原因
+enum PolicyRejectReason {
+    POLICY_REJECT_LATE = 0,    // 完成时已超过预算
+    POLICY_REJECT_NAN_OBS,     // 观测中有NaN，没有推理
+    POLICY_REJECT_NAN_ACTION,  // 网络输出不是有限值
+    POLICY_REJECT_REASONS
+};
+
+#define POLICY_MISS_RUN_BINS 8  // 连续错过步数的直方图，最后一个桶为不少于该值-1的次数
+
+/**
+ * @brief 一次策略输出
+ */
+typedef struct {
+    float target[NUM_JOINTS];  // 关节目标位置(rad)，网络顺序
+    int64_t obs_ns;            // 产生该动作的观测时刻(关节状态快照时刻，steady_clock纳秒)
+    int64_t publish_ns;        // 推理完成、发布的时刻
+    uint32_t seq;              // 策略步序号，从1开始
+} PolicyAction_t;
+
+// 时延统计的来源，每个来源只有一个写者
+enum PolicyLatencySource {
+    POLICY_LAT_INFER = 0,  // 观测 -> 推理完成(rl_run)，包括因超时或非有限值被拒绝的步
+    POLICY_LAT_APPLY,      // 观测 -> 控制节拍首次使用(algorithm_control)
+    POLICY_LAT_SOURCES
+};
+
+/**
+ * @brief 动作交接的计数
+ */
+typedef struct {
+    uint64_t published;   // 发布的动作数
+    uint64_t applied;     // 控制节拍取用的动作数
+    uint64_t superseded;  // 控制节拍取用之前就被更新的动作覆盖的动作数
+    uint64_t rejected[POLICY_REJECT_REASONS];  // 推理一侧按原因拒绝的步数
+    uint64_t missed;      // 控制一侧发现过期未到的策略步数
+    uint64_t escalations; // 连续错过达到上限的次数
+    uint64_t miss_runs[POLICY_MISS_RUN_BINS];  // 第k个桶：连续错过k步后恢复(或触发保护)的次数
+} PolicyPipelineStats_t;
+
+/**
+ * 发布一次策略输出，填写发布时刻和序号，无等待。只能由推理线程调用
+ * @param target 12个关节的目标位置，网络顺序
+ * @param obs_ns 产生该动作的观测时刻
+ */
+void policy_action_publish(const float* target, int64_t obs_ns);
+
+/**
+ * 推理一侧：检查一步的网络输出，全部是有限值并且在观测时刻+deadline_ns之前完成时返回true；
+ * 否则记录拒绝并返回false，调用者不应发布该输出，也不应把它写入历史
+ * @param action 网络输出，NUM_JOINTS个
+ */
+bool policy_step_accept(const float* action, int64_t obs_ns, int64_t deadline_ns);
+
+/**
+ * 推理一侧：记录一次拒绝，返回到本次为止连续拒绝的步数(用于只在第一次时打印)
+ */
+uint32_t policy_action_reject(PolicyRejectReason reason);
+
+/**
+ * 控制节拍一侧：取用最新的策略输出并计算每个节拍的目标
+ * 只能由一个线程使用(与policy_action_publish()配对的唯一读者)
+ */
+class ActionInterpolator {
+public:
+    ActionInterpolator();
+
+    // 设置目标曲线和过渡时长(纳秒)，HOLD时忽略时长
+    void set_profile(PolicyActionProfile profile, int64_t duration_ns);
+
+    /**
+     * 设置看门狗：策略周期、每步的预算、错过时的目标、衰减时间常数(纳秒)和触发保护的连续错过步数。
+     * period_ns为0时不检查
+     */
+    void set_watchdog(int64_t period_ns, int64_t deadline_ns, PolicyFallback fallback, int64_t decay_ns,
+                      uint32_t max_misses);
+
+    // 还没有策略输出时使用的目标，也是DECAY衰减到的静止姿态(例如站立姿态)
+    void reset(const float* target);
+
+    /**
+     * 每个节拍调用一次：有新的策略输出时取用并从当前目标开始过渡，然后计算本节拍的目标
+     * @param tick_ns 本节拍的计划时刻(steady_clock纳秒)
+     * @return 本节拍是否取用了新的策略输出
+     */
+    bool update(int64_t tick_ns);
+
+    // 本节拍的目标，网络顺序
+    const float* target() const { return out; }
+    // 最近取用的策略输出，seq为0表示还没有
+    const PolicyAction_t& current() const { return cur; }
+    // 当前连续错过的策略步数
+    uint32_t missed() const { return misses; }
+    // 连续错过达到上限，应触发保护
+    bool expired() const { return max_misses > 0 && misses >= max_misses; }
+
+private:
+    PolicyActionProfile profile;
+    int64_t duration_ns;
+    PolicyAction_t cur;
+    float from[NUM_JOINTS];  // 过渡的起点：取用新动作时的目标
+    float out[NUM_JOINTS];
+    int64_t start_ns;        // 过渡开始的节拍时刻
+
+    int64_t period_ns;
+    int64_t deadline_ns;
+    PolicyFallback fallback;
+    int64_t decay_ns;
+    uint32_t max_misses;
+    uint32_t misses;          // 当前连续错过的步数
+    float rest[NUM_JOINTS];   // 静止姿态
+    float stall[NUM_JOINTS];  // 开始错过时的目标
+    int64_t stall_ns;         // 开始错过的节拍时刻
+};
+
+// 读取某个来源的时延直方图(微秒)，可在任意线程调用
+void get_policy_latency_snapshot(PolicyLatencySource source, LatencyHistSnapshot_t& out);
+
+// 读取动作交接的计数，可在任意线程调用
+PolicyPipelineStats_t get_policy_pipeline_stats();
+
+// 打印动作交接的计数和时延分布(自启动以来)，还没有发布过动作时不打印
+void print_policy_pipeline_statistics();
+
+#endif // POLICY_PIPELINE_HPP
@@ -0,0 +1,294 @@
+#ifndef PROTOCOL_CODEC_HPP
+#define PROTOCOL_CODEC_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <cstring>
+#include "motor.hpp"
+
+/**
+ * 协议编解码库
+ * 电机协议(CRC-CCITT)与FDILink IMU协议(CRC8 + CRC16)的校验表在编译期生成，
+ * 校验提供逐字节和slicing-by-4/8三种实现，帧的打包、校验、解包都以模板给出
+ */
+
+// ——— 编译期CRC表 ———
+
+/**
+ * 低位在前(反射)的16位CRC表，slices张表
+ * 第k张表对应"后面还有k个字节"的贡献，用于一次处理多个字节
+ */
+template <int SLICES>
+struct Crc16ReflectedTable {
+    uint16_t t[SLICES][256];
+    constexpr explicit Crc16ReflectedTable(uint16_t poly) : t() {
+        for (int i = 0; i < 256; ++i) {
+            uint16_t crc = (uint16_t)i;
+            for (int b = 0; b < 8; ++b) crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ poly) : (uint16_t)(crc >> 1);
+            t[0][i] = crc;
+        }
+        for (int k = 1; k < SLICES; ++k)
+            for (int i = 0; i < 256; ++i)
+                t[k][i] = (uint16_t)((t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff]);
+    }
+};
+
+// 高位在前的16位CRC表
+template <int SLICES>
+struct Crc16NormalTable {
+    uint16_t t[SLICES][256];
+    constexpr explicit Crc16NormalTable(uint16_t poly) : t() {
+        for (int i = 0; i < 256; ++i) {
+            uint16_t crc = (uint16_t)(i << 8);
+            for (int b = 0; b < 8; ++b) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ poly) : (uint16_t)(crc << 1);
+            t[0][i] = crc;
+        }
+        for (int k = 1; k < SLICES; ++k)
+            for (int i = 0; i < 256; ++i)
+                t[k][i] = (uint16_t)((t[k - 1][i] << 8) ^ t[0][t[k - 1][i] >> 8]);
+    }
+};
+
+// 低位在前(反射)的8位CRC表
+template <int SLICES>
+struct Crc8ReflectedTable {
+    uint8_t t[SLICES][256];
+    constexpr explicit Crc8ReflectedTable(uint8_t poly) : t() {
+        for (int i = 0; i < 256; ++i) {
+            uint8_t crc = (uint8_t)i;
+            for (int b = 0; b < 8; ++b) crc = (crc & 1) ? (uint8_t)((crc >> 1) ^ poly) : (uint8_t)(crc >> 1);
+            t[0][i] = crc;
+        }
+        for (int k = 1; k < SLICES; ++k)
+            for (int i = 0; i < 256; ++i)
+                t[k][i] = t[0][t[k - 1][i]];
+    }
+};
+
+// 电机协议：CRC-CCITT，多项式0x1021的反射形式
+inline constexpr Crc16ReflectedTable<8> CRC_CCITT_TABLE(0x8408);
+// FDILink数据段：CRC16，多项式0x1021，高位在前
+inline constexpr Crc16NormalTable<8> FDILINK_CRC16_TABLE(0x1021);
+// FDILink帧头：CRC8，多项式0x31的反射形式
+inline constexpr Crc8ReflectedTable<8> FDILINK_CRC8_TABLE(0x8C);
+
+// 与原先手写的查找表逐项一致
+static_assert(CRC_CCITT_TABLE.t[0][1] == 0x1189 && CRC_CCITT_TABLE.t[0][255] == 0x0f78, "CRC-CCITT table mismatch");
+static_assert(FDILINK_CRC16_TABLE.t[0][1] == 0x1021 && FDILINK_CRC16_TABLE.t[0][255] == 0x1ef0, "FDILink CRC16 table mismatch");
+static_assert(FDILINK_CRC8_TABLE.t[0][1] == 94 && FDILINK_CRC8_TABLE.t[0][255] == 53, "FDILink CRC8 table mismatch");
+
+// ——— CRC计算，SLICES为一次处理的字节数(1、4或8) ———
+
+template <int SLICES>
+inline uint16_t crc_ccitt_sliced(uint16_t crc, const uint8_t* p, size_t len) {
+    static_assert(SLICES == 1 || SLICES == 4 || SLICES == 8, "SLICES must be 1, 4 or 8");
+    const auto& t = CRC_CCITT_TABLE.t;
+    if (SLICES == 8) {
+        for (; len >= 8; len -= 8, p += 8) {
+            crc ^= (uint16_t)(p[0] | (p[1] << 8));
+            crc = t[7][crc & 0xff] ^ t[6][crc >> 8] ^ t[5][p[2]] ^ t[4][p[3]] ^
+                  t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        }
+    }
+    if (SLICES >= 4) {
+        for (; len >= 4; len -= 4, p += 4) {
+            crc ^= (uint16_t)(p[0] | (p[1] << 8));
+            crc = t[3][crc & 0xff] ^ t[2][crc >> 8] ^ t[1][p[2]] ^ t[0][p[3]];
+        }
+    }
+    while (len--) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+    return crc;
+}
+
+template <int SLICES>
+inline uint16_t fdilink_crc16_sliced(const uint8_t* p, size_t len) {
+    static_assert(SLICES == 1 || SLICES == 4 || SLICES == 8, "SLICES must be 1, 4 or 8");
+    const auto& t = FDILINK_CRC16_TABLE.t;
+    uint16_t crc = 0;
+    if (SLICES == 8) {
+        for (; len >= 8; len -= 8, p += 8) {
+            crc ^= (uint16_t)((p[0] << 8) | p[1]);
+            crc = t[7][crc >> 8] ^ t[6][crc & 0xff] ^ t[5][p[2]] ^ t[4][p[3]] ^
+                  t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        }
+    }
+    if (SLICES >= 4) {
+        for (; len >= 4; len -= 4, p += 4) {
+            crc ^= (uint16_t)((p[0] << 8) | p[1]);
+            crc = t[3][crc >> 8] ^ t[2][crc & 0xff] ^ t[1][p[2]] ^ t[0][p[3]];
+        }
+    }
+    while (len--) crc = (uint16_t)(t[0][((crc >> 8) ^ *p++) & 0xff] ^ (crc << 8));
+    return crc;
+}
+
+template <int SLICES>
+inline uint8_t fdilink_crc8_sliced(const uint8_t* p, size_t len) {
+    static_assert(SLICES == 1 || SLICES == 4 || SLICES == 8, "SLICES must be 1, 4 or 8");
+    const auto& t = FDILINK_CRC8_TABLE.t;
+    uint8_t crc = 0;
+    if (SLICES == 8) {
+        for (; len >= 8; len -= 8, p += 8) {
+            crc = t[7][crc ^ p[0]] ^ t[6][p[1]] ^ t[5][p[2]] ^ t[4][p[3]] ^
+                  t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        }
+    }
+    if (SLICES >= 4) {
+        for (; len >= 4; len -= 4, p += 4) {
+            crc = t[3][crc ^ p[0]] ^ t[2][p[1]] ^ t[1][p[2]] ^ t[0][p[3]];
+        }
+    }
+    while (len--) crc = t[0][crc ^ *p++];
+    return crc;
+}
+
+// 1kHz路径上实际使用的实现，按bench_codec的测量结果选择
+#define MOTOR_CRC_SLICES 8
+#define FDILINK_CRC_SLICES 8
+
+// 计算一串数据的CRC-CCITT值
+inline uint16_t crc_ccitt(uint16_t crc, const uint8_t* buffer, uint16_t len) {
+    return crc_ccitt_sliced<MOTOR_CRC_SLICES>(crc, buffer, len);
+}
+
+// 计算单个字节的CRC-CCITT值
+inline uint16_t crc_ccitt_byte(uint16_t crc, const uint8_t c) {
+    return (crc >> 8) ^ CRC_CCITT_TABLE.t[0][(crc ^ c) & 0xff];
+}
+
+// ——— 电机协议帧 ———
+
+#define MOTOR_CRC_INIT 0x2cbb  // 电机协议CRC初值
+
+// 各类电机帧的帧头
+template <typename Frame> struct MotorFrameTraits;
+template <> struct MotorFrameTraits<Motor::ControlData_t> {
+    static constexpr uint8_t HEAD0 = 0xFE;
+    static constexpr uint8_t HEAD1 = 0xEE;
+};
+template <> struct MotorFrameTraits<Motor::RecvData_t> {
+    static constexpr uint8_t HEAD0 = 0xFD;
+    static constexpr uint8_t HEAD1 = 0xEE;
+};
+
+// 帧内除CRC外的字节数
+template <typename Frame>
+constexpr size_t motor_frame_body_size() {
+    static_assert(offsetof(Frame, CRC16) == sizeof(Frame) - 2, "CRC16 must be the last field");
+    return sizeof(Frame) - 2;
+}
+
+// 填写帧头并计算CRC，数据段需事先填好
+template <typename Frame>
+inline void motor_frame_seal(Frame& frame) {
+    frame.head[0] = MotorFrameTraits<Frame>::HEAD0;
+    frame.head[1] = MotorFrameTraits<Frame>::HEAD1;
+    frame.CRC16 = crc_ccitt(MOTOR_CRC_INIT, (const uint8_t*)&frame, motor_frame_body_size<Frame>());
+}
+
+// 检查一段字节是否为完整的Frame帧(帧头与CRC)，p可以不对齐
+template <typename Frame>
+inline bool motor_frame_verify(const uint8_t* p) {
+    if (p[0] != MotorFrameTraits<Frame>::HEAD0 || p[1] != MotorFrameTraits<Frame>::HEAD1) return false;
+    const size_t n = motor_frame_body_size<Frame>();
+    return crc_ccitt(MOTOR_CRC_INIT, p, n) == (uint16_t)(p[n] | (p[n + 1] << 8));
+}
+
+template <typename Frame>
+inline bool motor_frame_verify(const Frame& frame) {
+    return motor_frame_verify<Frame>((const uint8_t*)&frame);
+}
+
+// 转子端控制参数 -> 控制帧
+inline Motor::ControlData_t motor_encode_command(uint8_t motor_id, const Motor::Command_t& c) {
+    Motor::ControlData_t packet;
+    packet.mode.id = motor_id;
+    packet.mode.status = 1;   // 1表示正常工作状态
+    packet.mode.reserve = 0;  // 保留位，设为0
+    packet.comd.tor_des = (int16_t)(c.tor_des * 256.0f);                 // 转矩
+    packet.comd.spd_des = (int16_t)(c.spd_des / 6.28318f * 256.0f);      // 速度
+    packet.comd.pos_des = (int32_t)(c.pos_des / 6.28318f * 32768.0f);    // 位置
+    packet.comd.k_pos = (int16_t)(c.k_pos / 25.6f * 32768.0f);           // 位置增益
+    packet.comd.k_spd = (int16_t)(c.k_spd / 25.6f * 32768.0f);           // 速度增益
+    motor_frame_seal(packet);
+    return packet;
+}
+
+// 应答帧 -> 转子端反馈(不含时间戳)，帧需事先校验
+inline void motor_decode_feedback(const Motor::RecvData_t& recv_data, Motor::Feedback_t& f) {
+    f.tor = ((float)recv_data.fbk.torque) / 256.0f;                // 转矩
+    f.spd = ((float)recv_data.fbk.speed / 256.0f) * 6.28318f;      // 速度 (rad/s)
+    f.pos = 6.28318f * ((float)recv_data.fbk.pos) / 32768.0f;      // 位置 (rad)
+    f.temp = (float)recv_data.fbk.temp;                            // 温度
+    f.err = recv_data.fbk.MError;                                  // 错误代码
+}
+
+// ——— FDILink帧 ———
+// 帧格式: 0xFC | 类别 | 数据长度 | 帧计数 | CRC8(前4字节) | CRC16高 | CRC16低 | 数据 | 0xFD
+
+#define FDILINK_HEAD 0xFC
+#define FDILINK_TAIL 0xFD
+#define FDILINK_HEADER_SIZE 7      // 帧头到CRC16为止的字节数
+#define FDILINK_OVERHEAD 8         // 帧头加帧尾
+#define FDILINK_MAX_PAYLOAD 250
+
+// 帧头CRC8是否正确
+inline bool fdilink_header_crc_ok(const uint8_t* frame) {
+    return fdilink_crc8_sliced<FDILINK_CRC_SLICES>(frame, 4) == frame[4];
+}
+
+// 数据段CRC16是否正确
+inline bool fdilink_payload_crc_ok(const uint8_t* frame) {
+    const uint16_t crc16_recv = (uint16_t)((frame[5] << 8) | frame[6]);
+    return fdilink_crc16_sliced<FDILINK_CRC_SLICES>(frame + FDILINK_HEADER_SIZE, frame[2]) == crc16_recv;
+}
+
+// 数据段CRC16是否正确，帧头与数据段分开存放时使用(逐字节解析)
+inline bool fdilink_payload_crc_ok(const uint8_t* header, const uint8_t* payload) {
+    const uint16_t crc16_recv = (uint16_t)((header[5] << 8) | header[6]);
+    return fdilink_crc16_sliced<FDILINK_CRC_SLICES>(payload, header[2]) == crc16_recv;
+}
+
+/**
+ * 打包一帧FDILink数据
+ * @return 帧长度，数据过长时返回-1
+ */
+inline int fdilink_encode(uint8_t* buffer, uint8_t type, uint8_t seq, const void* payload, int len) {
+    if (len < 0 || len > FDILINK_MAX_PAYLOAD) {
+        return -1; //数据长度超过限制
+    }
+    buffer[0] = FDILINK_HEAD;
+    buffer[1] = type;
+    buffer[2] = (uint8_t)len;
+    buffer[3] = seq;
+    buffer[4] = fdilink_crc8_sliced<FDILINK_CRC_SLICES>(buffer, 4);
+    memcpy(buffer + FDILINK_HEADER_SIZE, payload, len);
+    const uint16_t crc16 = fdilink_crc16_sliced<FDILINK_CRC_SLICES>(buffer + FDILINK_HEADER_SIZE, len);
+    buffer[5] = (uint8_t)(crc16 >> 8);    //高八位
+    buffer[6] = (uint8_t)(crc16 & 0xFF);  //低八位
+    buffer[FDILINK_HEADER_SIZE + len] = FDILINK_TAIL;
+    return FDILINK_OVERHEAD + len;
+}
+
+// 按固定结构体打包，长度在编译期确定
+template <typename Payload>
+inline int fdilink_encode(uint8_t* buffer, uint8_t type, uint8_t seq, const Payload& payload) {
+    static_assert(sizeof(Payload) <= FDILINK_MAX_PAYLOAD, "FDILink payload too large");
+    return fdilink_encode(buffer, type, seq, &payload, (int)sizeof(Payload));
+}
+
+/**
+ * 校验并解出固定结构体的FDILink帧，frame指向0xFC且至少有sizeof(Payload)+8字节
+ * 类别、长度、帧尾和两级CRC都正确时返回true
+ */
+template <typename Payload>
+inline bool fdilink_decode(const uint8_t* frame, uint8_t type, Payload& out) {
+    constexpr int len = (int)sizeof(Payload);
+    if (frame[0] != FDILINK_HEAD || frame[1] != type || frame[2] != len) return false;
+    if (frame[FDILINK_HEADER_SIZE + len] != FDILINK_TAIL) return false;
+    if (!fdilink_header_crc_ok(frame) || !fdilink_payload_crc_ok(frame)) return false;
+    memcpy(&out, frame + FDILINK_HEADER_SIZE, len);
+    return true;
+}
+
+#endif // PROTOCOL_CODEC_HPP
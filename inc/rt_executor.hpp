@@ -0,0 +1,56 @@
+#ifndef RT_EXECUTOR_HPP
+#define RT_EXECUTOR_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include "periodic_loop.hpp"
+
+/**
+ * 实时线程执行器
+ * 每个线程用一份声明式的任务描述RtTaskSpec_t启动：调度策略和优先级、允许运行的CPU、
+ * 栈预分配大小，以及周期任务的周期、超期策略和唤醒方式。rt_spawn()在新线程中按描述设置好
+ * 调度参数并读回实际生效的值，之后才运行线程函数；print_rt_task_report()打印全部线程的实际策略
+ *
+ * 周期任务在线程函数中照常构造PeriodicLoop，在rt_spawn()启动的线程里，
+ * PeriodicLoop使用任务描述中的周期、超期策略和自旋时间，代码中给出的值只是直接运行时的默认值
+ */
+
+/**
+ * @brief 任务描述
+ */
+typedef struct {
+    const char* name;        // 线程名，也用于报告
+    uint32_t period_us;      // 周期(微秒)，0表示非周期任务
+    int priority;            // SCHED_FIFO优先级(1~99)，0表示普通调度SCHED_OTHER
+    int nice;                // 普通调度时的nice值
+    uint64_t cpu_mask;       // 允许运行的CPU，第i位对应CPU i，0表示不限制
+    size_t stack_prefault;   // 启动时预先写入的栈大小(字节)，避免运行中栈增长触发缺页
+    uint32_t spin_us;        // 周期任务唤醒时先睡到计划时刻前spin_us微秒，再自旋到计划时刻；0为只睡眠
+    OverrunPolicy policy;    // 周期任务的超期处理策略
+} RtTaskSpec_t;
+
+#define RT_CPU(n) (1ull << (n))
+
+/**
+ * 按任务描述启动线程
+ * 返回前等待新线程完成调度设置，因此启动顺序即报告顺序
+ */
+std::thread rt_spawn(const RtTaskSpec_t& spec, std::function<void()> body);
+
+// 当前线程的任务描述，不是由rt_spawn()启动的线程返回nullptr
+const RtTaskSpec_t* rt_current_task();
+
+/**
+ * 睡眠到steady_clock的绝对时刻t
+ * 使用clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME)，不会因计算相对时长后被抢占而多睡；
+ * spin_us大于0时先睡到t之前spin_us微秒，再忙等到t，以CPU占用换取更小的唤醒延迟
+ */
+void rt_sleep_until(std::chrono::steady_clock::time_point t, uint32_t spin_us);
+
+// 打印全部线程实际生效的调度策略、优先级、CPU和栈预分配
+void print_rt_task_report();
+
+#endif // RT_EXECUTOR_HPP
@@ -0,0 +1,77 @@
+#ifndef RT_MEMORY_HPP
+#define RT_MEMORY_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * 实时内存
+ * rt_memory_lock()锁定进程内存并预先分配堆，使实时线程运行中不因缺页或向内核申请内存而停顿；
+ * 线程栈由执行器按任务描述预先写入(见rt_executor.hpp)
+ *
+ * 分配检查：编译时定义RT_ALLOC_TRACE(cmake -DRT_ALLOC_TRACE=ON)后替换malloc/calloc/realloc/
+ * posix_memalign等分配函数，线程调用rt_alloc_guard_arm()(热身结束)之后的每一次分配都计入该线程，
+ * 由报告线程定期检查并打印，实时路径上新出现的分配因此会被自动发现。未定义时这些函数为空操作
+ */
+
+#define RT_ALLOC_MAX_THREADS 16  // 可登记分配检查的线程数量
+#define RT_ALLOC_NAME_LEN 32     // 线程名称的最大长度(含结尾0)
+
+/**
+ * @brief 某个线程热身结束后的分配统计
+ */
+typedef struct {
+    char name[RT_ALLOC_NAME_LEN];
+    uint64_t allocs;      // 分配次数
+    uint64_t bytes;       // 分配的总字节数
+    uint64_t exempt;      // RtAllocExempt范围内的分配次数，不算作违规
+    uint32_t last_size;   // 最近一次违规分配的大小
+} RtAllocStats_t;
+
+/**
+ * 锁定内存并预分配堆，在启动实时线程之前调用
+ * mlockall(MCL_CURRENT | MCL_FUTURE | MCL_ONFAULT)：已访问过的页和之后访问的页常驻内存，
+ * 不为CUDA等保留的大块虚拟地址分配物理内存；关闭堆收缩和大块mmap分配，
+ * 所有线程共用主分配区，然后写入heap_prefault字节再释放，之后的分配从这部分已锁定的堆中取得
+ */
+bool rt_memory_lock(size_t heap_prefault);
+
+// 当前线程热身结束，之后的分配计入该线程；线程名取自任务描述，不是由执行器启动时使用name
+void rt_alloc_guard_arm(const char* name = nullptr);
+
+// 当前线程停止分配检查
+void rt_alloc_guard_disarm();
+
+/**
+ * 已知会分配内存的调用范围(如LibTorch推理)，范围内的分配单独计数，不算作违规
+ */
+class RtAllocExempt {
+public:
+    RtAllocExempt();
+    ~RtAllocExempt();
+    RtAllocExempt(const RtAllocExempt&) = delete;
+    RtAllocExempt& operator=(const RtAllocExempt&) = delete;
+};
+
+// 是否编译了分配检查
+bool rt_alloc_trace_enabled();
+
+// 登记过的线程数量
+int rt_alloc_thread_count();
+
+// 读取第index个线程的统计，可在任意线程调用
+bool get_rt_alloc_stats(int index, RtAllocStats_t& out);
+
+// 全部线程的违规分配总数
+uint64_t rt_alloc_total();
+
+/**
+ * 检查自上一次调用以来新出现的违规分配，有则打印线程名、次数和最近一次的大小
+ * 返回新增的次数，由报告线程定期调用
+ */
+uint64_t rt_alloc_check();
+
+// 打印全部线程的分配统计
+void print_rt_alloc_statistics();
+
+#endif // RT_MEMORY_HPP
@@ -0,0 +1,29 @@
+#ifndef RT_UTIL_HPP
+#define RT_UTIL_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+
+/**
+ * 实时线程共用的小工具：统计计数和steady_clock纳秒时间戳
+ */
+
+/**
+ * 单写者计数加n：只有一个线程写，其他线程只读，不需要原子读改写(不产生lock前缀的指令)
+ */
+static inline void bump(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// steady_clock时刻的纳秒数，Linux上即CLOCK_MONOTONIC
+static inline int64_t steady_ns(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+// 当前时刻(steady_clock纳秒)
+static inline int64_t steady_ns() {
+    return steady_ns(std::chrono::steady_clock::now());
+}
+
+#endif // RT_UTIL_HPP
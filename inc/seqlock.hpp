@@ -0,0 +1,104 @@
+#ifndef SEQLOCK_HPP
+#define SEQLOCK_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+// 自旋等待时提示CPU降低功耗并让出流水线
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_RELAX() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define CPU_RELAX() asm volatile("yield" ::: "memory")
+#else
+#define CPU_RELAX() do {} while (0)
+#endif
+
+/**
+ * 顺序锁(seqlock)
+ * 写者不等待读者，读者读到写一半的数据时重读，适合小块状态在实时线程之间交换。
+ * 数据按8字节原子字拷贝，不存在数据竞争；T必须可平凡拷贝
+ */
+template <typename T>
+class alignas(64) SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+
+public:
+    SeqLock() : seq(0) {
+        for (auto& w : words) w.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * 单写者写入，无等待
+     * 同一个实例只能有一个线程调用store()
+     */
+    void store(const T& value) {
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        write_words(value);
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    /**
+     * 多写者写入，通过CAS取得写权后写入
+     * 写者之间会短暂自旋，读者仍然不会阻塞写者
+     */
+    void store_shared(const T& value) {
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        while ((s & 1) || !seq.compare_exchange_weak(s, s + 1, std::memory_order_acquire,
+                                                     std::memory_order_relaxed)) {
+            CPU_RELAX();
+            s = seq.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        write_words(value);
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    // 尝试读取一次，读到完整数据返回true
+    bool try_load(T& value) const {
+        uint32_t s0 = seq.load(std::memory_order_acquire);
+        if (s0 & 1) return false;
+        read_words(value);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return seq.load(std::memory_order_relaxed) == s0;
+    }
+
+    // 读取一份完整数据，与写者冲突时重读
+    T load() const {
+        T value;
+        while (!try_load(value)) {
+            CPU_RELAX();
+        }
+        return value;
+    }
+
+    // 当前写入版本号，每次完整写入加2
+    uint32_t version() const { return seq.load(std::memory_order_acquire); }
+
+private:
+    static const size_t NUM_WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    void write_words(const T& value) {
+        uint64_t buf[NUM_WORDS] = {0};
+        memcpy(buf, &value, sizeof(T));
+        for (size_t i = 0; i < NUM_WORDS; ++i) {
+            words[i].store(buf[i], std::memory_order_relaxed);
+        }
+    }
+
+    void read_words(T& value) const {
+        uint64_t buf[NUM_WORDS];
+        for (size_t i = 0; i < NUM_WORDS; ++i) {
+            buf[i] = words[i].load(std::memory_order_relaxed);
+        }
+        memcpy(&value, buf, sizeof(T));
+    }
+
+    std::atomic<uint32_t> seq;
+    std::atomic<uint64_t> words[NUM_WORDS];
+};
+
+#endif // SEQLOCK_HPP
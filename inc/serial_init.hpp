@@ -4,8 +4,20 @@
 #include <cstdint>
 #include "motor.hpp"
 #include "common.hpp"
+#include "motor_frame_parser.hpp"
+
+// 串口收发统计，用于评估每条命令的系统调用数与唤醒延时
+typedef struct {
+    uint64_t commands;     // 发送的命令数
+    uint64_t syscalls;     // write/ppoll/read/ioctl/tcflush调用总数
+    uint64_t wakeups;      // 等待应答期间因数据到达的唤醒次数
+    int64_t last_wake_ns;  // 最近一次因数据到达唤醒的时刻(steady_clock纳秒)
+} SerialIoStats_t;
 
 int initialize_serial_port(const char* port_name);
 bool configure_serial_port(int fd);
 bool send_command_and_wait(int fd, Motor::ControlData_t& cmd, Motor::RecvData_t& response, int motor_id);
+bool send_command_and_wait(int fd, Motor::ControlData_t& cmd, Motor::RecvData_t& response, int motor_id,
+                           MotorFrameParser& parser, SerialIoStats_t* stats = nullptr,
+                           long timeout_us = COMM_TIMEOUT_MS * 1000L);
 #endif 
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * 单生产者单消费者环形队列
+ * 生产者和消费者都是无等待的：队列满时claim()直接返回空指针，由调用者决定丢弃；
+ * 元素在槽位内原地填写，不需要额外拷贝。N必须是2的幂
+ *
+ * 生产者: T* slot = ring.claim(); if (slot) { ...填写...; ring.publish(); }
+ * 消费者: const T* slot = ring.peek(); if (slot) { ...读取...; ring.release(); }
+ */
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+    SpscRing() : head(0), cached_tail(0), tail(0), cached_head(0) {}
+
+    // 生产者：取得下一个空槽位，队列满时返回nullptr
+    T* claim() {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - cached_tail >= N) {
+            // 缓存的消费进度可能过时，重新读取一次
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h - cached_tail >= N) return nullptr;
+        }
+        return &slots[h & (N - 1)];
+    }
+
+    // 生产者：发布claim()取得的槽位
+    void publish() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // 消费者：查看最早的元素，队列空时返回nullptr
+    const T* peek() {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == cached_head) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t == cached_head) return nullptr;
+        }
+        return &slots[t & (N - 1)];
+    }
+
+    // 消费者：释放peek()取得的元素
+    void release() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // 当前元素数，任意线程调用时只是近似值
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+    // 写一遍全部槽位，使其所在的页在实时线程第一次写入之前已经分配
+    // 只能在生产者和消费者都还没有开始时调用
+    void prefault() {
+        volatile uint8_t* p = (volatile uint8_t*)slots;
+        for (size_t i = 0; i < sizeof(slots); i += 64) p[i] = 0;
+    }
+
+private:
+    // 生产者和消费者各自写的变量放在不同的缓存行，避免伪共享
+    alignas(64) std::atomic<size_t> head;  // 生产者写
+    size_t cached_tail;                    // 生产者私有
+    alignas(64) std::atomic<size_t> tail;  // 消费者写
+    size_t cached_head;                    // 消费者私有
+    alignas(64) T slots[N];
+};
+
+#endif // SPSC_RING_HPP
@@ -0,0 +1,97 @@
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include <stdint.h>
+#include "common.hpp"
+#include "imu.hpp"
+
+/**
+ * 1khz遥测记录
+ * 实时线程每个周期在单生产者环形队列中原地填写一条定长记录，不加锁、不分配内存、不做系统调用；
+ * 队列满时丢弃并计数，永不阻塞实时线程。低优先级的写盘线程批量取出记录，
+ * 以大块顺序写入二进制文件：文件头TelemetryFileHeader_t之后紧跟定长的TelemetryRecord_t
+ */
+
+#define TELEMETRY_MAGIC "RDTELEM"
+#define TELEMETRY_VERSION 3
+
+// 记录标志
+#define TELEMETRY_FLAG_TORQUE_PUBLISHED 0x1  // 本周期发布了tor_cmd
+#define TELEMETRY_FLAG_IMU_UPDATED      0x2  // 本周期读取到了新的IMU数据
+#define TELEMETRY_FLAG_ACTION_UPDATED   0x4  // 本周期取用了新的策略输出
+#define TELEMETRY_FLAG_POLICY_STALE     0x8  // 本周期策略步已错过，目标来自看门狗的保持/衰减
+
+/**
+ * @brief 文件头
+ */
+typedef struct {
+    char magic[8];           // "RDTELEM\0"
+    uint32_t version;        // TELEMETRY_VERSION
+    uint32_t record_size;    // sizeof(TelemetryRecord_t)，读取时据此检查格式
+    uint32_t num_joints;     // NUM_JOINTS
+    uint32_t reserved;
+    int64_t start_steady_ns; // 开始记录时的steady_clock时刻，与记录中的stamp_ns同一时基
+    int64_t start_unix_ns;   // 同一时刻的系统时间，用于对照外部日志
+} TelemetryFileHeader_t;
+
+/**
+ * @brief 一个控制周期的记录
+ * 关节数组全部按电机顺序(通道0电机0、1、2，通道1……)排列，与g_motors[channel][motor]一致，
+ * 数值都是输出端的值
+ */
+typedef struct {
+    int64_t stamp_ns;             // 记录时刻(steady_clock纳秒)
+    int64_t joint_oldest_ns;      // 12个关节反馈中最旧一帧的接收时刻
+    uint32_t seq;                 // 生产者序号，读取时据此发现丢弃的记录
+    uint32_t flags;               // TELEMETRY_FLAG_*
+    int32_t rl_start;             // RL控制状态
+    int32_t rl_protect;           // RL保护标志
+    float pos[NUM_JOINTS];        // 关节位置反馈(rad)
+    float spd[NUM_JOINTS];        // 关节速度反馈(rad/s)
+    float tor[NUM_JOINTS];        // 关节转矩反馈(N·m)
+    float tor_cmd[NUM_JOINTS];    // PD控制输出的转矩命令(N·m)
+    float action[NUM_JOINTS];     // RL网络给出的目标位置(rad)，本周期使用的最近一次策略输出
+    float target[NUM_JOINTS];     // PD控制使用的目标位置(rad)，按目标曲线在两次策略输出之间保持或插值
+    uint32_t policy_seq;          // action对应的策略步序号，0表示还没有策略输出
+    float policy_age_us;          // action的年龄(us)，本周期时刻 - 产生它的观测时刻
+    float cmd[3];                 // 键盘速度指令 cmd_x, cmd_y, cmd_rate
+    float imu_age_us;             // imu中样本的年龄(us)，本周期时刻 - 映射后的采样时刻；0表示未读取
+    IMU::IMUData_t imu;                          // 0x41 外推到本周期时刻的姿态、角速度，四元数为样本原值
+    IMU::IMUData_MSG_BODY_VEL imu_vel;           // 0x60 机体系速度
+    IMU::IMUData_MSG_BODY_ACCELERATION imu_acc;  // 0x62 机体系加速度
+} TelemetryRecord_t;
+
+/**
+ * @brief 遥测统计
+ */
+typedef struct {
+    uint64_t recorded;   // 生产者成功写入队列的记录数
+    uint64_t dropped;    // 队列满时丢弃的记录数
+    uint64_t written;    // 已写入文件的记录数
+    uint64_t bytes;      // 已写入文件的字节数(含文件头)
+    uint32_t queued;     // 当前队列中的记录数
+    bool active;         // 是否正在记录
+} TelemetryStats_t;
+
+// 打开文件并启动写盘线程，失败返回false
+bool telemetry_start(const char* path);
+
+// 停止记录：写完队列中剩余的记录后关闭文件，应在生产者线程退出后调用
+void telemetry_stop();
+
+/**
+ * 生产者：取得一条待填写的记录，未启动记录或队列满时返回nullptr
+ * 只能由一个实时线程调用，填写后必须调用telemetry_commit()
+ */
+TelemetryRecord_t* telemetry_begin();
+
+// 生产者：提交telemetry_begin()取得的记录，填写seq和stamp_ns
+void telemetry_commit(TelemetryRecord_t* rec);
+
+// 读取遥测统计，可在任意线程调用
+TelemetryStats_t get_telemetry_stats();
+
+// 打印遥测统计
+void print_telemetry_statistics();
+
+#endif // TELEMETRY_HPP
@@ -0,0 +1,58 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+
+/**
+ * 三缓冲
+ * 单写者单读者交换最新的一份数据：写者总有一块自己的缓冲，写完后与中间缓冲交换；
+ * 读者发现中间缓冲有新数据时与自己的缓冲交换。双方都只做一次原子交换，既不等待也不重读，
+ * 读者拿到的总是某一次完整写入；读者来不及取走的旧数据被新数据覆盖(只保留最新)。
+ * 与SeqLock相比读者不会因写者正在写入而重试，适合周期不同的两个实时线程
+ */
+template <typename T>
+class TripleBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "TripleBuffer requires a trivially copyable type");
+
+public:
+    TripleBuffer() : middle(1), write_idx(0), read_idx(2) {}
+
+    /**
+     * 写入一份新数据，无等待
+     * 同一个实例只能有一个线程调用store()
+     */
+    void store(const T& value) {
+        slots[write_idx].value = value;
+        uint8_t prev = middle.exchange((uint8_t)(write_idx | FRESH), std::memory_order_acq_rel);
+        write_idx = prev & INDEX_MASK;
+    }
+
+    /**
+     * 有尚未取走的新数据时复制最新的一份并返回true，否则value不变并返回false
+     * 同一个实例只能有一个线程调用load()
+     */
+    bool load(T& value) {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        uint8_t prev = middle.exchange((uint8_t)read_idx, std::memory_order_acq_rel);
+        read_idx = prev & INDEX_MASK;
+        value = slots[read_idx].value;
+        return true;
+    }
+
+private:
+    static const uint8_t INDEX_MASK = 0x3;
+    static const uint8_t FRESH = 0x4;  // 中间缓冲中是读者尚未取走的数据
+
+    // 每块缓冲独占缓存行，写者和读者不会争用同一行
+    struct alignas(64) Slot {
+        T value;
+    };
+    Slot slots[3];
+    alignas(64) std::atomic<uint8_t> middle;  // 中间缓冲的下标和FRESH标志
+    alignas(64) uint8_t write_idx;            // 只由写者访问
+    alignas(64) uint8_t read_idx;             // 只由读者访问
+};
+
+#endif // TRIPLE_BUFFER_HPP
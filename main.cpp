@@ -17,9 +17,14 @@
 #include "inc/algorithm_control.hpp"
 #include "inc/motor_protect.hpp"
 #include "inc/imu.hpp"
+#include "inc/motor_reactor.hpp"
+#include "inc/joint_bus.hpp"
+#include "inc/motor_metrics.hpp"
+#include "inc/telemetry.hpp"
+#include "inc/rt_executor.hpp"
+#include "inc/rt_memory.hpp"
 
 // 函数声明
-void print_statistics();
 pthread_t get_pthread_id(std::thread& t);
 
 // 定义全局控制参数
@@ -29,14 +34,15 @@ float g_pos_des = 0.0f;  // 目标位置
 float g_k_pos = 0.0f;    // 位置增益
 float g_k_spd = 0.0f;    // 速度增益
 
+// 目标位置按网络顺序 FL, FR, RL, RR 排列，与关节总线一致
 float _targetPos_1[12] = {0.0, 1.36, -2.65, 0.0, 1.36, -2.65,
-                            -0.2, 1.36, -2.65, 0.2, 1.36, -2.65};
+                            0.2, 1.36, -2.65, -0.2, 1.36, -2.65};
 
-float _targetPos_2[12] = {-0.1, 0.8 , -1.5, 0.1 , 0.8 , -1.5, 
-                            -0.1,1.0,-1.5, 0.1, 1.0, -1.5};
+float _targetPos_2[12] = {0.1, 0.8 , -1.5, -0.1 , 0.8 , -1.5, 
+                            0.1,1.0,-1.5, -0.1, 1.0, -1.5};
 
-float _targetPos_3[12] = {-0.35, 1.36, -2.65, 0.35, 1.36, -2.65,
-                            -0.5, 1.36, -2.65, 0.5, 1.36, -2.65};
+float _targetPos_3[12] = {0.35, 1.36, -2.65, -0.35, 1.36, -2.65,
+                            0.5, 1.36, -2.65, -0.5, 1.36, -2.65};
 
 float _startPos[12];
 
@@ -56,11 +62,15 @@ float _percent_error = 0; //电机错误状态
 
 int main(int argc, char* argv[]) {
     // 检查命令行参数
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <mode>\n";
+    if (argc < 2 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " <mode> [thread|reactor] [telemetry.bin]\n";
         std::cerr << "Modes: stop, tor, speed\n";
         return 1;
     }
+    // 总线调度方式：thread为每个通道一个线程，reactor为单线程epoll管理全部通道
+    bool use_reactor = (argc >= 3 && strcmp(argv[2], "reactor") == 0);
+    // 给出文件名时记录每个1khz控制周期的关节、命令和IMU数据
+    const char* telemetry_path = argc == 4 ? argv[3] : nullptr;
     std::cout << "Starting motor control in mode: " << argv[1] << std::endl;
     // 根据命令行参数设置控制模式
     if (strcmp(argv[1], "stop") == 0) {
@@ -91,12 +101,7 @@ int main(int argc, char* argv[]) {
         g_spd_des = 0.0f;
         g_k_pos = 60.0f;
         g_k_spd = 5.0f;
-        for (int i = 0; i < NUM_CHANNELS; ++i) {
-            for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
-                // 更新电机控制参数，考虑减速比
-                g_motors[i][j].Motor_SetControlParams(i, j, 0, 0, 0, 0, 0);//上电后先让电机处于停止状态
-            }
-        }
+        joint_bus_publish_uniform(0, 0, 0, 0, 0);//上电后先让电机处于停止状态
     } 
     else {
         std::cerr << "Invalid mode. Use 'stop', 'tor', or 'speed'.\n";
@@ -104,105 +109,84 @@ int main(int argc, char* argv[]) {
     }
 
     imu.serial_init("/dev/ttyACM0"); // 初始化IMU串口
+#if IMU_CONFIGURE_OUTPUTS
+    // 只推送控制需要的数据包，失败时设备保持原来的配置，读取线程照常解析
+    static const uint8_t imu_outputs[] = {0x41, 0x60, 0x62};
+    if (!imu.configure_outputs(imu_outputs, sizeof(imu_outputs), IMU_OUTPUT_RATE_HZ)) {
+        std::cerr << "IMU output configuration failed, using the current device settings" << std::endl;
+    }
+#endif
+
+    // 策略在总线和控制线程启动之前初始化：有扁平权重文件时只需映射，没有时TorchScript的秒级加载
+    // 也不会发生在电机已经上电通信之后
+    rl_rotdog.init_policy();
+
+#if RT_LOCK_MEMORY
+    // 锁定内存并预分配堆，之后启动的线程由执行器预先写入栈
+    rt_memory_lock(RT_HEAP_PREFAULT);
+#endif
 
+    if (telemetry_path != nullptr) {
+        telemetry_start(telemetry_path);
+    }
+
+    /*
+    线程与核心的分配：
+    核心 0：总线线程(通道线程或反应器)，实时性要求最高；
+    核心 1：IMU读取线程、算法控制线程(1khz)和策略推理线程(50hz)，IMU读取线程大部分时间阻塞在串口上，
+            控制线程优先级高于推理线程，推理时可被其抢占；
+    其余核心：留给操作系统、键盘、统计报告和遥测写盘等非关键任务。
+    */
+    static const char* channel_names[NUM_CHANNELS] = {"channel0", "channel1", "channel2", "channel3"};
     std::vector<std::thread> threads;
+    // 反应器模式：一个线程管理全部通道
+    if (use_reactor) {
+        RtTaskSpec_t spec = {"motor_reactor", 1000, RT_PRIO_BUS, 0, RT_CPU(0), RT_STACK_PREFAULT, 0, OverrunPolicy::SKIP};
+        threads.push_back(rt_spawn(spec, motor_reactor_thread));
+    }
     // 为每个通道创建线程
-    for (int i = 0; i < NUM_CHANNELS; ++i) {
-        threads.emplace_back([i]() {
-            // 获取当前线程ID
-            pthread_t thread_id = pthread_self();
-
-            // 设置线程优先级
-            struct sched_param param;//声明线程调度结构体
-            param.sched_priority = sched_get_priority_max(SCHED_FIFO);//获取该策略最高优先级
-            if (pthread_setschedparam(thread_id, SCHED_FIFO, &param) != 0) {//给指定ID线程设置调度策略和优先级
-                // 如果设置失败，输出错误信息
-                std::cerr << "Failed to set thread priority for channel " << i << std::endl;
-            }
-
-            // 设置线程的 CPU 亲和性（分配到核心 0），哪个位置1表示线程可以在哪个核心上运行
-            cpu_set_t cpuset;
-            CPU_ZERO(&cpuset);// 初始化 CPU 集合
-            CPU_SET(0, &cpuset); // 核心 0（这个线程只在核心 0 上运行）
-            if (pthread_setaffinity_np(thread_id, sizeof(cpu_set_t), &cpuset) != 0) {//将线程绑定到指定的 CPU 集合
-                // 如果设置失败，输出错误信息
-                std::cerr << "Failed to set CPU affinity for channel " << i << std::endl;
-            }
-            //为什么这么写？
-            /*
-            假设系统有 4 个 CPU 核心（0~3），可以这样分配：
-            核心 0：专用通道控制线程（实时性要求极高）；
-            核心 1：算法控制线程（计算密集型）；
-            核心 2~3：留给操作系统和其他非关键任务；
-            
-            这种分配方式可以确保通道控制线程在核心 0 上运行，避免与其他线程竞争 CPU 时间，从而提高实时性和响应速度。
-            另外，算法控制线程在核心 1 上运行，可以充分利用多核 CPU 的计算能力，同时避免与通道控制线程的实时性冲突。
-            这种设计可以提高系统的整体性能和响应速度，特别是在需要高实时性和低延迟的应用场景中。
-            例如，在机器人控制系统中，通道控制线程需要实时处理传感器数据并控制电机，而算法控制线程需要进行复杂的计算和决策。通过将它们分配到不同的核心，可以确保系统在处理实时任务时不会受到计算密集型任务的干扰。
-            这种设计可以提高系统的整体性能和响应速度，特别是在需要高实时性和低延迟的应用场景中。
-            */
-
-            // 通道线程函数
-            channel_thread(i);
-        });
+    for (int i = 0; i < NUM_CHANNELS && !use_reactor; ++i) {
+        RtTaskSpec_t spec = {channel_names[i], 1000, RT_PRIO_BUS, 0, RT_CPU(0), RT_STACK_PREFAULT, 0, OverrunPolicy::SKIP};
+        threads.push_back(rt_spawn(spec, [i]() { channel_thread(i); }));
     }
 
-    // 初始化底层算法控制线程
-    threads.emplace_back([]() {
-        // 获取当前线程ID
-        pthread_t thread_id = pthread_self();
-
-        // 设置线程优先级
-        struct sched_param param;
-        param.sched_priority = sched_get_priority_max(SCHED_FIFO);
-        if (pthread_setschedparam(thread_id, SCHED_FIFO, &param) != 0) {
-            std::cerr << "Failed to set thread priority for algorithm control thread." << std::endl;
-        }
-
-        // 设置线程的 CPU 亲和性（分配到核心 1）
-        cpu_set_t cpuset;
-        CPU_ZERO(&cpuset);
-        CPU_SET(1, &cpuset); // 核心 1
-        if (pthread_setaffinity_np(thread_id, sizeof(cpu_set_t), &cpuset) != 0) {
-            std::cerr << "Failed to set CPU affinity for algorithm control thread." << std::endl;
-        }
-
-        // 调用算法控制线程的功能性内容
-        algorithm_control_thread();
-    });
-
-    // 初始化底层算法控制线程
-    threads.emplace_back([]() {
-        // 获取当前线程ID
-        pthread_t thread_id = pthread_self();
-
-        // 设置线程优先级
-        struct sched_param param;
-        param.sched_priority = sched_get_priority_max(SCHED_FIFO);
-        if (pthread_setschedparam(thread_id, SCHED_FIFO, &param) != 0) {
-            std::cerr << "Failed to set thread priority for algorithm control thread." << std::endl;
-        }
-
-        // 设置线程的 CPU 亲和性（分配到核心 1）
-        cpu_set_t cpuset;
-        CPU_ZERO(&cpuset);
-        CPU_SET(1, &cpuset); // 核心 1
-        if (pthread_setaffinity_np(thread_id, sizeof(cpu_set_t), &cpuset) != 0) {
-            std::cerr << "Failed to set CPU affinity for algorithm control thread." << std::endl;
-        }
-
-        // 调用算法控制线程的功能性内容
-        rl_run();
-    });    
+    // IMU读取线程，解析设备推送的每一帧并发布最新数据
+    RtTaskSpec_t imu_spec = {"imu_reader", 0, RT_PRIO_IMU, 0, RT_CPU(1), RT_STACK_PREFAULT, 0, OverrunPolicy::SKIP};
+    threads.push_back(rt_spawn(imu_spec, imu_reader_thread));
+
+    // 底层算法控制线程
+    RtTaskSpec_t control_spec = {"algorithm_control", 1000, RT_PRIO_CONTROL, 0, RT_CPU(1), RT_STACK_PREFAULT,
+                                 RT_CONTROL_SPIN_US, OverrunPolicy::SKIP};
+    threads.push_back(rt_spawn(control_spec, algorithm_control_thread));
+
+    // 策略推理线程
+    RtTaskSpec_t policy_spec = {"rl_run", POLICY_PERIOD_MS * 1000, RT_PRIO_POLICY, 0, RT_CPU(1), RT_STACK_PREFAULT, 0, OverrunPolicy::REPHASE};
+    threads.push_back(rt_spawn(policy_spec, rl_run));
 
     // 键盘监听线程
-    threads.emplace_back(keyboard_thread);
-    
+    RtTaskSpec_t keyboard_spec = {"keyboard", 0, 0, 0, 0, 0, 0, OverrunPolicy::SKIP};
+    threads.push_back(rt_spawn(keyboard_spec, keyboard_thread));
+
+    // 总线时延报告线程，普通优先级，不绑定核心
+    RtTaskSpec_t reporter_spec = {"metrics_reporter", 0, 0, 10, 0, 0, 0, OverrunPolicy::SKIP};
+    threads.push_back(rt_spawn(reporter_spec, []() { motor_metrics_reporter_thread(METRICS_REPORT_PERIOD_MS, nullptr); }));
+
+    print_rt_task_report();
     std::cout << "All channel threads started." << std::endl;
     std::this_thread::sleep_for(std::chrono::seconds(2));//等待通道线程串口的打开
 
     // 主循环
     int16_t tick_tick = 0; // 用于计时的变量
+    JointBusState_t state;   // 12个关节的状态快照
+    JointBusCommand_t cmd;   // 12个关节的命令，按网络顺序
+    // 除目标位置外，其余控制参数使用启动模式设置的全局值
+    auto standup_command = [&cmd](int k, float pos_des) {
+        cmd.tor[k] = g_tor_des;
+        cmd.spd[k] = g_spd_des;
+        cmd.pos[k] = pos_des;
+        cmd.k_pos[k] = g_k_pos;
+        cmd.k_spd[k] = g_k_spd;
+    };
     while (g_running) 
     {
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -216,12 +200,11 @@ int main(int argc, char* argv[]) {
             {
                 _percent_0 += (float)1 / _duration_0;
                 _percent_0 = _percent_0 > 1 ? 1 : _percent_0;
-                for (int i = 0; i < NUM_CHANNELS; ++i) {
-                    for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
-                        // 获取电机的当前位置
-                        g_motors[i][j].Motor_SetControlParams(i, j, 0, 0, 0, 0, 0);
-                        _startPos[i * MOTORS_PER_CHANNEL + j] = g_motors[i][j].getPosition(i,j);
-                    }
+                // 获取电机的当前位置
+                joint_bus_publish_uniform(0, 0, 0, 0, 0);
+                joint_bus_read_state(state);
+                for (int k = 0; k < NUM_JOINTS; ++k) {
+                    _startPos[k] = state.pos[k];
                 }
             }
             // 状态0 -> 状态1 进入目标位置1
@@ -229,41 +212,33 @@ int main(int argc, char* argv[]) {
             {
                 _percent_1 += (float)1 / _duration_1;
                 _percent_1 = _percent_1 > 1 ? 1 : _percent_1;
-                for (int i = 0; i < NUM_CHANNELS; ++i) {
-                    for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
-                        // 更新电机控制参数，考虑减速比
-                        g_pos_des = (1 - _percent_1) * _startPos[i * MOTORS_PER_CHANNEL + j] + _percent_1 * _targetPos_1[i * MOTORS_PER_CHANNEL + j];  // 使用预定义的目标位置
-                        g_motors[i][j].Motor_SetControlParams(i, j, g_tor_des, g_spd_des, g_pos_des, g_k_pos, g_k_spd);
-                    }
+                for (int k = 0; k < NUM_JOINTS; ++k) {
+                    // 更新电机控制参数，减速比由关节总线换算
+                    standup_command(k, (1 - _percent_1) * _startPos[k] + _percent_1 * _targetPos_1[k]);  // 使用预定义的目标位置
                 }
+                joint_bus_publish(cmd);
             }
             // 状态1 -> 状态2 起立
             if ((_percent_1 == 1)&&(_percent_2 < 1))
             {
                 _percent_2 += (float)1 / _duration_2;
                 _percent_2 = _percent_2 > 1 ? 1 : _percent_2;
-                for (int i = 0; i < NUM_CHANNELS; ++i) {
-                    for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
-                        // 更新电机控制参数，考虑减速比
-                        g_pos_des = (1 - _percent_2) * _targetPos_1[i * MOTORS_PER_CHANNEL + j] + _percent_2 * _targetPos_2[i * MOTORS_PER_CHANNEL + j];  // 使用预定义的目标位置
-                        
-                        g_motors[i][j].Motor_SetControlParams(i, j, g_tor_des, g_spd_des, g_pos_des, g_k_pos, g_k_spd);
-                    }
-                }                
+                for (int k = 0; k < NUM_JOINTS; ++k) {
+                    // 更新电机控制参数，减速比由关节总线换算
+                    standup_command(k, (1 - _percent_2) * _targetPos_1[k] + _percent_2 * _targetPos_2[k]);  // 使用预定义的目标位置
+                }
+                joint_bus_publish(cmd);                
             }
             // 状态2 -> 状态3 维持机身
             if ((_percent_1 == 1)&&(_percent_2 == 1)&&(_percent_3<1))
             {
                 _percent_3 += (float)1 / _duration_3;
                 _percent_3 = _percent_3 > 1 ? 1 : _percent_3;
-                for (int i = 0; i < NUM_CHANNELS; ++i) {
-                    for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
-                        // 更新电机控制参数，考虑减速比
-                        g_pos_des = _targetPos_2[i * MOTORS_PER_CHANNEL + j];  // 使用预定义的目标位置
-                        
-                        g_motors[i][j].Motor_SetControlParams(i, j, g_tor_des, g_spd_des, g_pos_des, g_k_pos, g_k_spd);
-                    }
-                }                    
+                for (int k = 0; k < NUM_JOINTS; ++k) {
+                    // 更新电机控制参数，减速比由关节总线换算
+                    standup_command(k, _targetPos_2[k]);  // 使用预定义的目标位置
+                }
+                joint_bus_publish(cmd);                    
             }
 
             if(_percent_3 == 1)
@@ -337,8 +312,7 @@ int main(int argc, char* argv[]) {
         //         }
         //     }
 
-        //     //打印统计信息
-        //     print_statistics();
+        //     // 统计信息由motor_metrics_reporter_thread()定期打印
         // }
     }
 
@@ -347,37 +321,13 @@ int main(int argc, char* argv[]) {
     for (auto& thread : threads) {
         thread.join();  // 等待所有线程结束
     }
+    telemetry_stop();  // 写完剩余的遥测记录
+    print_rt_alloc_statistics();
 
     return 0;
 }
 
 
-/**
- * 打印统计信息
- */
-void print_statistics() {
-    std::lock_guard<std::mutex> lock(g_motor_mutex);
-
-    std::cout << "Channel | Motor | Sent | Received | Lost | Loss Rate | Errors\n";
-    std::cout << "--------|-------|------|----------|------|-----------|-------\n";
-
-    for (int i = 0; i < NUM_CHANNELS; ++i) {
-        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
-            uint64_t sent = g_motors[i][j].getSendCount();
-            uint64_t received = g_motors[i][j].getReceiveCount();
-            uint64_t errors = 0;
-            int64_t lost = (sent > received) ? sent - received : 0;
-            double loss_rate = (sent > 0) ? (double)lost / sent * 100 : 0;
-
-            printf("%7d | %5d | %4lu | %8lu | %4ld | %9.2f%% | %5lu\n",
-                   i, j, sent, received, lost, loss_rate, errors);
-
-            g_motors[i][j].resetStats();
-        }
-    }
-    std::cout << std::endl;
-}
-
 // 辅助函数，用于将std::thread转换为pthread_t
 pthread_t get_pthread_id(std::thread& t) {
     pthread_t native_handle;
@@ -4,8 +4,14 @@
 #include <thread>
 #include <atomic>
 #include "imu.hpp"
+#include "joint_bus.hpp"
+#include "periodic_loop.hpp"
+#include "telemetry.hpp"
+#include "rt_memory.hpp"
+#include "rt_util.hpp"
 #include <iomanip> // 用于设置浮点数显示格式
 #include <valarray>
+#include <cstring>
 
 using namespace torch::indexing;
 using namespace std;
@@ -20,7 +26,6 @@ float q[12];
 float q_dot[12];
 float tau[12];
 RL_ROTDOG rl_rotdog;
-int net2motor[4] = {1, 0, 3, 2}; // 电机i对应网络输出的腿下标
 
 int rl_start = 0; // RL控制开始标志
 int rl_protect = 0; // RL保护标志
@@ -40,251 +45,428 @@ float RL_ROTDOG::pd_control(float target_q, float curr_q, float target_qd, float
 
 void RL_ROTDOG::handleMessage()
 {
-    std::vector<float> obs; // 45个观测
+    // 关节状态快照的时刻即本次观测的时刻
+    JointBusState_t state;
+    joint_bus_read_state(state);
+
+    // IMU外推到观测时刻，与关节数据对齐，只使用顺序锁发布的样本；imu.imu_data由控制线程每个节拍改写，
+    // 只在读取线程未运行(离线回放，没有并发写者)时使用
+    IMU::IMUData_t imu_obs;
+    IMU::ImuSample_t imu_sample;
+    if (imu.read_latest(imu_sample)) {
+        imu_age_record(IMU_AGE_POLICY, imu_extrapolate(imu_sample, state.stamp_ns, imu_obs));
+    } else {
+        imu_obs = imu.imu_data;
+    }
+
+    int n = 0; // 45个观测，写入预先分配的obs
     float imu_out;//用来存放归一化后的航向角
-    obs.push_back(imu.imu_data.RollSpeed * omega_scale); // 绕x轴的角速度
-    obs.push_back(imu.imu_data.aPitchSpeedcc_y * omega_scale); // 绕y轴的角速度
-    obs.push_back(-imu.imu_data.HeadingSpeed * omega_scale); // 绕z轴的角速度
+    obs[n++] = imu_obs.RollSpeed * omega_scale; // 绕x轴的角速度
+    obs[n++] = imu_obs.aPitchSpeedcc_y * omega_scale; // 绕y轴的角速度
+    obs[n++] = -imu_obs.HeadingSpeed * omega_scale; // 绕z轴的角速度
 
     //需要先将角度归一化到[-pi, pi]范围内
-    if (imu.imu_data.Heading > M_PI) {
-        imu_out = imu.imu_data.Heading - 2 * M_PI;
-    } else if (imu.imu_data.Heading < -M_PI) {
-        imu_out = imu.imu_data.Heading + 2 * M_PI;
+    if (imu_obs.Heading > M_PI) {
+        imu_out = imu_obs.Heading - 2 * M_PI;
+    } else if (imu_obs.Heading < -M_PI) {
+        imu_out = imu_obs.Heading + 2 * M_PI;
     } else {
-        imu_out = imu.imu_data.Heading;
-    }
-    obs.push_back(imu.imu_data.Roll * eu_ang_scale); // 绕x轴的角度
-    obs.push_back(imu.imu_data.Pitch * eu_ang_scale); // 绕y轴的角度
-    obs.push_back(-imu_out * eu_ang_scale); // 绕z轴的角度
-
-    obs.push_back(cmd_x * lin_vel); // 期望的x轴角速度
-    obs.push_back(cmd_y * lin_vel); // 期望的y轴角速度
-    obs.push_back(cmd_rate * ang_vel); // 期望的z轴角速度
-
-    // 关节位置观测（按网络顺序 FL, FR, RL, RR）
-    for(int i=0; i<NUM_CHANNELS; i++) {
-        int net_leg = net2motor[i];
-        for(int j=0; j<MOTORS_PER_CHANNEL; j++) {
-            float pos = g_motors[i][j].getPosition(i, j);
-            int idx = net_leg * MOTORS_PER_CHANNEL + j;
-            curr_pos[idx] = pos; // 更新当前关节位置
-        }
+        imu_out = imu_obs.Heading;
     }
+    obs[n++] = imu_obs.Roll * eu_ang_scale; // 绕x轴的角度
+    obs[n++] = imu_obs.Pitch * eu_ang_scale; // 绕y轴的角度
+    obs[n++] = -imu_out * eu_ang_scale; // 绕z轴的角度
+
+    obs[n++] = cmd_x * lin_vel; // 期望的x轴角速度
+    obs[n++] = cmd_y * lin_vel; // 期望的y轴角速度
+    obs[n++] = cmd_rate * ang_vel; // 期望的z轴角速度
 
+    // 关节位置、速度观测（关节总线已按网络顺序 FL, FR, RL, RR 排列）
     for(int i=0; i<12; i++) {
-        float pos_actor = (curr_pos[i] - init_pos[i]) * pos_scale; // 归一化关节位置
-        obs.push_back(pos_actor); // 归一化关节位置
+        curr_pos[i] = state.pos[i]; // 更新当前关节位置
+        curr_vel[i] = state.spd[i]; // 更新当前关节速度
     }
 
-    // 关节速度观测（按网络顺序 FL, FR, RL, RR）
-    for(int i=0; i<NUM_CHANNELS; i++) {
-        int net_leg = net2motor[i];
-        for(int j=0; j<MOTORS_PER_CHANNEL; j++) {
-            float vel = g_motors[i][j].getSpeed(i, j);
-            int idx = net_leg * MOTORS_PER_CHANNEL + j;
-            curr_vel[idx] = vel; // 更新当前关节速度
-        }
+    for(int i=0; i<12; i++) {
+        obs[n++] = (curr_pos[i] - init_pos[i]) * pos_scale; // 归一化关节位置
     }
 
     for(int idx=0; idx<12; idx++) {
-        float vel_actor = curr_vel[idx] * vel_scale; // 归一化关节速度
-        obs.push_back(vel_actor); // 归一化关节速度
+        obs[n++] = curr_vel[idx] * vel_scale; // 归一化关节速度
     }
 
     for(int i=0; i<12; i++) {
-        obs.push_back(action_temp[i]); // 动作
+        obs[n++] = action_temp[i]; // 动作
     }
     // std::cout << "obs: ";
-    // for (size_t i = 0; i < obs.size(); ++i) {
+    // for (int i = 0; i < n; ++i) {
     //     std::cout << std::fixed << std::setprecision(4) << obs[i] << " ";
     // }
     // std::cout << std::endl;
 
-    auto options = torch::TensorOptions().dtype(torch::kFloat32);
-    torch::Tensor obs_tensor = torch::from_blob(obs.data(), {1, 45},options).to(device);
-
-    auto obs_buf_batch = this->obs_buf.unsqueeze(0);
+    // 观测有NaN时不推理，也不写入历史；本步记为拒绝，控制线程按看门狗的设定处理缺失的动作
+    for (int i = 0; i < n; ++i) {
+        if (std::isnan(obs[i])) {
+            if (policy_action_reject(POLICY_REJECT_NAN_OBS) == 1) {
+                std::cerr << "Warning: NaN detected in observation data, policy step skipped." << std::endl;
+            }
+            return;
+        }
+    }
 
-    std::vector<torch::jit::IValue> inputs;
-    inputs.push_back(obs_tensor.to(torch::kHalf));
-    inputs.push_back(obs_buf_batch.to(torch::kHalf));
+    // obs写在obs_cpu的存储里，经device上的float暂存转为网络输入(同设备转换，不分配临时张量)；
+    // CPU fp32时三者是同一块存储，观测直接写入网络输入
+    c10::InferenceMode inference_guard; // 不记录autograd元数据和版本计数
+    if (obs_stage.data_ptr() != obs_cpu.data_ptr()) obs_stage.copy_(obs_cpu, /*non_blocking=*/true);
+    if (obs_in.data_ptr() != obs_stage.data_ptr()) obs_in.copy_(obs_stage);
 
     //----------网络推理----------
-    torch::Tensor action_tensor = model.forward(inputs).toTensor();
+    torch::Tensor action_tensor = forward_step();
 
-    action_buf = torch::cat( {action_buf.index({ Slice(1, None),Slice()}),action_tensor} , 0 );
-
-    bool has_nan = false;
-    for (float val : obs) {
-        if (std::isnan(val)) {
-            has_nan = true;
-            break;
-        }
+    const float* action_raw;
+    if (native_active()) {
+        action_raw = action_native.data_ptr<float>();
+    } else {
+        // move to cpu
+        action_stage.copy_(action_tensor);
+        if (action_cpu.data_ptr() != action_stage.data_ptr()) action_cpu.copy_(action_stage);
+        action_raw = action_cpu.data_ptr<float>();
     }
-    if (has_nan) {
-        std::cerr << "Warning: NaN detected in observation data." << std::endl;
-        getchar();
+    // 输出不是有限值或超过预算时丢弃本步：不发布，也不写入历史和滤波状态，下一步仍以最后的好动作为输入
+    if (!policy_step_accept(action_raw, state.stamp_ns, (int64_t)deadline_ms * 1000000)) return;
+
+    // 最旧的一行被本周期的观测和动作覆盖，head后移一行，历史仍按时间顺序排列
+    if (native_active()) {
+        // 历史和输出都是CPU上的float，直接拷贝，不经过LibTorch
+        float* obs_rows = obs_ring.data_ptr<float>();
+        float* action_rows = action_ring.data_ptr<float>();
+        memcpy(obs_rows + ring_head * 45, obs, 45 * sizeof(float));
+        memcpy(obs_rows + (ring_head + history_length) * 45, obs, 45 * sizeof(float));
+        memcpy(action_rows + ring_head * 12, action_raw, 12 * sizeof(float));
+        memcpy(action_rows + (ring_head + history_length) * 12, action_raw, 12 * sizeof(float));
+    } else {
+        obs_ring_rows[ring_head].copy_(obs_in);
+        obs_ring_rows[ring_head + history_length].copy_(obs_in);
+        action_ring_rows[ring_head].copy_(action_tensor);
+        action_ring_rows[ring_head + history_length].copy_(action_tensor);
     }
-    //-----------------------------网络输出滤波--------------------------------
-    torch::Tensor action_blend_tensor = 0.8*action_tensor + 0.2*last_action;
-    last_action = action_tensor.clone();
- 
-    this->obs_buf = torch::cat({this->obs_buf.index({Slice(1, None), Slice()}), obs_tensor}, 0); // 历史观测移位
-    // //----------------------------------------------------------------
-    torch::Tensor action_raw = action_blend_tensor.squeeze(0);
-    // move to cpu
-    action_raw = action_raw.to(torch::kFloat32);
-    action_raw = action_raw.to(torch::kCPU);
-    // // assess the result
-    auto action_getter = action_raw.accessor <float,1>();
+    ring_head = (ring_head + 1) % history_length;
+
     for (int j = 0; j < 12; j++)
     {
-        float action_flt = action_getter[j];
+        //-----------------------------网络输出滤波--------------------------------
+        float action_flt = 0.8f * action_raw[j] + 0.2f * last_action[j];
+        last_action[j] = action_raw[j];
         new_target = action_flt * action_scale[j] + init_pos[j];
 
         action[j] = new_target; // 更新目标位置
-        action_temp[j] = action_getter[j];//网络的最后一个维度的输入
+        action_temp[j] = action_flt;//网络的最后一个维度的输入
     }
+    // 交给1khz控制线程，带上观测时刻用于统计端到端时延
+    policy_action_publish(action.data(), state.stamp_ns);
      
 }
 
+torch::Tensor RL_ROTDOG::forward_step()
+{
+    if (native_active()) {
+        // 编码器使用历史中最近的hist_rows行，在环形缓冲中连续
+        const float* hist = obs_ring.data_ptr<float>() + (ring_head + history_length - native.dims().hist_rows) * 45;
+        native.forward(hist, obs_in.data_ptr<float>(), action_native.data_ptr<float>());
+        return action_native;
+    }
+    c10::InferenceMode inference_guard;
+    RtAllocExempt exempt; // TorchScript解释器和输出张量的分配
+    if (static_model) {
+        return (*static_model)(ring_inputs[ring_head]).toTensor();
+    }
+    return model.forward(ring_inputs[ring_head]).toTensor();
+}
+
 void RL_ROTDOG::load_policy()
 {   
     std::cout << model_path << std::endl;
     // load model from check point
     std::cout << "cuda::is_available():" << torch::cuda::is_available() << std::endl;
+    std::cout << "cudnn_is_available:" << torch::cuda::cudnn_is_available() << std::endl;
     device= torch::kCPU;
-    if (torch::cuda::is_available()&&1){
+    if (torch::cuda::is_available()&&use_cuda){
         device = torch::kCUDA;
     }
+    // x86上fp16没有硬件支持，只在CUDA上使用
+    dtype = (device == torch::kCUDA || cpu_mode == POLICY_CPU_HALF) ? torch::kHalf : torch::kFloat32;
     std::cout<<"device:"<<device<<endl;
+    if (device == torch::kCPU) {
+        // 线程数固定，推理耗时不随负载下的线程池调度变化；inter-op线程池只能设置一次
+        at::set_num_threads(cpu_threads);
+        try {
+            at::set_num_interop_threads(1);
+        } catch (const c10::Error&) {
+        }
+        std::cout << "CPU inference threads: " << at::get_num_threads() << std::endl;
+    }
     model = torch::jit::load(model_path);
     std::cout << "load model is successed!" << std::endl;
     model.to(device);
     std::cout << "LibTorch Version: " << TORCH_VERSION_MAJOR << "." 
               << TORCH_VERSION_MINOR << "." 
               << TORCH_VERSION_PATCH << std::endl;
-    model.to(torch::kHalf);
+    model.to(dtype);
     std::cout << "load model to device!" << std::endl;
     model.eval();
-}
- 
-void RL_ROTDOG::init_policy(){
- // load policy
-    std::cout << "RL model thread start"<<endl;
-    cout <<"cuda_is_available:"<< torch::cuda::is_available() << endl;
-    cout <<"cudnn_is_available:"<< torch::cuda::cudnn_is_available() << endl;
-    
-    model_path = "/home/zhu/Desktop/ROBOT_DOG/pre_train/model_jitt.pt";//载入jit模型
-    load_policy();
 
- // initialize record
-    action_buf = torch::zeros({history_length,12},device);
-    this->obs_buf = torch::zeros({history_length,45}, device);//历史观测
-    last_action = torch::zeros({1,12},device);
+    static_model.reset();
+    if (native_active() && !load_native()) {
+        std::cerr << "Native policy executor unavailable, falling back to frozen TorchScript" << std::endl;
+        cpu_mode = POLICY_CPU_FROZEN;
+    }
+    if (device == torch::kCPU && (cpu_mode == POLICY_CPU_FROZEN || cpu_mode == POLICY_CPU_STATIC)) {
+        // 参数折叠为常量，删除训练用的分支和未使用的属性(bn)，再做推理专用的图优化
+        model = torch::jit::freeze(model);
+        if (cpu_mode == POLICY_CPU_FROZEN) {
+            model = torch::jit::optimize_for_inference(model);
+        } else {
+            static_model.reset(new torch::jit::StaticModule(model, /*is_frozen=*/true));
+        }
+    }
+    static const char* mode_names[] = {"fp16 jit", "fp32 jit", "fp32 frozen", "fp32 static runtime", "fp32 native"};
+    std::cout << "policy mode: " << (device == torch::kCUDA ? "cuda fp16" : mode_names[cpu_mode]);
+    if (native_active()) std::cout << " (" << PolicyMlp::isa_name(native.isa()) << ")";
+    std::cout << std::endl;
+}
 
-    action_buf = action_buf.to(torch::kHalf);
-    this->obs_buf = this->obs_buf.to(torch::kHalf);
-    last_action = last_action.to(torch::kHalf);
+/**
+ * 扁平权重文件只读映射后直接使用，不经过TorchScript反序列化、CUDA初始化和图优化。
+ * 文件由policy_export导出，网络结构已在导出时检查过；这里核对文件头记录的来源指纹与model_path一致
+ * (模型重新训练或替换后旧的导出文件不再使用)，以及与观测和历史的维数
+ */
+bool RL_ROTDOG::map_flat()
+{
+    if (flat_path.empty() || access(flat_path.c_str(), R_OK) != 0) return false;
+    auto t0 = std::chrono::steady_clock::now();
+    if (!native.map(flat_path.c_str())) {
+        std::cerr << "Flat policy " << flat_path << " rejected, loading " << model_path << std::endl;
+        return false;
+    }
+    PolicySourceId_t source;
+    if (!policy_source_id(model_path.c_str(), source)) {
+        std::cerr << "Cannot fingerprint " << model_path << ", using flat policy " << flat_path << " unchecked" << std::endl;
+    } else if (source.size != native.source().size || source.crc != native.source().crc) {
+        std::cerr << "Flat policy " << flat_path << " was not exported from " << model_path << ", loading TorchScript; "
+                  << "run policy_export " << model_path << " " << flat_path << " to re-export" << std::endl;
+        return false;
+    }
+    const PolicyMlpDims_t& d = native.dims();
+    if (d.obs_dim != 45 || d.action_dim != 12 || (int)d.hist_rows > history_length - 1) {
+        std::cerr << "Flat policy " << flat_path << " does not match the observation layout, loading " << model_path
+                  << std::endl;
+        return false;
+    }
+    device = torch::kCPU;
+    dtype = torch::kFloat32;
+    cpu_mode = POLICY_CPU_NATIVE;
+    static_model.reset();
+    auto dt = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "policy mode: fp32 native (" << PolicyMlp::isa_name(native.isa()) << "), mapped " << flat_path
+              << " (" << d.arena_floats * sizeof(float) / 1024 << " KB) in " << dt / 1000.0 << " ms" << std::endl;
+    return true;
+}
 
-    for (int j = 0; j < 12; j++)
-    {
-        action_temp.push_back(0.0);
-	    action.push_back(init_pos[j]);
-        prev_action.push_back(init_pos[j]);
+/**
+ * 按MixedMlpBarlowTwinsActor.forward()的结构提取：
+ *   mlp_encoder、actor.gate为Sequential，子模块依次为Linear/ELU/LayerNorm
+ *   (ELU的alpha为1，layer_norm使用默认eps，与导出的代码一致)；
+ *   actor.w0/b0、w1/b1...为专家层，层间ELU；obs_encoder和bn不参与推理
+ * 编码器输入为最近若干行历史加当前观测，行数由第一个Linear的输入维数推出
+ */
+bool RL_ROTDOG::load_native()
+{
+    if (!model.type()->name() || model.type()->name()->name() != "MixedMlpBarlowTwinsActor") {
+        std::cerr << "Native policy: unsupported module type" << std::endl;
+        return false;
     }
-    //hot start
-    for (int i = 0; i < history_length; i++)//为历史观测初始化
-    {
-        // 将 data 转为 tensor 类型，输入到模型
-        std::vector<float> obs;
-        //---------------Push data into obsbuf--------------------
-        obs.push_back(0);//request->omega[0]*omega_scale);
-        obs.push_back(0);//request->omega[1]*omega_scale);
-        obs.push_back(0);//request->omega[2]*omega_scale);
-
-        obs.push_back(0);//request->eu_ang[0]*eu_ang_scale);
-        obs.push_back(0);//request->eu_ang[1]*eu_ang_scale);
-        obs.push_back(0);//request->eu_ang[2]*eu_ang_scale);
-
-        // cmd
-        obs.push_back(0);//控制指令x
-        obs.push_back(0);//控制指令y
-        obs.push_back(0);//控制指令yaw rate
-
-        // pos q joint
-        for (int i = 0; i < 12; ++i)
-        {
-            float pos = 0;//(request->q[i]  - init_pos[i])* pos_scale;
-            obs.push_back(pos);
-            action[i]=init_pos[i];
+    torch::jit::Module encoder = model.attr("mlp_encoder").toModule();
+    torch::jit::Module actor = model.attr("actor").toModule();
+    torch::jit::Module gate = actor.attr("gate").toModule();
+    auto as_float = [](const torch::jit::IValue& v) { return v.toTensor().to(torch::kFloat32).contiguous(); };
+
+    int64_t encoder_in = 0;
+    for (const auto& child : encoder.named_children()) {
+        if (child.value.hasattr("weight") && child.value.type()->name()->name() == "Linear") {
+            encoder_in = child.value.attr("weight").toTensor().size(1);
+            break;
         }
-        // vel q joint
-        for (int i = 0; i < 12; ++i)
-        {
-            float vel = 0;//request->dq[i] * vel_scale;
-            obs.push_back(vel);
+    }
+    int64_t hist_rows = encoder_in / 45 - 1;
+    if (encoder_in % 45 != 0 || hist_rows < 0 || hist_rows > history_length - 1) {
+        std::cerr << "Native policy: encoder input " << encoder_in << " does not match the observation history" << std::endl;
+        return false;
+    }
+    native.begin(45, (uint32_t)hist_rows);
+
+    auto add_sequential = [&](torch::jit::Module& seq, PolicyMlpStage stage) {
+        for (const auto& child : seq.named_children()) {
+            std::string kind = child.value.type()->name()->name();
+            if (kind == "Linear") {
+                torch::Tensor w = as_float(child.value.attr("weight"));
+                torch::Tensor b = as_float(child.value.attr("bias"));
+                native.add_linear(stage, w.data_ptr<float>(), b.data_ptr<float>(), w.size(1), w.size(0));
+            } else if (kind == "ELU") {
+                native.add_elu(stage);
+            } else if (kind == "LayerNorm") {
+                torch::Tensor g = as_float(child.value.attr("weight"));
+                torch::Tensor b = as_float(child.value.attr("bias"));
+                native.add_layernorm(stage, g.data_ptr<float>(), b.data_ptr<float>(), g.numel(), 1e-5f);
+            } else {
+                std::cerr << "Native policy: unsupported layer " << kind << std::endl;
+                return false;
+            }
         }
-        // last action
-        for (int i = 0; i < 12; ++i)
-        {
-            obs.push_back(0);//历史  self.cfg.env.history_len, self.num_dofs
+        return true;
+    };
+    if (!add_sequential(encoder, MLP_STAGE_ENCODER) || !add_sequential(gate, MLP_STAGE_GATE)) return false;
+
+    int layers = 0;
+    while (actor.hasattr("w" + std::to_string(layers))) layers++;
+    for (int l = 0; l < layers; l++) {
+        torch::Tensor w = as_float(actor.attr("w" + std::to_string(l)));
+        torch::Tensor b = as_float(actor.attr("b" + std::to_string(l)));
+        native.add_expert_linear(w.data_ptr<float>(), b.data_ptr<float>(), w.size(0), w.size(1), w.size(2));
+        if (l + 1 < layers) native.add_elu(MLP_STAGE_EXPERT);
+    }
+    if (!native.finish() || native.dims().action_dim != 12) return false;
+    std::cout << "Native policy: " << native.dims().num_ops << " ops, "
+              << native.dims().arena_floats * sizeof(float) / 1024 << " KB weights, "
+              << PolicyMlp::isa_name(native.isa()) << " kernels" << std::endl;
+    return true;
+}
+
+/**
+ * 热身：用初始化后的全零输入依次以每个历史起点执行固定次数的推理，
+ * 让解释器的图优化、Static Runtime的内存规划和CUDA核函数加载在进入控制循环前完成。
+ * 不更新历史，热身前后的状态相同
+ */
+void RL_ROTDOG::warm_up()
+{
+    int head = ring_head;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < warmup_iters; i++) {
+        ring_head = i % history_length;
+        forward_step();
+    }
+    if (device == torch::kCUDA) {
+        action_cpu.copy_(forward_step());
+    }
+    ring_head = head;
+    auto dt = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "policy warm-up: " << warmup_iters << " iterations in " << dt / 1000.0 << " ms" << std::endl;
+}
+ 
+void RL_ROTDOG::init_policy(){
+ // load policy
+    std::cout << "RL model init start"<<endl;
+    if (model_path.empty()) {
+        model_path = POLICY_MODEL_PATH;//载入jit模型，离线回放时由调用者预先指定
+        if (flat_path.empty()) flat_path = POLICY_FLAT_PATH;
+    }
+    if (!map_flat()) {
+        load_policy();
+        if (!flat_path.empty()) {
+            std::cout << "run policy_export " << model_path << " " << flat_path
+                      << " to skip TorchScript loading at startup" << std::endl;
         }
-        auto options = torch::TensorOptions().dtype(torch::kFloat32);
-        torch::Tensor obs_tensor = torch::from_blob(obs.data(),{1,45},options).to(device);
     }
 
+ // initialize record
+    // 所有张量和视图在这里一次创建，handleMessage()中只原地写入
+    auto net = torch::TensorOptions().dtype(dtype).device(device);
+    auto dev_float = torch::TensorOptions().dtype(torch::kFloat32).device(device);
+    auto host_float = torch::TensorOptions().dtype(torch::kFloat32).pinned_memory(device == torch::kCUDA);
+    obs_cpu = torch::zeros({1, 45}, host_float);
+    obs = obs_cpu.data_ptr<float>();
+    obs_stage = device == torch::kCUDA ? torch::zeros({1, 45}, dev_float) : obs_cpu;
+    obs_in = dtype == torch::kFloat32 && device == torch::kCPU ? obs_cpu : torch::zeros({1, 45}, net);
+    action_cpu = torch::zeros({1, 12}, host_float);
+    action_stage = device == torch::kCUDA ? torch::zeros({1, 12}, dev_float) : action_cpu;
+    action_native = torch::zeros({1, 12}, host_float);
+    memset(last_action, 0, sizeof(last_action));
+
+    // 历史从全零开始(与训练时的复位一致)
+    obs_ring = torch::zeros({2 * history_length, 45}, net);
+    action_ring = torch::zeros({2 * history_length, 12}, net);
+    ring_head = 0;
+    obs_ring_rows.clear();
+    action_ring_rows.clear();
+    for (int r = 0; r < 2 * history_length; r++) {
+        obs_ring_rows.push_back(obs_ring.narrow(0, r, 1));
+        action_ring_rows.push_back(action_ring.narrow(0, r, 1));
+    }
+    ring_inputs.clear();
+    for (int h = 0; h < history_length; h++) {
+        std::vector<torch::jit::IValue> in;
+        in.push_back(obs_in);
+        in.push_back(obs_ring.narrow(0, h, history_length).unsqueeze(0));
+        ring_inputs.push_back(in);
+    }
+
+    action_temp.assign(12, 0.0f);
+    action.assign(init_pos, init_pos + 12);
+    prev_action.assign(init_pos, init_pos + 12);
+
+    warm_up();
 }
 
-int rl_tick = 0; // RL控制周期计数器
 void algorithm_control_thread() {
     std::cout << "Algorithm control thread started." << std::endl;
 
-    rl_rotdog.init_policy(); // 初始化策略
-    auto next_send_time = std::chrono::steady_clock::now();
+    // 策略已在main()中启动各线程之前初始化
+    // 1khz；超期时丢弃错过的节拍，避免连续补算的PD力矩使用同一份旧状态
+    PeriodicLoop loop("algorithm_control", std::chrono::milliseconds(1), OverrunPolicy::SKIP);
 
-    int imu_error_count = 0;
+    // 策略输出经三缓冲取用，两次输出之间按配置保持或插值；没有输出前目标为站立姿态
+    ActionInterpolator interp;
+    interp.set_profile(rl_rotdog.action_profile, (int64_t)rl_rotdog.interp_ms * 1000000);
+    interp.reset(rl_rotdog.init_pos);
+    interp.set_watchdog((int64_t)POLICY_PERIOD_MS * 1000000, (int64_t)rl_rotdog.deadline_ms * 1000000,
+                        rl_rotdog.fallback, (int64_t)rl_rotdog.decay_ms * 1000000, rl_rotdog.max_misses);
+
+    IMU::ImuSample_t imu_sample; // IMU读取线程发布的最新数据
+    uint32_t imu_seq = 0;        // 已取用的0x41帧数
+    uint32_t warmup = RT_ALLOC_WARMUP_CYCLES; // 热身结束后检查本线程的内存分配
     while (g_running) {
-        next_send_time += std::chrono::milliseconds(1); 
+        if (warmup > 0 && --warmup == 0) rt_alloc_guard_arm("algorithm_control");
+        uint32_t telemetry_flags = 0;
+        float imu_age_us = 0;
+        int64_t tick_ns = steady_ns(loop.start());
+        if (interp.update(tick_ns)) telemetry_flags |= TELEMETRY_FLAG_ACTION_UPDATED;
+        if (interp.missed() > 0) telemetry_flags |= TELEMETRY_FLAG_POLICY_STALE;
+        const float* target = interp.target();
 //------------------------------------------------------rl控制
-        if(rl_start >= 1)
-        {
-            rl_tick++;
-        }
-        if(rl_tick % 6 == 0 && rl_start >= 1) { // 每5次循环处理一次 200hz，写的是6,但实际是5次完整的循环
-            rl_tick = 0;
-            if(imu.get_imu_packet({0x41,0x60,0x62}) == false) {
-                imu_error_count++;
-                if (imu_error_count > 10) {
-                    // std::cerr << "IMU data retrieval failed too many times, stopping thread." << std::endl;
-                    // g_running = false;
-                    // break;
-                }
+        // IMU数据由读取线程解析，这里只做一次无锁拷贝，不再阻塞本线程等待串口；
+        // 每个节拍都把最新样本外推到本节拍的计划时刻
+        if (rl_start >= 1 && imu.read_latest(imu_sample)) {
+            if (imu_sample.seq != imu_seq) {
+                imu_seq = imu_sample.seq;
+                telemetry_flags |= TELEMETRY_FLAG_IMU_UPDATED;
             }
+            int64_t age_ns = imu_extrapolate(imu_sample, tick_ns, imu.imu_data);
+            imu.imu_body_vel = imu_sample.body_vel;
+            imu.imu_body_acc = imu_sample.body_acc;
+            imu_age_record(IMU_AGE_CONTROL, age_ns);
+            imu_age_us = age_ns / 1000.0f;
         }
         if(rl_start == 10) 
         {
             // 更新电机位置和速度 1khz
-            for(int i=0; i<NUM_CHANNELS; i++) {
-                int net_leg_1 = net2motor[i];
-                for(int j=0; j<MOTORS_PER_CHANNEL; j++) {
-                    float pos = g_motors[i][j].getPosition(i, j);
-                    int idx_1 = net_leg_1 * MOTORS_PER_CHANNEL + j;
-                    rl_rotdog.curr_pos[idx_1] = pos; // 更新当前关节位置
-                }
-            }
-            for(int i=0; i<NUM_CHANNELS; i++) {
-                int net_leg_2 = net2motor[i];
-                for(int j=0; j<MOTORS_PER_CHANNEL; j++) {
-                    float vel = g_motors[i][j].getSpeed(i, j);
-                    int idx_2 = net_leg_2 * MOTORS_PER_CHANNEL + j;
-                    rl_rotdog.curr_vel[idx_2] = vel; // 更新当前关节速度
-                }
+            JointBusState_t state;
+            joint_bus_read_state(state);
+            for(int i=0; i<12; i++) {
+                rl_rotdog.curr_pos[i] = state.pos[i]; // 更新当前关节位置
+                rl_rotdog.curr_vel[i] = state.spd[i]; // 更新当前关节速度
             }
             // 计算PD控制力矩 1khz
             for(int i=0; i<12; i++){
-                rl_rotdog.curr_tor[i] = rl_rotdog.pd_control(rl_rotdog.action[i], rl_rotdog.curr_pos[i], 0.0, rl_rotdog.curr_vel[i]);
+                rl_rotdog.curr_tor[i] = rl_rotdog.pd_control(target[i], rl_rotdog.curr_pos[i], 0.0, rl_rotdog.curr_vel[i]);
                 rl_rotdog.output_tor[i] = rl_rotdog.curr_tor[i]; // 更新输出力矩 curr_tor主要是为了预防网络输出太猛 output_tor才是实际的控制
 
                 // 对实际输出力矩进行限制
@@ -296,26 +478,35 @@ void algorithm_control_thread() {
             }
         }
         if(rl_protect == 0 && rl_start == 10){
-        //电机控制的顺序是FR，FL，RR，RL，网络输出是FL，FR，RL，RR
-        // 这里需要将输出的动作重新排列为FR，FL，RR，RL
-            for(int i=0; i<NUM_CHANNELS; i++){
-                for(int j=0; j<MOTORS_PER_CHANNEL; j++) {
-                        int net_leg = net2motor[i];
-                        int idx = net_leg * MOTORS_PER_CHANNEL + j;
-                        //网络输出限制，如果太大了，肯定是网络输出有问题
-                        if (rl_rotdog.curr_tor[idx] > 25 || rl_rotdog.curr_tor[idx] < -25) {
-                            std::cout << "Torque out of bounds, triggering protection!" << std::endl;
-                            rl_start = 0; // 停止控制
-                            rl_protect = 1;
-                            motor_protect();
-                        }
-                        //力矩限制
-                        if (rl_rotdog.curr_tor[idx] <= 25 && rl_rotdog.curr_tor[idx] >= -25) {
-                            g_motors[i][j].Motor_SetControlParams(i, j, rl_rotdog.output_tor[idx], 0, 0, 0, 0);
-                        }
-                        
+            //网络输出限制，如果太大了，肯定是网络输出有问题
+            bool torque_ok = true;
+            for(int i=0; i<12; i++) {
+                if (rl_rotdog.curr_tor[i] > 25 || rl_rotdog.curr_tor[i] < -25) {
+                    torque_ok = false;
+                    break;
                 }
             }
+            if (torque_ok) {
+                // 12个关节的力矩一次发布，关节总线负责重排到电机顺序FR，FL，RR，RL
+                JointBusCommand_t cmd = {};
+                for(int i=0; i<12; i++) {
+                    cmd.tor[i] = rl_rotdog.output_tor[i];
+                }
+                joint_bus_publish(cmd);
+                telemetry_flags |= TELEMETRY_FLAG_TORQUE_PUBLISHED;
+            } else {
+                std::cout << "Torque out of bounds, triggering protection!" << std::endl;
+                rl_start = 0; // 停止控制
+                rl_protect = 1;
+                motor_protect();
+            }
+        }
+        // 推理卡住或连续被拒绝，控制线程不等待，错过的步数达到上限时触发保护
+        if(interp.expired() && rl_protect == 0 && rl_start == 10) {
+            std::cout << "Policy missed " << interp.missed() << " consecutive steps, triggering protection!" << std::endl;
+            rl_start = 0; // 停止控制
+            rl_protect = 1;
+            motor_protect();
         }
         if((rl_start>1))
         {
@@ -388,7 +579,7 @@ void algorithm_control_thread() {
         
         // for(int i = 0; i < NUM_CHANNELS; i++) {
         //     for (int j = 0; j < MOTORS_PER_CHANNEL; j++) {
-        //         int idx = net2motor[i] * MOTORS_PER_CHANNEL + j;
+        //         int idx = joint_motor_to_net(i * MOTORS_PER_CHANNEL + j);
         //         std::cout << "Motor " << i << "-" << j << ": "
         //                   << ", Tor: " << std::setw(10) << rl_rotdog.curr_tor[idx] 
         //                   << "\n";
@@ -396,7 +587,37 @@ void algorithm_control_thread() {
         // }
         // }
 
-        std::this_thread::sleep_until(next_send_time);
+        // 遥测记录，未启动记录或队列满时跳过，不会阻塞本线程
+        if (TelemetryRecord_t* rec = telemetry_begin()) {
+            JointBusState_t state;
+            joint_bus_read_state(state);
+            // 记录按电机顺序排列
+            for (int m = 0; m < NUM_JOINTS; ++m) {
+                int k = joint_motor_to_net(m);
+                rec->pos[m] = state.pos[k];
+                rec->spd[m] = state.spd[k];
+                rec->tor[m] = state.tor[k];
+                rec->tor_cmd[m] = rl_rotdog.output_tor[k];
+                rec->action[m] = interp.current().target[k];
+                rec->target[m] = target[k];
+            }
+            rec->cmd[0] = rl_rotdog.cmd_x;
+            rec->cmd[1] = rl_rotdog.cmd_y;
+            rec->cmd[2] = rl_rotdog.cmd_rate;
+            rec->imu_age_us = imu_age_us;
+            rec->policy_seq = interp.current().seq;
+            rec->policy_age_us = interp.current().seq != 0 ? (tick_ns - interp.current().obs_ns) / 1000.0f : 0.0f;
+            rec->joint_oldest_ns = state.oldest_ns;
+            rec->flags = telemetry_flags;
+            rec->rl_start = rl_start;
+            rec->rl_protect = rl_protect;
+            rec->imu = imu.imu_data;
+            rec->imu_vel = imu.imu_body_vel;
+            rec->imu_acc = imu.imu_body_acc;
+            telemetry_commit(rec);
+        }
+
+        loop.wait();
 }
     std::cout << "Algorithm control thread stopped." << std::endl;
 }
@@ -405,19 +626,20 @@ void algorithm_control_thread() {
 //rl策略运行线程
 void rl_run() {
     std::cout << "Algorithm control thread started." << std::endl;
-    auto next_send_time = std::chrono::steady_clock::now();
+    // 50hz；推理超期时以当前时刻为新相位，保证两次推理之间至少间隔一个周期的观测
+    PeriodicLoop loop("rl_run", std::chrono::milliseconds(POLICY_PERIOD_MS), OverrunPolicy::REPHASE);
 
     while (g_running) {
-        next_send_time += std::chrono::milliseconds(20); 
-
         if(rl_start >= 1) { // 每20次循环处理一次 50hz
             rl_rotdog.handleMessage(); // 处理消息,推理网络，计算力矩
             if(rl_start<10){
                 rl_start++; // 预热网络
+            } else {
+                rt_alloc_guard_arm("rl_run"); // 预热推理完成后检查本线程的内存分配
             }
         }
 
-        std::this_thread::sleep_until(next_send_time);
+        loop.wait();
     }
 }
 
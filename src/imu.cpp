@@ -4,41 +4,24 @@
 #include <termios.h>
 #include <unistd.h>
 #include "serial_init.hpp"
+#include "protocol_codec.hpp"
 #include <cstring>
 #include <chrono>
 #include <iomanip>
 #include <sys/ioctl.h>
 #include <thread>
+#include <atomic>
+#include <cstdio>
+#include <cerrno>
+#include <poll.h>
+#include "motor_control.hpp"
+#include "rt_memory.hpp"
+#include "rt_util.hpp"
 
 
 uint64_t imu_tick;
 IMU imu;
 
-// CRC8计算
-uint8_t CRC8_Table(uint8_t* p, uint8_t counter)
-{
-	uint8_t crc8 = 0;
-	for (int i = 0; i < counter; i++)
-	{
-		uint8_t value = p[i];
-		uint8_t new_index = crc8 ^ value;
-		crc8 = CRC8Table[new_index];
-	}
-	return (crc8);
-}
-
-//CRC16计算
-uint16_t CRC16_Table(uint8_t* p, uint8_t counter)
-{
-	uint16_t crc16 = 0;
-	for (int i = 0; i < counter; i++)
-	{
-		uint8_t value = p[i];
-		crc16 = CRC16Table[((crc16 >> 8) ^ value) & 0xff] ^ (crc16 << 8);
-	}
-	return (crc16);
-}
-
 //初始化IMU类的构造函数
 IMU::IMU() {
     // 初始化IMU数据
@@ -53,125 +36,400 @@ IMU::IMU() {
     imu_data.Q3 = 0.0f;
     imu_data.Q4 = 0.0f;
     imu_data.Timestamp = 0;
+    memset(&imu_body_vel, 0, sizeof(imu_body_vel));
+    memset(&imu_body_acc, 0, sizeof(imu_body_acc));
+    memset(&FDILink_Status, 0, sizeof(FDILink_Status));  // 解析器从等待帧头开始
+    memset(&rx_sample, 0, sizeof(rx_sample));
+    imu_fd = -1;
 }
 
 
 //创建IMU请求数据包，返回帧长度
 int IMU::create_imu_packet(uint8_t* buffer, IMU::FDILink_Status_t* FDILink, uint8_t type, void* buf, int len)
 {
-    if(len > 250)
-    {
-        return -1; //数据长度超过限制
-    }
-
-	buffer[0] = 0xfc;//帧头
-	buffer[1] = type;//指令类别
-	buffer[2] = len;//数据长度
-	buffer[3] = FDILink->TxNumber++;//发送帧计数
-
-    //CRC8与CRC16计算
-	uint8_t CRC8 = CRC8_Table(buffer, 4);
-	buffer[4] = CRC8;
-	uint8_t* buf_data = buffer + 7;
-	for(int i = 0;i < len;i++)
-	{
-		buf_data[i] = ((uint8_t*)buf)[i];
-	}
-	uint16_t CRC16 = CRC16_Table(buf_data, len);
-	buffer[5] = (CRC16 >> 8);//高八位
-	buffer[6] = (CRC16 & 0xFF);//第八位
-	buffer[8 + len - 1] = 0XFD;//帧尾
-	return 8 + len;
-}
-
-// 支持多个ID的IMU包解析
-bool IMU::get_imu_packet(const std::vector<uint8_t>& id_list)
+    //帧头、CRC8、CRC16与帧尾由编解码库统一打包
+    return fdilink_encode(buffer, type, FDILink->TxNumber++, buf, len);
+}
+
+// 解析器状态(FDILink_Status_t::RxStatus)
+#define FDILINK_RX_HEAD    0  // 等待帧头0xFC
+#define FDILINK_RX_TYPE    1
+#define FDILINK_RX_LEN     2
+#define FDILINK_RX_SEQ     3
+#define FDILINK_RX_CRC8    4
+#define FDILINK_RX_CRC16_H 5
+#define FDILINK_RX_CRC16_L 6
+#define FDILINK_RX_DATA    7
+#define FDILINK_RX_TAIL    8
+
+/**
+ * 读取线程写，其他线程只读
+ */
+struct ImuStatsShared {
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> frames_att{0};
+    std::atomic<uint64_t> frames_vel{0};
+    std::atomic<uint64_t> frames_acc{0};
+    std::atomic<uint64_t> frames_other{0};
+    std::atomic<uint64_t> crc8_errors{0};
+    std::atomic<uint64_t> crc16_errors{0};
+    std::atomic<uint64_t> tail_errors{0};
+    std::atomic<uint64_t> discarded_bytes{0};
+    std::atomic<uint64_t> published{0};
+};
+
+static ImuStatsShared g_imu_stats;
+
+/**
+ * 逐字节解析FDILink帧
+ * 帧头7字节存入FDILink_Frame_Buffer，数据段存入Buffer。帧头CRC8通过后长度可信，
+ * 之后的数据段CRC16或帧尾错误只丢弃这一帧；帧头错误时从已收到的帧头字节中重新寻找0xFC，
+ * 不会因一个坏字节丢掉后面的好帧
+ */
+int IMU::parse_byte(uint8_t byte)
 {
-    struct PacketInfo {
-        int data_len;
-        int frame_len;
-        void* target_struct;
-    };
-    // 维护ID到结构体的映射
-    std::map<uint8_t, PacketInfo> id_map = {
-        {0x41, {sizeof(IMUData_t),     8 + sizeof(IMUData_t),     &imu_data}},
-        {0x60, {sizeof(imu_body_vel), 8 + sizeof(IMUData_MSG_BODY_VEL), &imu_body_vel}},
-        {0x62, {sizeof(imu_body_acc), 8 + sizeof(IMUData_MSG_BODY_ACCELERATION), &imu_body_acc}},
-        // 可扩展更多ID
-    };
-
-    uint8_t recv_buffer[256];
-    int recv_len = 0;
-    std::map<uint8_t, bool> found_map;
-    for (auto id : id_list) found_map[id] = false;
-
-    auto start_time = std::chrono::steady_clock::now();
-    while (std::chrono::duration_cast<std::chrono::milliseconds>(
-               std::chrono::steady_clock::now() - start_time).count() < COMM_TIMEOUT_MS)
-    {
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        FD_SET(imu_fd, &readfds);
-
-        struct timeval timeout;
-        timeout.tv_sec = 0;
-        timeout.tv_usec = 3000;
-
-        int ready = select(imu_fd + 1, &readfds, NULL, NULL, &timeout);
-        if (ready < 0) {
-            std::cerr << "[IMU][ERROR] select() failed in get_imu_packet: " << strerror(errno) << std::endl;
-            return false;
+    FDILink_Status_t& st = FDILink_Status;
+    uint8_t* header = st.FDILink_Frame_Buffer;
+    switch (st.RxStatus) {
+    case FDILINK_RX_HEAD:
+        if (byte == FDILINK_HEAD) {
+            header[0] = byte;
+            st.RxStatus = FDILINK_RX_TYPE;
+        } else {
+            bump(g_imu_stats.discarded_bytes);
+        }
+        return -1;
+    case FDILINK_RX_TYPE:
+        header[1] = byte;
+        st.RxType = byte;
+        st.RxStatus = FDILINK_RX_LEN;
+        return -1;
+    case FDILINK_RX_LEN:
+        header[2] = byte;
+        if (byte > FDILINK_MAX_PAYLOAD) {
+            resync(3);
+            return -1;
+        }
+        st.RxDataLeft = byte;
+        st.RxStatus = FDILINK_RX_SEQ;
+        return -1;
+    case FDILINK_RX_SEQ:
+        header[3] = byte;
+        st.RxNumber = byte;
+        st.RxStatus = FDILINK_RX_CRC8;
+        return -1;
+    case FDILINK_RX_CRC8:
+        header[4] = byte;
+        st.CRC8_Verify = fdilink_header_crc_ok(header);
+        if (!st.CRC8_Verify) {
+            bump(g_imu_stats.crc8_errors);
+            resync(5);
+            return -1;
+        }
+        st.RxStatus = FDILINK_RX_CRC16_H;
+        return -1;
+    case FDILINK_RX_CRC16_H:
+        header[5] = byte;
+        st.RxStatus = FDILINK_RX_CRC16_L;
+        return -1;
+    case FDILINK_RX_CRC16_L:
+        header[6] = byte;
+        st.BufferIndex = 0;
+        st.RxStatus = st.RxDataLeft > 0 ? FDILINK_RX_DATA : FDILINK_RX_TAIL;
+        return -1;
+    case FDILINK_RX_DATA:
+        st.Buffer[st.BufferIndex++] = byte;
+        if (--st.RxDataLeft == 0) st.RxStatus = FDILINK_RX_TAIL;
+        return -1;
+    case FDILINK_RX_TAIL:
+        st.RxStatus = FDILINK_RX_HEAD;
+        if (byte != FDILINK_TAIL) {
+            bump(g_imu_stats.tail_errors);
+            // 数据段中丢了字节时，这个位置可能已是下一帧的帧头
+            if (byte == FDILINK_HEAD) parse_byte(byte);
+            return -1;
         }
-        if (ready == 0) continue;
-
-        if (FD_ISSET(imu_fd, &readfds)) {
-            ssize_t bytes_read = read(imu_fd, recv_buffer + recv_len, sizeof(recv_buffer) - recv_len);
-            if (bytes_read > 0) {
-                recv_len += bytes_read;
-                // 遍历所有ID，查找包
-                for (auto id : id_list) {
-                    if (!id_map.count(id)) continue;
-                    auto& info = id_map[id];
-                    for (int i = 0; i <= recv_len - info.frame_len; ++i) {
-                        if (recv_buffer[i] == 0xFC && recv_buffer[i + 1] == id) {
-                            if (recv_buffer[i + 2] != info.data_len) continue;
-                            if (recv_buffer[i + info.frame_len - 1] != 0xFD) continue;
-                            uint8_t crc8 = CRC8_Table(recv_buffer + i, 4);
-                            if (crc8 != recv_buffer[i + 4]) {
-                                std::cerr << "[IMU][ERROR] CRC8 check failed for ID: 0x"
-                                          << std::hex << int(id) << std::dec << std::endl;
-                                return false;
-                            }
-                            uint16_t crc16_recv = (recv_buffer[i + 5] << 8) | recv_buffer[i + 6];
-                            uint16_t crc16_calc = CRC16_Table(recv_buffer + i + 7, info.data_len);
-                            if (crc16_recv != crc16_calc) {
-                                std::cerr << "[IMU][ERROR] CRC16 check failed for ID: 0x"
-                                          << std::hex << int(id) << std::dec << std::endl;
-                                return false;
-                            }
-                            std::memcpy(info.target_struct, recv_buffer + i + 7, info.data_len);//根据ID找到对应的结构体并复制数据
-                            found_map[id] = true;
-                        }
-                    }
-                }
-                // 如果所有ID都找到了，直接返回
-                bool all_found = true;
-                for (auto& kv : found_map) {
-                    if (!kv.second) { 
-                        all_found = false; break; }
-                }
-                if (all_found) {
-                    imu_tick++;
-                    return true;
-                }
-                if (recv_len > 250) recv_len = 0;
+        st.CRC16_Verify = fdilink_payload_crc_ok(header, st.Buffer);
+        if (!st.CRC16_Verify) {
+            bump(g_imu_stats.crc16_errors);
+            return -1;
+        }
+        return st.RxType;
+    }
+    st.RxStatus = FDILINK_RX_HEAD;
+    return -1;
+}
+
+void IMU::resync(int header_bytes)
+{
+    uint8_t replay[FDILINK_HEADER_SIZE];
+    memcpy(replay, FDILink_Status.FDILink_Frame_Buffer, header_bytes);
+    FDILink_Status.RxStatus = FDILINK_RX_HEAD;
+    bump(g_imu_stats.discarded_bytes);  // 第一个0xFC
+    for (int i = 1; i < header_bytes; ++i) {
+        parse_byte(replay[i]);  // 帧头内不可能解析出完整帧
+    }
+}
+
+bool IMU::apply_frame(int type, int64_t stamp_ns)
+{
+    int len = frame_length();
+    const uint8_t* payload = frame_payload();
+    if (type == 0x41 && len == sizeof(IMUData_t)) {
+        IMUData_t prev = rx_sample.data;
+        memcpy(&rx_sample.data, payload, len);
+        rx_sample.stamp_ns = stamp_ns;
+        // 接收时刻至少比采样时刻晚一帧的线上时间(每字节10位)
+        const int64_t wire_ns = (int64_t)(FDILINK_OVERHEAD + len) * 10 * 1000000000LL / IMU_BAUD_RATE;
+        rx_sample.sample_ns = clock_map.update(rx_sample.data.Timestamp, stamp_ns, wire_ns);
+        // 相邻两帧的角速度差分(按设备时间)，低通后用于外推
+        int64_t dt_us = rx_sample.data.Timestamp - prev.Timestamp;
+        if (rx_sample.seq > 0 && dt_us > 0 && dt_us <= IMU_EXTRAP_MAX_US) {
+            const float rates[3] = {rx_sample.data.RollSpeed, rx_sample.data.aPitchSpeedcc_y, rx_sample.data.HeadingSpeed};
+            const float prev_rates[3] = {prev.RollSpeed, prev.aPitchSpeedcc_y, prev.HeadingSpeed};
+            for (int k = 0; k < 3; ++k) {
+                float raw = (rates[k] - prev_rates[k]) / (dt_us * 1e-6f);
+                rx_sample.rate_dot[k] += IMU_RATE_DOT_ALPHA * (raw - rx_sample.rate_dot[k]);
             }
+        } else {
+            rx_sample.rate_dot[0] = rx_sample.rate_dot[1] = rx_sample.rate_dot[2] = 0.0f;
         }
+        rx_sample.seq++;
+        bump(g_imu_stats.frames_att);
+        imu_tick++;
+        return true;
+    }
+    if (type == 0x60 && len == sizeof(IMUData_MSG_BODY_VEL)) {
+        memcpy(&rx_sample.body_vel, payload, len);
+        rx_sample.vel_stamp_ns = stamp_ns;
+        bump(g_imu_stats.frames_vel);
+        return true;
     }
-    std::cerr << "[IMU][WARN] get_imu_packet timeout or not all IDs found" << std::endl;
+    if (type == 0x62 && len == sizeof(IMUData_MSG_BODY_ACCELERATION)) {
+        memcpy(&rx_sample.body_acc, payload, len);
+        rx_sample.acc_stamp_ns = stamp_ns;
+        bump(g_imu_stats.frames_acc);
+        return true;
+    }
+    bump(g_imu_stats.frames_other);
     return false;
 }
 
+/**
+ * IMU读取线程
+ * 串口为阻塞模式(VMIN=0, VTIME=1s)，有数据即返回，最长1s检查一次退出标志。
+ * 设备推送的每一帧都被解析；一批数据解析完后统一发布一次，控制线程读到的三种数据来自同一批
+ */
+void IMU::run_reader()
+{
+    if (imu_fd < 0) {
+        std::cerr << "[IMU][ERROR] serial port not open, reader thread exits" << std::endl;
+        return;
+    }
+    uint8_t buf[256];
+    uint32_t warmup = RT_ALLOC_WARMUP_CYCLES; // 热身结束后检查本线程的内存分配
+    while (g_running) {
+        ssize_t n = read(imu_fd, buf, sizeof(buf));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[IMU][ERROR] read() failed: " << strerror(errno) << std::endl;
+            break;
+        }
+        if (n == 0) continue;
+        if (warmup > 0 && --warmup == 0) rt_alloc_guard_arm("imu_reader");
+
+        int64_t stamp = steady_ns();
+        bump(g_imu_stats.bytes, (uint64_t)n);
+        bool updated = false;
+        for (ssize_t i = 0; i < n; ++i) {
+            int type = parse_byte(buf[i]);
+            if (type >= 0 && apply_frame(type, stamp)) updated = true;
+        }
+        if (updated) {
+            latest.store(rx_sample);
+            bump(g_imu_stats.published);
+        }
+    }
+}
+
+bool IMU::read_latest(ImuSample_t& out) const
+{
+    out = latest.load();
+    return out.stamp_ns != 0;
+}
+
+void imu_reader_thread()
+{
+    imu.run_reader();
+}
+
+ImuStats_t get_imu_stats()
+{
+    const ImuStatsShared& st = g_imu_stats;
+    ImuStats_t out;
+    out.bytes = st.bytes.load(std::memory_order_relaxed);
+    out.frames_att = st.frames_att.load(std::memory_order_relaxed);
+    out.frames_vel = st.frames_vel.load(std::memory_order_relaxed);
+    out.frames_acc = st.frames_acc.load(std::memory_order_relaxed);
+    out.frames_other = st.frames_other.load(std::memory_order_relaxed);
+    out.crc8_errors = st.crc8_errors.load(std::memory_order_relaxed);
+    out.crc16_errors = st.crc16_errors.load(std::memory_order_relaxed);
+    out.tail_errors = st.tail_errors.load(std::memory_order_relaxed);
+    out.discarded_bytes = st.discarded_bytes.load(std::memory_order_relaxed);
+    out.published = st.published.load(std::memory_order_relaxed);
+    return out;
+}
+
+/**
+ * 打印IMU读取线程的统计(自启动以来累计)
+ */
+void print_imu_statistics()
+{
+    ImuStats_t st = get_imu_stats();
+    std::cout << "IMU |      Bytes |   0x41 |   0x60 |   0x62 |  Other | CRC8 err | CRC16 err | Tail err | Discarded | Published\n";
+    std::cout << "----|------------|--------|--------|--------|--------|----------|-----------|----------|-----------|----------\n";
+    printf("    | %10lu | %6lu | %6lu | %6lu | %6lu | %8lu | %9lu | %8lu | %9lu | %9lu\n",
+           st.bytes, st.frames_att, st.frames_vel, st.frames_acc, st.frames_other,
+           st.crc8_errors, st.crc16_errors, st.tail_errors, st.discarded_bytes, st.published);
+    std::cout << std::endl;
+}
+
+// 已知数据包的负载长度，未知类别返回-1
+static int imu_payload_size(uint8_t id)
+{
+    switch (id) {
+    case 0x41: return sizeof(IMU::IMUData_t);
+    case 0x60: return sizeof(IMU::IMUData_MSG_BODY_VEL);
+    case 0x62: return sizeof(IMU::IMUData_MSG_BODY_ACCELERATION);
+    }
+    return -1;
+}
+
+/**
+ * 读取并解析串口数据，不发布、不计入帧统计(CRC错误等仍计入)
+ * @param frames 按类别累加帧数，256项
+ * @param wait_ack >=0时收到对该帧计数的输出配置命令的应答即返回
+ * @return 收到应答时返回其status，否则返回-1
+ */
+int IMU::measure_bus(int duration_ms, uint32_t* frames, uint64_t& bytes, int wait_ack)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(duration_ms);
+    uint8_t buf[256];
+    while (true) {
+        int left = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) return -1;
+        struct pollfd pfd = {imu_fd, POLLIN, 0};
+        if (poll(&pfd, 1, left) <= 0) continue;
+        ssize_t n = read(imu_fd, buf, sizeof(buf));
+        if (n <= 0) continue;
+        bytes += (uint64_t)n;
+        for (ssize_t i = 0; i < n; ++i) {
+            int type = parse_byte(buf[i]);
+            if (type < 0) continue;
+            frames[type]++;
+            if (type == FDILINK_CMD_ACK && wait_ack >= 0 && frame_length() == sizeof(ImuAck_t)) {
+                ImuAck_t ack;
+                memcpy(&ack, frame_payload(), sizeof(ack));
+                if (ack.cmd_type == FDILINK_CMD_OUTPUT && ack.cmd_seq == (uint8_t)wait_ack) return ack.status;
+            }
+        }
+    }
+}
+
+// 打印一次测量的总线占用和各类数据包的频率
+static void print_bus_usage(const char* label, const uint32_t* frames, uint64_t bytes, int duration_ms)
+{
+    double seconds = duration_ms / 1000.0;
+    printf("[IMU] bus %s: %.1f KB/s, %.1f%% of %d baud;", label, bytes / seconds / 1024.0,
+           bytes * 10.0 / seconds / IMU_BAUD_RATE * 100.0, IMU_BAUD_RATE);
+    for (int t = 0; t < 256; ++t) {
+        if (frames[t] > 0 && t != FDILINK_CMD_ACK) printf(" 0x%02X %.0f/s", t, frames[t] / seconds);
+    }
+    printf("\n");
+}
+
+/**
+ * 启动时配置设备推送
+ * 配置前后各测量IMU_BUS_MEASURE_MS的总线占用；命令按IMU_ACK_TIMEOUT_MS超时重发，最多IMU_CONFIG_RETRIES次；
+ * 配置后核对只出现ids中的数据包且每种频率与rate_hz相差不超过10%
+ */
+bool IMU::configure_outputs(const uint8_t* ids, int count, uint16_t rate_hz)
+{
+    if (imu_fd < 0) {
+        std::cerr << "[IMU][ERROR] serial port not open, outputs not configured" << std::endl;
+        return false;
+    }
+    if (count <= 0 || count > IMU_MAX_OUTPUTS || rate_hz == 0) {
+        std::cerr << "[IMU][ERROR] invalid output configuration" << std::endl;
+        return false;
+    }
+
+    // 配置后的总线占用，未知长度的数据包按最大长度估计
+    double planned = 0;
+    for (int i = 0; i < count; ++i) {
+        int len = imu_payload_size(ids[i]);
+        planned += FDILINK_OVERHEAD + (len >= 0 ? len : FDILINK_MAX_PAYLOAD);
+    }
+    planned = planned * rate_hz * 10.0 / IMU_BAUD_RATE;
+    if (planned > IMU_BUS_BUDGET) {
+        std::cerr << "[IMU][ERROR] " << count << " packets at " << rate_hz << " Hz need " << planned * 100.0
+                  << "% of the bus (budget " << IMU_BUS_BUDGET * 100.0 << "%), outputs not configured" << std::endl;
+        return false;
+    }
+
+    uint32_t frames[256] = {0};
+    uint64_t bytes = 0;
+    measure_bus(IMU_BUS_MEASURE_MS, frames, bytes);
+    print_bus_usage("before", frames, bytes, IMU_BUS_MEASURE_MS);
+
+    ImuOutputCmd_t cmd;
+    cmd.rate_hz = rate_hz;
+    cmd.count = (uint8_t)count;
+    memcpy(cmd.ids, ids, count);
+    uint8_t packet[FDILINK_OVERHEAD + sizeof(cmd)];
+    int status = -1;
+    for (int attempt = 0; attempt < IMU_CONFIG_RETRIES && status < 0; ++attempt) {
+        uint8_t seq = (uint8_t)FDILink_Status.TxNumber;
+        int len = create_imu_packet(packet, &FDILink_Status, FDILINK_CMD_OUTPUT, &cmd, 3 + count);
+        if (write(imu_fd, packet, len) != len) {
+            std::cerr << "[IMU][ERROR] failed to send output configuration: " << strerror(errno) << std::endl;
+            return false;
+        }
+        memset(frames, 0, sizeof(frames));
+        bytes = 0;
+        status = measure_bus(IMU_ACK_TIMEOUT_MS, frames, bytes, seq);
+    }
+    if (status != 0) {
+        std::cerr << "[IMU][ERROR] output configuration " << (status < 0 ? "not acknowledged" : "rejected")
+                  << " (status " << status << "), keeping device settings" << std::endl;
+        return false;
+    }
+
+    memset(frames, 0, sizeof(frames));
+    bytes = 0;
+    measure_bus(IMU_BUS_MEASURE_MS, frames, bytes);
+    print_bus_usage("after", frames, bytes, IMU_BUS_MEASURE_MS);
+    printf("[IMU] planned %.1f%% of the bus for %d packets at %u Hz\n", planned * 100.0, count, rate_hz);
+
+    // 核对实际推送的类别和频率
+    bool ok = true;
+    double expected = rate_hz * IMU_BUS_MEASURE_MS / 1000.0;
+    for (int t = 0; t < 256; ++t) {
+        bool wanted = memchr(ids, t, count) != NULL;
+        if (!wanted && frames[t] > 0 && t != FDILINK_CMD_ACK) {
+            std::cerr << "[IMU][ERROR] packet 0x" << std::hex << t << std::dec << " still streamed" << std::endl;
+            ok = false;
+        }
+        if (wanted && (frames[t] < expected * 0.9 || frames[t] > expected * 1.1)) {
+            std::cerr << "[IMU][ERROR] packet 0x" << std::hex << t << std::dec << " at "
+                      << frames[t] * 1000.0 / IMU_BUS_MEASURE_MS << " Hz, expected " << rate_hz << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
 
 //初始化IMU串口
 void IMU::serial_init(const char* port_name) {
@@ -185,6 +443,7 @@ void IMU::serial_init(const char* port_name) {
     // 配置串口参数
     if (!configure_imu_serial(imu_fd)) {
         close(imu_fd);
+        imu_fd = -1;
         std::cerr << "Failed to configure serial port" << std::endl;
         return;
     }
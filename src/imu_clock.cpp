@@ -0,0 +1,176 @@
+#include "imu_clock.hpp"
+#include <iostream>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "imu.hpp"
+#include "common.hpp"
+#include "rt_util.hpp"
+
+/**
+ * 映射状态，读取线程写，其他线程只读
+ */
+struct ImuClockShared {
+    std::atomic<int64_t> offset_ns{0};
+    std::atomic<int64_t> skew_ppb{0};  // 十亿分之一，整数便于原子存取
+    std::atomic<uint64_t> windows{0};
+    std::atomic<uint64_t> resets{0};
+};
+
+static ImuClockShared g_imu_clock;
+static LatencyHistogram g_imu_age[IMU_AGE_SOURCES];
+
+static const char* age_source_names[IMU_AGE_SOURCES] = {"control tick", "policy obs"};
+
+ImuClockMap::ImuClockMap() {
+    reset();
+}
+
+void ImuClockMap::reset() {
+    started = false;
+    anchor_dev_ns = 0;
+    anchor_offset_ns = 0;
+    skew = 0.0;
+    windows = 0;
+    win_start_dev_ns = 0;
+    win_min_dev_ns = 0;
+    win_min_offset_ns = 0;
+    prev_min_dev_ns = 0;
+    prev_min_offset_ns = 0;
+}
+
+int64_t ImuClockMap::to_monotonic(int64_t device_us) const {
+    int64_t dev_ns = device_us * 1000;
+    return dev_ns + anchor_offset_ns + (int64_t)(skew * (double)(dev_ns - anchor_dev_ns));
+}
+
+/**
+ * 偏移候选 = 接收时刻 - 传输时间 - 设备时刻，总是不小于真实偏移。
+ * 候选低于当前映射时立即把参考点移到这一帧(映射只会沿下包络更新)；每个窗口结束时，
+ * 用本窗口与上一窗口的最小点估计漂移并平滑，参考点移到本窗口的最小点
+ */
+int64_t ImuClockMap::update(int64_t device_us, int64_t rx_ns, int64_t wire_ns) {
+    const int64_t dev_ns = device_us * 1000;
+    const int64_t offset = rx_ns - wire_ns - dev_ns;
+
+    if (started) {
+        int64_t predicted = anchor_offset_ns + (int64_t)(skew * (double)(dev_ns - anchor_dev_ns));
+        if (llabs(offset - predicted) > (int64_t)IMU_CLOCK_JUMP_MS * 1000000 || dev_ns < win_start_dev_ns) {
+            reset();
+            bump(g_imu_clock.resets);
+        }
+    }
+    if (!started) {
+        started = true;
+        anchor_dev_ns = dev_ns;
+        anchor_offset_ns = offset;
+        win_start_dev_ns = dev_ns;
+        win_min_dev_ns = dev_ns;
+        win_min_offset_ns = offset;
+    } else {
+        int64_t predicted = anchor_offset_ns + (int64_t)(skew * (double)(dev_ns - anchor_dev_ns));
+        if (offset < predicted) {
+            anchor_dev_ns = dev_ns;
+            anchor_offset_ns = offset;
+        }
+        if (offset - (int64_t)(skew * (double)(dev_ns - win_min_dev_ns)) < win_min_offset_ns) {
+            win_min_dev_ns = dev_ns;
+            win_min_offset_ns = offset;
+        }
+    }
+
+    if (dev_ns - win_start_dev_ns >= (int64_t)IMU_CLOCK_WINDOW_MS * 1000000) {
+        if (windows > 0 && win_min_dev_ns > prev_min_dev_ns) {
+            double measured = (double)(win_min_offset_ns - prev_min_offset_ns) / (double)(win_min_dev_ns - prev_min_dev_ns);
+            skew = windows == 1 ? measured : skew + IMU_CLOCK_SKEW_GAIN * (measured - skew);
+        }
+        windows++;
+        prev_min_dev_ns = win_min_dev_ns;
+        prev_min_offset_ns = win_min_offset_ns;
+        anchor_dev_ns = win_min_dev_ns;
+        anchor_offset_ns = win_min_offset_ns;
+        win_start_dev_ns = dev_ns;
+        win_min_dev_ns = dev_ns;
+        win_min_offset_ns = offset;
+        g_imu_clock.windows.store((uint64_t)windows, std::memory_order_relaxed);
+        g_imu_clock.skew_ppb.store((int64_t)(skew * 1e9), std::memory_order_relaxed);
+    }
+    g_imu_clock.offset_ns.store(anchor_offset_ns, std::memory_order_relaxed);
+    return to_monotonic(device_us);
+}
+
+static inline float wrap_pi(float a) {
+    if (a > (float)M_PI) return a - 2.0f * (float)M_PI;
+    if (a < -(float)M_PI) return a + 2.0f * (float)M_PI;
+    return a;
+}
+
+/**
+ * 欧拉角运动学(ZYX)：
+ *   roll'    = p + (q sin(roll) + r cos(roll)) tan(pitch)
+ *   pitch'   = q cos(roll) - r sin(roll)
+ *   heading' = (q sin(roll) + r cos(roll)) / cos(pitch)
+ * p、q、r取外推区间中点的角速度，外推时长不超过几毫秒，一步积分的误差可以忽略
+ */
+int64_t imu_extrapolate(const IMU::ImuSample_t& sample, int64_t t_ns, IMU::IMUData_t& out) {
+    out = sample.data;
+    const int64_t age_ns = t_ns - sample.sample_ns;
+    int64_t span_ns = age_ns < 0 ? 0 : age_ns;
+    if (span_ns > (int64_t)IMU_EXTRAP_MAX_US * 1000) span_ns = (int64_t)IMU_EXTRAP_MAX_US * 1000;
+    const float dt = (float)span_ns * 1e-9f;
+    if (dt <= 0.0f) return age_ns;
+
+    const IMU::IMUData_t& d = sample.data;
+    float p = d.RollSpeed + 0.5f * sample.rate_dot[0] * dt;
+    float q = d.aPitchSpeedcc_y + 0.5f * sample.rate_dot[1] * dt;
+    float r = d.HeadingSpeed + 0.5f * sample.rate_dot[2] * dt;
+    float sr = sinf(d.Roll), cr = cosf(d.Roll);
+    float cp = cosf(d.Pitch);
+    if (fabsf(cp) < 0.1f) cp = cp < 0 ? -0.1f : 0.1f;  // 接近竖直时欧拉角奇异
+    float tp = sinf(d.Pitch) / cp;
+
+    out.Roll = d.Roll + (p + (q * sr + r * cr) * tp) * dt;
+    out.Pitch = d.Pitch + (q * cr - r * sr) * dt;
+    out.Heading = wrap_pi(d.Heading + (q * sr + r * cr) / cp * dt);
+    out.RollSpeed = d.RollSpeed + sample.rate_dot[0] * dt;
+    out.aPitchSpeedcc_y = d.aPitchSpeedcc_y + sample.rate_dot[1] * dt;
+    out.HeadingSpeed = d.HeadingSpeed + sample.rate_dot[2] * dt;
+    return age_ns;
+}
+
+void imu_age_record(ImuAgeSource source, int64_t age_ns) {
+    g_imu_age[source].record(age_ns > 0 ? (uint32_t)(age_ns / 1000) : 0);
+}
+
+void get_imu_age_snapshot(ImuAgeSource source, LatencyHistSnapshot_t& out) {
+    g_imu_age[source].snapshot(out);
+}
+
+ImuClockStats_t get_imu_clock_stats() {
+    ImuClockStats_t out;
+    out.offset_ns = g_imu_clock.offset_ns.load(std::memory_order_relaxed);
+    out.skew_ppm = g_imu_clock.skew_ppb.load(std::memory_order_relaxed) * 1e-3;
+    out.windows = g_imu_clock.windows.load(std::memory_order_relaxed);
+    out.resets = g_imu_clock.resets.load(std::memory_order_relaxed);
+    return out;
+}
+
+/**
+ * 打印设备时钟映射状态和各来源的样本年龄(自启动以来)
+ */
+void print_imu_age_statistics() {
+    ImuClockStats_t clk = get_imu_clock_stats();
+    printf("IMU clock: offset %.3f ms, skew %+.2f ppm, %lu windows, %lu resets\n",
+           clk.offset_ns / 1e6, clk.skew_ppm, clk.windows, clk.resets);
+    std::cout << "IMU age (us)  |   Samples |    p50 |    p99 |  p99.9 |    Max\n";
+    std::cout << "--------------|-----------|--------|--------|--------|-------\n";
+    LatencyHistSnapshot_t snap;
+    for (int s = 0; s < IMU_AGE_SOURCES; ++s) {
+        get_imu_age_snapshot((ImuAgeSource)s, snap);
+        printf("%-13s | %9lu | %6u | %6u | %6u | %6u\n", age_source_names[s], snap.total,
+               latency_hist_quantile(snap, 0.5), latency_hist_quantile(snap, 0.99),
+               latency_hist_quantile(snap, 0.999), latency_hist_max(snap));
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,285 @@
+#include "imu_emulator.hpp"
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include "protocol_codec.hpp"
+#include "rt_util.hpp"
+
+ImuEmulator::ImuEmulator() : master_fd(-1), slave_fd(-1), output_count(3), rx_len(0), command_count(0),
+                             corrupt_count(0), byte_count(0), overrun_count(0), start_ns(0), running(false), paused(false) {
+    config = {200, 0, 0, 0, 0.0f, 921600, 0, 0.0};  // 默认200Hz、921600波特率，与设备出厂配置相同
+    output_ids[0] = 0x41;
+    output_ids[1] = 0x60;
+    output_ids[2] = 0x62;
+    for (auto& c : frame_count) c = 0;
+}
+
+ImuEmulator::~ImuEmulator() {
+    stop();
+}
+
+void ImuEmulator::setConfig(const ImuConfig_t& cfg) {
+    config = cfg;
+}
+
+void ImuEmulator::setOutputs(const uint8_t* ids, int count) {
+    output_count = std::min(count, IMU_MAX_OUTPUTS);
+    memcpy(output_ids, ids, output_count);
+}
+
+int64_t ImuEmulator::deviceClockUs(int64_t ns) const {
+    double elapsed_us = (ns - start_ns) / 1000.0 * (1.0 + config.clock_drift_ppm * 1e-6);
+    return start_ns / 1000 + (int64_t)elapsed_us + config.clock_offset_us;
+}
+
+/**
+ * 创建PTY并建立符号链接
+ * @param link_dir 链接目录，生成link_dir/ttyIMU
+ */
+bool ImuEmulator::start(const char* link_dir) {
+    port_name = std::string(link_dir) + "/ttyIMU";
+
+    master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master_fd < 0 || grantpt(master_fd) != 0 || unlockpt(master_fd) != 0) {
+        std::cerr << "[IMU EMU] Failed to create pty: " << strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+    const char* slave_name = ptsname(master_fd);
+    slave_fd = open(slave_name, O_RDWR | O_NOCTTY);
+    if (slave_fd < 0) {
+        std::cerr << "[IMU EMU] Failed to open " << slave_name << ": " << strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+
+    // 从端设为原始模式，避免行规程改写二进制数据
+    struct termios tty;
+    tcgetattr(slave_fd, &tty);
+    cfmakeraw(&tty);
+    tcsetattr(slave_fd, TCSANOW, &tty);
+
+    // 主端非阻塞，被测程序不读取时丢弃数据，与真实串口溢出一致，且stop()不会卡在write()上
+    fcntl(master_fd, F_SETFL, fcntl(master_fd, F_GETFL) | O_NONBLOCK);
+
+    unlink(port_name.c_str());
+    if (symlink(slave_name, port_name.c_str()) != 0) {
+        std::cerr << "[IMU EMU] Failed to link " << port_name << ": " << strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+
+    start_ns = steady_ns();
+    running = true;
+    thread = std::thread(&ImuEmulator::stream_loop, this);
+    return true;
+}
+
+void ImuEmulator::stop() {
+    running = false;
+    if (thread.joinable()) thread.join();
+    if (master_fd >= 0) close(master_fd);
+    if (slave_fd >= 0) close(slave_fd);
+    master_fd = -1;
+    slave_fd = -1;
+    if (!port_name.empty()) unlink(port_name.c_str());
+}
+
+int64_t ImuEmulator::deviceToSteadyNs(int64_t device_us) const {
+    double elapsed_us = (double)(device_us - start_ns / 1000 - config.clock_offset_us) / (1.0 + config.clock_drift_ppm * 1e-6);
+    return start_ns + (int64_t)(elapsed_us * 1000.0);
+}
+
+/**
+ * 合成数据：横滚、俯仰缓慢摆动，航向匀速转动(ZYX欧拉角)，角速度为与之一致的机体系角速度，
+ * 四元数与欧拉角一致
+ */
+void ImuEmulator::sampleAt(int64_t ns, IMU::IMUData_t& att, IMU::IMUData_MSG_BODY_VEL& vel,
+                              IMU::IMUData_MSG_BODY_ACCELERATION& acc) const {
+    const double t = (ns - start_ns) * 1e-9;
+    const double w_roll = 2 * M_PI * 0.5, w_pitch = 2 * M_PI * 0.3;
+    double roll = 0.1 * sin(w_roll * t);
+    double pitch = 0.05 * sin(w_pitch * t + 1.0);
+    double heading = remainder(0.2 * t, 2 * M_PI);
+
+    // 欧拉角速率换算为机体系角速度
+    double roll_dot = 0.1 * w_roll * cos(w_roll * t);
+    double pitch_dot = 0.05 * w_pitch * cos(w_pitch * t + 1.0);
+    double heading_dot = 0.2;
+    att.RollSpeed = (float)(roll_dot - heading_dot * sin(pitch));
+    att.aPitchSpeedcc_y = (float)(pitch_dot * cos(roll) + heading_dot * sin(roll) * cos(pitch));
+    att.HeadingSpeed = (float)(-pitch_dot * sin(roll) + heading_dot * cos(roll) * cos(pitch));
+    att.Roll = (float)roll;
+    att.Pitch = (float)pitch;
+    att.Heading = (float)heading;
+    // ZYX欧拉角转四元数
+    double cr = cos(roll / 2), sr = sin(roll / 2);
+    double cp = cos(pitch / 2), sp = sin(pitch / 2);
+    double cy = cos(heading / 2), sy = sin(heading / 2);
+    att.Q1 = (float)(cr * cp * cy + sr * sp * sy);
+    att.Q2 = (float)(sr * cp * cy - cr * sp * sy);
+    att.Q3 = (float)(cr * sp * cy + sr * cp * sy);
+    att.Q4 = (float)(cr * cp * sy - sr * sp * cy);
+    att.Timestamp = deviceClockUs(ns);
+
+    vel.Velocity_X = (float)(0.3 * cos(0.5 * t));
+    vel.Velocity_Y = 0.0f;
+    vel.Velocity_Z = 0.0f;
+
+    acc.Body_acceleration_X = (float)(-0.15 * sin(0.5 * t));
+    acc.Body_acceleration_Y = 0.0f;
+    acc.Body_acceleration_Z = 0.0f;
+    acc.G_force = 9.80665f;
+}
+
+/**
+ * 解析主端收到的字节，找出完整且校验正确的命令帧
+ * 输出配置命令立即生效(推送类别和频率)，应答帧写在本组数据之前；其他命令应答错误码1
+ */
+int ImuEmulator::handle_commands(uint8_t* buffer, uint8_t& seq) {
+    ssize_t n = read(master_fd, rx_buf + rx_len, sizeof(rx_buf) - rx_len);
+    if (n > 0) rx_len += (int)n;
+
+    int len = 0;
+    int pos = 0;
+    while (pos < rx_len) {
+        if (rx_buf[pos] != FDILINK_HEAD) {
+            pos++;
+            continue;
+        }
+        if (rx_len - pos < FDILINK_HEADER_SIZE) break;
+        const uint8_t* frame = rx_buf + pos;
+        if (!fdilink_header_crc_ok(frame)) {
+            pos++;
+            continue;
+        }
+        int frame_len = FDILINK_OVERHEAD + frame[2];
+        if (rx_len - pos < frame_len) break;
+        if (frame[frame_len - 1] != FDILINK_TAIL || !fdilink_payload_crc_ok(frame)) {
+            pos++;
+            continue;
+        }
+
+        IMU::ImuAck_t ack = {frame[1], frame[3], 1};
+        const IMU::ImuOutputCmd_t* cmd = (const IMU::ImuOutputCmd_t*)(frame + FDILINK_HEADER_SIZE);
+        if (frame[1] == FDILINK_CMD_OUTPUT && frame[2] >= 3 && cmd->count <= IMU_MAX_OUTPUTS &&
+            frame[2] == 3 + cmd->count && cmd->rate_hz > 0) {
+            output_count = cmd->count;
+            memcpy(output_ids, cmd->ids, output_count);
+            config.rate_hz = cmd->rate_hz;
+            command_count++;
+            ack.status = 0;
+        }
+        len += fdilink_encode(buffer + len, FDILINK_CMD_ACK, seq++, ack);
+        pos += frame_len;
+    }
+    memmove(rx_buf, rx_buf + pos, rx_len - pos);
+    rx_len -= pos;
+    if (rx_len == (int)sizeof(rx_buf)) rx_len = 0;  // 缓冲区被无效数据占满
+    return len;
+}
+
+/**
+ * 推送线程
+ * 每个周期先处理收到的命令，再生成一组已选择的帧，按概率损坏其中的帧，再按拆段设置写出。
+ * 设置了波特率时按线上时间节流写出，一组数据的线上时间超过周期时后续的组被丢弃
+ */
+void ImuEmulator::stream_loop() {
+    // 缩小定时器松弛量，使微秒级定时更准确
+    prctl(PR_SET_TIMERSLACK, 1UL);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    uint8_t seq = 0;
+    uint8_t buffer[(IMU_MAX_OUTPUTS + 4) * (FDILINK_OVERHEAD + FDILINK_MAX_PAYLOAD)];
+    const uint8_t filler[48] = {0};
+
+    const double byte_ns = config.baud > 0 ? 10e9 / config.baud : 0.0;
+    int64_t next_ns = steady_ns();
+    int64_t line_free_ns = 0;  // 线路发送完已写出数据的时刻
+    while (running) {
+        const int64_t period_ns = 1000000000LL / (config.rate_hz > 0 ? config.rate_hz : 1);
+        next_ns += period_ns;
+        int64_t due_ns = next_ns;
+        if (config.jitter_us > 0) due_ns += (int64_t)(uniform(rng) * config.jitter_us) * 1000;
+        struct timespec ts;
+        ts.tv_sec = due_ns / 1000000000;
+        ts.tv_nsec = due_ns % 1000000000;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+        if (paused) continue;
+
+        int len = handle_commands(buffer, seq);
+        // 上一组在本组的发送时刻还没有发送完，设备丢弃本组(有应答要发送时不丢弃)
+        if (len == 0 && due_ns < line_free_ns) {
+            overrun_count++;
+            continue;
+        }
+
+        // 设备在计划时刻采样，仿真线程唤醒迟了也不影响Timestamp与线路时序的关系
+        IMU::IMUData_t att;
+        IMU::IMUData_MSG_BODY_VEL vel;
+        IMU::IMUData_MSG_BODY_ACCELERATION acc;
+        sampleAt(due_ns, att, vel, acc);
+
+        int starts[IMU_MAX_OUTPUTS + 1];
+        for (int k = 0; k < output_count; ++k) {
+            starts[k] = len;
+            uint8_t id = output_ids[k];
+            if (id == 0x41) len += fdilink_encode(buffer + len, id, seq++, att);
+            else if (id == 0x60) len += fdilink_encode(buffer + len, id, seq++, vel);
+            else if (id == 0x62) len += fdilink_encode(buffer + len, id, seq++, acc);
+            else len += fdilink_encode(buffer + len, id, seq++, filler);
+            frame_count[id]++;
+        }
+        starts[output_count] = len;
+
+        for (int k = 0; k < output_count; ++k) {
+            if (config.corrupt_rate > 0 && uniform(rng) < config.corrupt_rate) {
+                int pos = starts[k] + (int)(uniform(rng) * (starts[k + 1] - starts[k] - 0.01f));
+                buffer[pos] ^= (uint8_t)(1u << (rng() % 8));
+                corrupt_count++;
+            }
+        }
+
+        // 不拆段时逐帧写出，每帧在其最后一个字节发送完时到达，与真实串口一样
+        for (int off = 0, n = 0; off < len; off += n) {
+            if (config.split_bytes > 0) {
+                n = std::min((int)config.split_bytes, len - off);
+            } else {
+                int end = len;
+                for (int k = 0; k < output_count; ++k) {
+                    if (starts[k] > off) {
+                        end = starts[k];
+                        break;
+                    }
+                }
+                n = end - off;
+            }
+            // 按线上时间写出：第一段从计划发送时刻开始，之后每段在上一段发送完(加拆段间隔)后开始，
+            // 在发送完成的时刻才全部到达。只按计划时刻推算，仿真线程自身的唤醒延迟不会被算作线路占满
+            int64_t now = steady_ns();
+            int64_t begin_ns = off == 0 ? std::max(due_ns, line_free_ns)
+                                        : line_free_ns + (int64_t)config.split_gap_us * 1000;
+            int64_t done_ns = begin_ns + (int64_t)(n * byte_ns);
+            if (done_ns > now + 1000) {
+                ts.tv_sec = done_ns / 1000000000;
+                ts.tv_nsec = done_ns % 1000000000;
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+            }
+            line_free_ns = done_ns;
+            ssize_t written = write(master_fd, buffer + off, n);
+            if (written > 0) byte_count += (uint64_t)written;
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#include "joint_bus.hpp"
+#include <chrono>
+#include "motor_control.hpp"
+#include "seqlock.hpp"
+#include "rt_util.hpp"
+
+// 最近一次发布的命令，已换算到转子端，按电机顺序
+static SeqLock<JointCommand_t> g_bus_command;
+
+void joint_bus_publish(const JointBusCommand_t& cmd) {
+    JointCommand_t target, rotor;
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        const int n = joint_motor_to_net(j);
+        target.tor[j] = cmd.tor[n];
+        target.spd[j] = cmd.spd[n];
+        target.pos[j] = cmd.pos[n];
+        target.k_pos[j] = cmd.k_pos[n];
+        target.k_spd[j] = cmd.k_spd[n];
+    }
+    joint_output_to_rotor(target, rotor);
+    g_bus_command.store_shared(rotor);
+}
+
+void joint_bus_publish_uniform(float tor_des, float spd_des, float pos_des, float k_pos, float k_spd) {
+    JointBusCommand_t cmd;
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        cmd.tor[j] = tor_des;
+        cmd.spd[j] = spd_des;
+        cmd.pos[j] = pos_des;
+        cmd.k_pos[j] = k_pos;
+        cmd.k_spd[j] = k_spd;
+    }
+    joint_bus_publish(cmd);
+}
+
+void joint_bus_read_state(JointBusState_t& state) {
+    JointState_t rotor, out;
+    int64_t oldest = INT64_MAX;
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
+            const Motor::Feedback_t f = g_motors[i][j].getFeedback();
+            const int k = i * MOTORS_PER_CHANNEL + j;
+            rotor.tor[k] = f.tor;
+            rotor.spd[k] = f.spd;
+            rotor.pos[k] = f.pos;
+            if (f.stamp_ns < oldest) oldest = f.stamp_ns;
+        }
+    }
+    joint_rotor_to_output(rotor, out);
+
+    for (int k = 0; k < NUM_JOINTS; ++k) {
+        const int n = joint_motor_to_net(k);
+        state.pos[n] = out.pos[k];
+        state.spd[n] = out.spd[k];
+        state.tor[n] = out.tor[k];
+    }
+    state.oldest_ns = oldest;
+    state.stamp_ns = steady_ns();
+}
+
+void joint_bus_inject_feedback(const JointState_t& state, int64_t stamp_ns) {
+    // 位置、速度、转矩的换算与命令相同，借用命令的换算函数
+    JointCommand_t out = {}, rotor;
+    for (int k = 0; k < NUM_JOINTS; ++k) {
+        out.tor[k] = state.tor[k];
+        out.spd[k] = state.spd[k];
+        out.pos[k] = state.pos[k];
+    }
+    joint_output_to_rotor(out, rotor);
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
+            const int k = i * MOTORS_PER_CHANNEL + j;
+            Motor::Feedback_t f = g_motors[i][j].getFeedback();
+            f.tor = rotor.tor[k];
+            f.spd = rotor.spd[k];
+            f.pos = rotor.pos[k];
+            f.stamp_ns = stamp_ns;
+            g_motors[i][j].setFeedback(f);
+        }
+    }
+}
+
+bool joint_bus_apply(int channel, uint32_t& seen_version) {
+    // 没有新发布时只有一次原子读
+    const uint32_t version = g_bus_command.version();
+    if (version == seen_version) return false;
+
+    // 先记下版本再读取：读取期间若又有发布，读到的只会更新，下个周期会再应用一次
+    const JointCommand_t c = g_bus_command.load();
+    seen_version = version;
+    for (int m = 0; m < MOTORS_PER_CHANNEL; ++m) {
+        const int k = channel * MOTORS_PER_CHANNEL + m;
+        Motor::Command_t cmd;
+        cmd.tor_des = c.tor[k];
+        cmd.spd_des = c.spd[k];
+        cmd.pos_des = c.pos[k];
+        cmd.k_pos = c.k_pos[k];
+        cmd.k_spd = c.k_spd[k];
+        g_motors[channel][m].setCommand(cmd);
+    }
+    return true;
+}
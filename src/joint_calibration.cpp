@@ -0,0 +1,107 @@
+#include "joint_calibration.hpp"
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+
+// 协议定点数的换算常数
+static constexpr float TWO_PI = 6.28318f;
+static constexpr float RAW_TOR_UNIT = 1.0f / 256.0f;             // 转矩: 1/256 N·m
+static constexpr float RAW_SPD_UNIT = TWO_PI / 256.0f;           // 速度: 1/256 转/秒 -> rad/s
+static constexpr float RAW_POS_UNIT = TWO_PI / 32768.0f;         // 位置: 1/32768 转 -> rad
+
+/**
+ * 由标定表生成换算系数，可在编译期求值
+ */
+static constexpr JointCalibrationTable_t build_table(const JointCalibration_t* calib) {
+    JointCalibrationTable_t t{};
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        const float sign = calib[j].sign;
+        const float ratio = calib[j].ratio;
+        t.offset[j] = calib[j].offset;
+        t.out_per_rotor[j] = sign / ratio;
+        t.rotor_per_out[j] = sign * ratio;
+        t.tor_out_scale[j] = sign * ratio;
+        t.tor_rotor_scale[j] = sign / ratio;
+        t.raw_tor_scale[j] = sign * ratio * RAW_TOR_UNIT;
+        t.raw_spd_scale[j] = sign / ratio * RAW_SPD_UNIT;
+        t.raw_pos_scale[j] = sign / ratio * RAW_POS_UNIT;
+    }
+    return t;
+}
+
+// 默认标定表在编译期生成，静态初始化阶段即可使用
+JointCalibrationTable_t g_joint_calibration = build_table(DEFAULT_JOINT_CALIBRATION);
+
+void joint_calibration_set(const JointCalibration_t calib[NUM_JOINTS]) {
+    g_joint_calibration = build_table(calib);
+}
+
+/**
+ * 从文本文件加载标定表
+ * 文件中未出现的关节保持默认值
+ */
+bool joint_calibration_load(const char* path) {
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL) {
+        std::cerr << "Failed to open joint calibration file " << path << std::endl;
+        return false;
+    }
+
+    JointCalibration_t calib[NUM_JOINTS];
+    memcpy(calib, DEFAULT_JOINT_CALIBRATION, sizeof(calib));
+
+    char line[256];
+    int line_no = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        line_no++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+
+        int channel, motor;
+        float sign, offset, ratio;
+        if (sscanf(line, "%d %d %f %f %f", &channel, &motor, &sign, &offset, &ratio) != 5 ||
+            channel < 0 || channel >= NUM_CHANNELS || motor < 0 || motor >= MOTORS_PER_CHANNEL ||
+            (sign != 1.0f && sign != -1.0f) || ratio <= 0.0f) {
+            std::cerr << "Invalid joint calibration at " << path << ":" << line_no << std::endl;
+            ok = false;
+            break;
+        }
+        calib[channel * MOTORS_PER_CHANNEL + motor] = {sign, offset, ratio};
+    }
+    fclose(fp);
+
+    if (ok) {
+        joint_calibration_set(calib);
+    }
+    return ok;
+}
+
+void joint_raw_to_output(const JointRawFeedback_t& raw, JointState_t& out) {
+    const JointCalibrationTable_t& t = g_joint_calibration;
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        out.tor[j] = (float)raw.torque[j] * t.raw_tor_scale[j];
+        out.spd[j] = (float)raw.speed[j] * t.raw_spd_scale[j];
+        out.pos[j] = (float)raw.pos[j] * t.raw_pos_scale[j] - t.offset[j];
+    }
+}
+
+void joint_rotor_to_output(const JointState_t& rotor, JointState_t& out) {
+    const JointCalibrationTable_t& t = g_joint_calibration;
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        out.tor[j] = rotor.tor[j] * t.tor_out_scale[j];
+        out.spd[j] = rotor.spd[j] * t.out_per_rotor[j];
+        out.pos[j] = rotor.pos[j] * t.out_per_rotor[j] - t.offset[j];
+    }
+}
+
+void joint_output_to_rotor(const JointCommand_t& target, JointCommand_t& rotor) {
+    const JointCalibrationTable_t& t = g_joint_calibration;
+    const float gain_scale = 1.0f / (GEAR_RATIO * GEAR_RATIO);  // 增益需要考虑两次减速比
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        rotor.tor[j] = target.tor[j] * t.tor_rotor_scale[j];
+        rotor.spd[j] = target.spd[j] * t.rotor_per_out[j];
+        rotor.pos[j] = (target.pos[j] + t.offset[j]) * t.rotor_per_out[j];
+        rotor.k_pos[j] = target.k_pos[j] * gain_scale;
+        rotor.k_spd[j] = target.k_spd[j] * gain_scale;
+    }
+}
@@ -6,15 +6,19 @@
 #include <unistd.h>
 #include <cstring>
 #include <atomic>
-#include <mutex>
 #include "motor_control.hpp"
 #include "serial_init.hpp"
+#include "joint_bus.hpp"
+#include "motor_scheduler.hpp"
+#include "motor_metrics.hpp"
+#include "periodic_loop.hpp"
+#include "rt_memory.hpp"
 #include "common.hpp"
 
 // 全局变量
-std::vector<std::vector<Motor>> g_motors(NUM_CHANNELS, std::vector<Motor>(MOTORS_PER_CHANNEL));
+Motor g_motors[NUM_CHANNELS][MOTORS_PER_CHANNEL];
 std::atomic<bool> g_running(true);
-std::mutex g_motor_mutex;
+const char* g_motor_port_prefix = "/dev/ttyMotor";
 
 /**
  * 电机控制线程函数
@@ -22,8 +26,8 @@ std::mutex g_motor_mutex;
 void channel_thread(int channel) {
     // 构造串口设备名
     char channel_letter = 'A' + channel; // channel为0-3，对应A-D
-    char port_name[20];
-    snprintf(port_name, sizeof(port_name), "/dev/ttyMotor%c", channel_letter);
+    char port_name[128];
+    snprintf(port_name, sizeof(port_name), "%s%c", g_motor_port_prefix, channel_letter);
 
     // 初始化串口
     int fd = initialize_serial_port(port_name);
@@ -35,65 +39,44 @@ void channel_thread(int channel) {
     // 切换回阻塞模式
     fcntl(fd, F_SETFL, 0);
 
-    uint8_t recv_buffer[MAX_BUFFER_SIZE];
-    int current_motor = 0;
-    int retry_count = 0;
+    MotorFrameParser parser;      // 本通道的应答帧解析器
+    ChannelScheduler scheduler(channel);  // 按周期预算安排3个电机的收发与重试
+    uint32_t bus_version = 0; // 已应用的关节总线命令版本
 
-    // 初始化发送缓冲区
-    std::vector<Motor::ControlData_t> send_buffer(MOTORS_PER_CHANNEL);
-    for (int i = 0; i < MOTORS_PER_CHANNEL; ++i) {
-        send_buffer[i] = g_motors[channel][i].createControlPacket(i);
-    }
-
-    auto next_send_time = std::chrono::steady_clock::now();
+    // 1ms周期；超期时丢弃错过的节拍，不连续补发积压的周期
+    char loop_name[PERIODIC_LOOP_NAME_LEN];
+    snprintf(loop_name, sizeof(loop_name), "channel%d", channel);
+    PeriodicLoop loop(loop_name, std::chrono::milliseconds(1), OverrunPolicy::SKIP);
+    auto last_cycle_start = std::chrono::steady_clock::now();
+    uint32_t warmup = RT_ALLOC_WARMUP_CYCLES; // 热身结束后检查本线程的内存分配
 
     while (g_running) {
-        next_send_time += std::chrono::milliseconds(1);
-        for (int motor_idx = 0; motor_idx < MOTORS_PER_CHANNEL; ++motor_idx) {
-            // 获取当前电机的控制参数
-            Motor::ControlData_t cmd;
-            {
-                std::lock_guard<std::mutex> lock(g_motor_mutex);
-                cmd = g_motors[channel][current_motor].createControlPacket(current_motor);
-            }
-
-            // 发送命令并等待响应
-            Motor::RecvData_t response;
-            bool success = false;
-
-            // 尝试发送和接收，最多重试MAX_RETRY_COUNT次
-            for (retry_count = 0; retry_count < MAX_RETRY_COUNT; ++retry_count) {
-                success = send_command_and_wait(fd, cmd, response, current_motor);
-                if (success) break;
-
-                // 重试前短暂延时
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
-            }
-
-            if (success) {
-                // 更新电机反馈数据
-                {
-                    std::lock_guard<std::mutex> lock(g_motor_mutex);
-                    g_motors[channel][current_motor].updateFeedback(response);
-                    g_motors[channel][current_motor].incrementSendCount();
-                    g_motors[channel][current_motor].incrementReceiveCount();
-                }
-            } else {
-                // 记录发送失败
-                {
-                    std::lock_guard<std::mutex> lock(g_motor_mutex);
-                    g_motors[channel][current_motor].incrementSendCount();
-                }
-                std::cerr << "Failed to communicate with motor " << current_motor 
-                          << " after " << MAX_RETRY_COUNT << " retries" << std::endl;
-            }
-            // 切换到下一个电机
-            current_motor = (current_motor + 1) % MOTORS_PER_CHANNEL;
-        }
-        // 等待直到下一次发送时间
-        std::this_thread::sleep_until(next_send_time);
+        if (warmup > 0 && --warmup == 0) rt_alloc_guard_arm(loop_name);
+        auto cycle_start = std::chrono::steady_clock::now();
+        motor_metrics_record_period(channel, (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            cycle_start - last_cycle_start).count());
+        last_cycle_start = cycle_start;
+        // 本周期3个电机使用同一次发布的命令
+        joint_bus_apply(channel, bus_version);
+        // 重试不再睡眠，预算不足的电机顺延到下个周期
+        scheduler.run_cycle(fd, parser, loop.deadline());
+        motor_metrics_record_busy(channel, (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - cycle_start).count());
+        // 等待直到下一个周期
+        loop.wait();
     }
 
     // 关闭串口
     close(fd);
-}
\ No newline at end of file
+}
+
+/**
+ * 读取全部电机的反馈快照
+ */
+void motor_feedback_snapshot(Motor::Feedback_t out[NUM_CHANNELS][MOTORS_PER_CHANNEL]) {
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
+            out[i][j] = g_motors[i][j].getFeedback();
+        }
+    }
+}
@@ -0,0 +1,229 @@
+#include "motor_emulator.hpp"
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include "protocol_codec.hpp"
+#include "rt_util.hpp"
+
+MotorEmulator::MotorEmulator() : running(false) {
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        master_fd[i] = -1;
+        slave_fd[i] = -1;
+        bad_frame_count[i] = 0;
+        last_reply_ns[i] = 0;
+        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
+            config[i][j] = {100, 0, 0.0f, 0.0f, 0};  // 默认100us，约为4Mbps下一问一答的线上时间
+            state[i][j] = {0, 0, 0};
+            request_count[i][j] = 0;
+            drop_count[i][j] = 0;
+        }
+    }
+}
+
+MotorEmulator::~MotorEmulator() {
+    stop();
+}
+
+void MotorEmulator::setMotorConfig(int channel, int motor, const MotorConfig_t& cfg) {
+    config[channel][motor] = cfg;
+}
+
+void MotorEmulator::setAllMotorConfig(const MotorConfig_t& cfg) {
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
+            config[i][j] = cfg;
+        }
+    }
+}
+
+/**
+ * 创建PTY并建立符号链接
+ * @param link_dir 链接目录，生成link_dir/ttyMotorA..D
+ */
+bool MotorEmulator::start(const char* link_dir) {
+    this->link_dir = link_dir;
+    port_prefix = this->link_dir + "/ttyMotor";
+
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        master_fd[i] = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master_fd[i] < 0 || grantpt(master_fd[i]) != 0 || unlockpt(master_fd[i]) != 0) {
+            std::cerr << "[EMU] Failed to create pty for channel " << i << ": " << strerror(errno) << std::endl;
+            stop();
+            return false;
+        }
+        const char* slave_name = ptsname(master_fd[i]);
+        slave_fd[i] = open(slave_name, O_RDWR | O_NOCTTY);
+        if (slave_fd[i] < 0) {
+            std::cerr << "[EMU] Failed to open " << slave_name << ": " << strerror(errno) << std::endl;
+            stop();
+            return false;
+        }
+
+        // 从端设为原始模式，避免行规程改写二进制数据
+        struct termios tty;
+        tcgetattr(slave_fd[i], &tty);
+        cfmakeraw(&tty);
+        tcsetattr(slave_fd[i], TCSANOW, &tty);
+
+        std::string link_name = port_prefix + (char)('A' + i);
+        unlink(link_name.c_str());
+        if (symlink(slave_name, link_name.c_str()) != 0) {
+            std::cerr << "[EMU] Failed to link " << link_name << ": " << strerror(errno) << std::endl;
+            stop();
+            return false;
+        }
+    }
+
+    running = true;
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        threads.emplace_back(&MotorEmulator::channel_loop, this, i);
+    }
+    return true;
+}
+
+void MotorEmulator::stop() {
+    running = false;
+    for (auto& t : threads) {
+        t.join();
+    }
+    threads.clear();
+
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        if (master_fd[i] >= 0) close(master_fd[i]);
+        if (slave_fd[i] >= 0) close(slave_fd[i]);
+        master_fd[i] = -1;
+        slave_fd[i] = -1;
+        if (!port_prefix.empty()) {
+            unlink((port_prefix + (char)('A' + i)).c_str());
+        }
+    }
+}
+
+/**
+ * 按命令更新电机状态并构建应答包
+ * 位置增益不为0时认为电机瞬间到达目标位置，否则按目标速度积分
+ */
+Motor::RecvData_t MotorEmulator::create_response(int channel, const Motor::ControlData_t& cmd) {
+    MotorState_t& s = state[channel][cmd.mode.id];
+
+    s.torque = cmd.comd.tor_des;
+    s.speed = cmd.comd.spd_des;
+    if (cmd.comd.k_pos != 0) {
+        s.pos = cmd.comd.pos_des;
+    } else {
+        // 速度单位: 1/256 转每秒，位置单位: 1/32768 转，按1ms控制周期积分
+        s.pos += (int32_t)s.speed * 128 / 1000;
+    }
+
+    Motor::RecvData_t resp;
+    memset(&resp, 0, sizeof(resp));
+    resp.mode.id = cmd.mode.id;
+    resp.mode.status = cmd.mode.status;
+    resp.mode.reserve = 0;
+    resp.fbk.torque = s.torque;
+    resp.fbk.speed = s.speed;
+    resp.fbk.pos = s.pos;
+    resp.fbk.temp = 30;
+    resp.fbk.MError = 0;
+    resp.fbk.force = 0;
+    motor_frame_seal(resp);
+    return resp;
+}
+
+/**
+ * 单个通道的应答线程
+ * 在主端按帧头0xFE 0xEE重同步，CRC正确后按电机配置延时应答
+ */
+void MotorEmulator::channel_loop(int channel) {
+    // 缩小定时器松弛量，使微秒级延时更准确
+    prctl(PR_SET_TIMERSLACK, 1UL);
+
+    std::mt19937 rng(channel + 1);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+    uint8_t buffer[MAX_BUFFER_SIZE];
+    size_t len = 0;
+    const size_t frame_len = sizeof(Motor::ControlData_t);
+
+    while (running) {
+        struct pollfd pfd = {master_fd[channel], POLLIN, 0};
+        int ready = poll(&pfd, 1, 50);
+        if (ready <= 0 || !(pfd.revents & POLLIN)) continue;
+
+        ssize_t n = read(master_fd[channel], buffer + len, sizeof(buffer) - len);
+        if (n <= 0) continue;
+        auto recv_time = std::chrono::steady_clock::now();
+        len += n;
+
+        size_t off = 0;
+        while (len - off >= frame_len) {
+            if (buffer[off] != 0xFE || buffer[off + 1] != 0xEE) {
+                ++off;
+                continue;
+            }
+            Motor::ControlData_t cmd;
+            memcpy(&cmd, buffer + off, frame_len);
+            if (!motor_frame_verify(cmd) || cmd.mode.id >= MOTORS_PER_CHANNEL) {
+                bad_frame_count[channel]++;
+                ++off;
+                continue;
+            }
+            off += frame_len;
+
+            int motor = cmd.mode.id;
+            request_count[channel][motor]++;
+            const MotorConfig_t& cfg = config[channel][motor];
+            Motor::RecvData_t resp = create_response(channel, cmd);
+
+            if (uniform(rng) < cfg.drop_rate) {
+                drop_count[channel][motor]++;
+                continue;
+            }
+
+            // 按配置延时后应答
+            uint32_t delay_us = cfg.latency_us;
+            if (cfg.jitter_us > 0) {
+                delay_us += (uint32_t)(uniform(rng) * cfg.jitter_us);
+            }
+            auto deadline = recv_time + std::chrono::microseconds(delay_us);
+            struct timespec ts;
+            auto ns = steady_ns(deadline);
+            ts.tv_sec = ns / 1000000000;
+            ts.tv_nsec = ns % 1000000000;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+            // 按概率插入杂散字节（含一个伪帧头字节）
+            if (uniform(rng) < cfg.garbage_rate) {
+                static const uint8_t garbage[] = {0xFD, 0x00, 0x55};
+                write(master_fd[channel], garbage, 1 + (size_t)(uniform(rng) * 2.99f));
+            }
+
+            // 记录应答最后一段写出前的时刻，被测程序最早在此之后才能收齐整帧
+            const uint8_t* p = (const uint8_t*)&resp;
+            size_t first = cfg.split_gap_us > 0 ? sizeof(resp) / 2 : 0;
+            ssize_t written = 0;
+            if (first > 0) {
+                written += write(master_fd[channel], p, first);
+                std::this_thread::sleep_for(std::chrono::microseconds(cfg.split_gap_us));
+            }
+            last_reply_ns[channel] = steady_ns();
+            written += write(master_fd[channel], p + first, sizeof(resp) - first);
+            if (written != (ssize_t)sizeof(resp)) {
+                std::cerr << "[EMU] Failed to write response on channel " << channel << std::endl;
+            }
+        }
+
+        // 保留未处理完的半帧
+        memmove(buffer, buffer + off, len - off);
+        len -= off;
+    }
+}
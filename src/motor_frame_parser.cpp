@@ -0,0 +1,62 @@
+#include "motor_frame_parser.hpp"
+#include <cstring>
+#include <unistd.h>
+#include "protocol_codec.hpp"
+
+MotorFrameParser::MotorFrameParser() : head(0), tail(0),
+                                       crc_error_count(0), resync_byte_count(0) {}
+
+/**
+ * 获取可写入的连续空间
+ * 尾部剩余空间不足一帧时，把未解析的半帧(不足一帧长度)搬到缓冲区开头
+ */
+uint8_t* MotorFrameParser::write_ptr() {
+    if (head == tail) {
+        head = 0;
+        tail = 0;
+    } else if (BUFFER_SIZE - tail < FRAME_SIZE * 2) {
+        size_t len = tail - head;
+        memmove(buffer, buffer + head, len);
+        head = 0;
+        tail = len;
+    }
+    return buffer + tail;
+}
+
+ssize_t MotorFrameParser::read_from(int fd) {
+    uint8_t* p = write_ptr();
+    ssize_t n = read(fd, p, write_space());
+    if (n > 0) {
+        commit(n);
+    }
+    return n;
+}
+
+/**
+ * 取出下一个完整应答帧
+ * 帧头不对时用memchr跳到下一个0xFD，CRC错误时只跳过一个字节继续重同步
+ */
+const Motor::RecvData_t* MotorFrameParser::next_frame() {
+    while (tail - head >= FRAME_SIZE) {
+        uint8_t* p = buffer + head;
+        if (p[0] != 0xFD || p[1] != 0xEE) {
+            const uint8_t* q = (const uint8_t*)memchr(p + 1, 0xFD, tail - head - 1);
+            size_t next = q ? (size_t)(q - buffer) : tail;
+            resync_byte_count += next - head;
+            head = next;
+            continue;
+        }
+
+        // 帧头已经匹配，校验失败即CRC错误
+        if (!motor_frame_verify<Motor::RecvData_t>(p)) {
+            crc_error_count++;
+            resync_byte_count++;
+            head++;
+            continue;
+        }
+
+        head += FRAME_SIZE;
+        return reinterpret_cast<const Motor::RecvData_t*>(p);
+    }
+    return nullptr;
+}
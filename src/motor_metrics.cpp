@@ -0,0 +1,185 @@
+#include "motor_metrics.hpp"
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include "motor_control.hpp"
+#include "periodic_loop.hpp"
+#include "rt_memory.hpp"
+#include "imu.hpp"
+#include "policy_pipeline.hpp"
+
+/**
+ * 全部直方图，每个电机或通道的直方图只由它所在的通道线程(或反应器线程)写入
+ */
+struct MotorMetricsShared {
+    LatencyHistogram rtt_us[NUM_CHANNELS][MOTORS_PER_CHANNEL];
+    LatencyHistogram retries[NUM_CHANNELS][MOTORS_PER_CHANNEL];
+    LatencyHistogram period_us[NUM_CHANNELS];
+    LatencyHistogram busy_us[NUM_CHANNELS];
+};
+
+static MotorMetricsShared g_metrics;
+
+void motor_metrics_record_rtt(int channel, int motor, uint32_t rtt_us) {
+    g_metrics.rtt_us[channel][motor].record(rtt_us);
+}
+
+void motor_metrics_record_retries(int channel, int motor, uint32_t retries) {
+    g_metrics.retries[channel][motor].record(retries);
+}
+
+void motor_metrics_record_period(int channel, uint32_t period_us) {
+    g_metrics.period_us[channel].record(period_us);
+}
+
+void motor_metrics_record_busy(int channel, uint32_t busy_us) {
+    g_metrics.busy_us[channel].record(busy_us);
+}
+
+void motor_metrics_snapshot(MotorMetricsSnapshot_t& out) {
+    out.stamp_s = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
+            g_metrics.rtt_us[i][j].snapshot(out.rtt_us[i][j]);
+            g_metrics.retries[i][j].snapshot(out.retries[i][j]);
+            out.sent[i][j] = g_motors[i][j].getSendCount();
+            out.received[i][j] = g_motors[i][j].getReceiveCount();
+        }
+        g_metrics.period_us[i].snapshot(out.period_us[i]);
+        g_metrics.busy_us[i].snapshot(out.busy_us[i]);
+    }
+}
+
+// 计数器可能被resetStats()清零，此时直接使用新值
+static uint64_t counter_delta(uint64_t now, uint64_t prev) {
+    return now >= prev ? now - prev : now;
+}
+
+void motor_metrics_subtract(const MotorMetricsSnapshot_t& now, const MotorMetricsSnapshot_t& prev,
+                            MotorMetricsSnapshot_t& out) {
+    out.stamp_s = now.stamp_s;
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
+            latency_hist_subtract(now.rtt_us[i][j], prev.rtt_us[i][j], out.rtt_us[i][j]);
+            latency_hist_subtract(now.retries[i][j], prev.retries[i][j], out.retries[i][j]);
+            out.sent[i][j] = counter_delta(now.sent[i][j], prev.sent[i][j]);
+            out.received[i][j] = counter_delta(now.received[i][j], prev.received[i][j]);
+        }
+        latency_hist_subtract(now.period_us[i], prev.period_us[i], out.period_us[i]);
+        latency_hist_subtract(now.busy_us[i], prev.busy_us[i], out.busy_us[i]);
+    }
+}
+
+/**
+ * 打印每个电机和每个通道的分位数表
+ * 丢失率按发送次数(含重试)计算，Retry列为每条命令完成前的重试次数
+ */
+void print_motor_metrics(const MotorMetricsSnapshot_t& s) {
+    std::cout << "Channel | Motor |   Sent | Received | Loss Rate | Retry p99 | Retry max | RTT p50 | RTT p99 | RTT p99.9 | RTT max (us)\n";
+    std::cout << "--------|-------|--------|----------|-----------|-----------|-----------|---------|---------|-----------|-------------\n";
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
+            uint64_t sent = s.sent[i][j];
+            uint64_t received = s.received[i][j];
+            uint64_t lost = sent > received ? sent - received : 0;
+            double loss_rate = sent > 0 ? (double)lost / sent * 100 : 0;
+            const LatencyHistSnapshot_t& rtt = s.rtt_us[i][j];
+            printf("%7d | %5d | %6lu | %8lu | %8.2f%% | %9u | %9u | %7u | %7u | %9u | %12u\n",
+                   i, j, sent, received, loss_rate,
+                   latency_hist_quantile(s.retries[i][j], 0.99), latency_hist_max(s.retries[i][j]),
+                   latency_hist_quantile(rtt, 0.5), latency_hist_quantile(rtt, 0.99),
+                   latency_hist_quantile(rtt, 0.999), latency_hist_max(rtt));
+        }
+    }
+    std::cout << std::endl;
+
+    std::cout << "Channel | Cycles | Period p50 | Period p99 | Period max | Busy p50 | Busy p99 | Busy max | Bus RTT p99 (us)\n";
+    std::cout << "--------|--------|------------|------------|------------|----------|----------|----------|-----------------\n";
+    std::unique_ptr<LatencyHistSnapshot_t> bus_rtt(new LatencyHistSnapshot_t);
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        latency_hist_clear(*bus_rtt);
+        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) latency_hist_merge(*bus_rtt, s.rtt_us[i][j]);
+        const LatencyHistSnapshot_t& period = s.period_us[i];
+        const LatencyHistSnapshot_t& busy = s.busy_us[i];
+        printf("%7d | %6lu | %10u | %10u | %10u | %8u | %8u | %8u | %16u\n",
+               i, busy.total,
+               latency_hist_quantile(period, 0.5), latency_hist_quantile(period, 0.99), latency_hist_max(period),
+               latency_hist_quantile(busy, 0.5), latency_hist_quantile(busy, 0.99), latency_hist_max(busy),
+               latency_hist_quantile(*bus_rtt, 0.99));
+    }
+    std::cout << std::endl;
+}
+
+static void export_hist_row(FILE* fp, double stamp_s, const char* metric, int channel, int motor,
+                            const LatencyHistSnapshot_t& h) {
+    fprintf(fp, "%.3f,%s,%d,%d,%lu,%.1f,%u,%u,%u,%u,%u\n",
+            stamp_s, metric, channel, motor, h.total, latency_hist_mean(h),
+            latency_hist_quantile(h, 0.5), latency_hist_quantile(h, 0.9), latency_hist_quantile(h, 0.99),
+            latency_hist_quantile(h, 0.999), latency_hist_max(h));
+}
+
+/**
+ * 以CSV格式追加一段统计
+ * 通道级的指标motor列为-1
+ */
+void export_motor_metrics_csv(FILE* fp, const MotorMetricsSnapshot_t& s, bool header) {
+    if (header) {
+        fprintf(fp, "stamp_s,metric,channel,motor,count,mean,p50,p90,p99,p999,max\n");
+    }
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
+            export_hist_row(fp, s.stamp_s, "rtt_us", i, j, s.rtt_us[i][j]);
+            export_hist_row(fp, s.stamp_s, "retries", i, j, s.retries[i][j]);
+        }
+        export_hist_row(fp, s.stamp_s, "period_us", i, -1, s.period_us[i]);
+        export_hist_row(fp, s.stamp_s, "busy_us", i, -1, s.busy_us[i]);
+    }
+    fflush(fp);
+}
+
+/**
+ * 报告线程
+ * 普通优先级运行，每次取快照后与上一次相减，只报告这段时间内的分布
+ */
+void motor_metrics_reporter_thread(int period_ms, const char* csv_path) {
+    std::unique_ptr<MotorMetricsSnapshot_t> prev(new MotorMetricsSnapshot_t);
+    std::unique_ptr<MotorMetricsSnapshot_t> now(new MotorMetricsSnapshot_t);
+    std::unique_ptr<MotorMetricsSnapshot_t> delta(new MotorMetricsSnapshot_t);
+
+    FILE* fp = NULL;
+    if (csv_path != NULL) {
+        fp = fopen(csv_path, "w");
+        if (fp == NULL) {
+            std::cerr << "Failed to open metrics file " << csv_path << std::endl;
+        }
+    }
+
+    motor_metrics_snapshot(*prev);
+    bool header = true;
+    auto next_report = std::chrono::steady_clock::now();
+    while (g_running) {
+        next_report += std::chrono::milliseconds(period_ms);
+        // 分段睡眠，退出时不必等满一个报告周期
+        while (g_running && std::chrono::steady_clock::now() < next_report) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        if (!g_running) break;
+
+        motor_metrics_snapshot(*now);
+        motor_metrics_subtract(*now, *prev, *delta);
+        print_motor_metrics(*delta);
+        print_periodic_loop_statistics();
+        print_imu_statistics();
+        print_imu_age_statistics();
+        print_policy_pipeline_statistics();
+        rt_alloc_check();  // 实时线程热身后新出现的内存分配
+        if (fp != NULL) {
+            export_motor_metrics_csv(fp, *delta, header);
+            header = false;
+        }
+        std::swap(prev, now);
+    }
+
+    if (fp != NULL) fclose(fp);
+}
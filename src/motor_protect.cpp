@@ -1,18 +1,13 @@
 #include <iostream>
 #include "motor_protect.hpp"
 #include "common.hpp"
-#include "motor.hpp"
-#include "motor_control.hpp"
+#include "joint_bus.hpp"
 
 
 /**
  * 电机阻尼保护函数
+ * 12个关节同时切换到阻尼模式，只保留速度增益
  */
-void motor_protect() {           
-    for (int i = 0; i < NUM_CHANNELS; ++i) {
-                    for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
-                        // 设置电机进入阻尼保护模式
-                        g_motors[i][j].Motor_SetControlParams(i, j, 0, 0, 0, 0, 5.0f); // 设置阻尼保护参数,速度增益
-                    }
-                }
-}
\ No newline at end of file
+void motor_protect() {
+    joint_bus_publish_uniform(0, 0, 0, 0, 5.0f); // 设置阻尼保护参数,速度增益
+}
@@ -0,0 +1,328 @@
+#include "motor_reactor.hpp"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include "motor_control.hpp"
+#include "motor_frame_parser.hpp"
+#include "serial_init.hpp"
+#include "joint_bus.hpp"
+#include "motor_metrics.hpp"
+#include "motor_scheduler.hpp"
+#include "rt_memory.hpp"
+#include "rt_util.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * 单条总线的收发状态
+ */
+struct ReactorChannel {
+    int fd;
+    MotorFrameParser parser;
+    Motor::ControlData_t cmd;   // 当前等待应答的命令
+    int motor;                  // 当前等待应答的电机编号
+    int done;                   // 本周期已处理完的电机数
+    int start_motor;            // 本周期从哪个电机开始
+    int exchanges;              // 本周期已发送的命令数
+    int attempt[MOTORS_PER_CHANNEL]; // 当前命令已连续超时的次数，跨周期保留
+    RttEstimator rtt[MOTORS_PER_CHANNEL];
+    uint32_t bus_version;       // 已应用的关节总线命令版本
+    bool busy;                  // 本周期的一问一答序列是否还在进行
+    Clock::time_point cycle_start;
+    Clock::time_point cycle_end; // 本周期的截止时刻(下一个节拍)
+    Clock::time_point last_cycle_start; // 上一周期的开始时刻，用于统计周期间隔
+    Clock::time_point sent_at;  // 当前命令的发送时刻
+    Clock::time_point deadline; // 当前命令的应答超时时刻
+};
+
+/**
+ * 跨线程发布的周期统计，反应器线程写，其他线程只读
+ */
+struct ReactorStatsShared {
+    std::atomic<uint64_t> cycles{0};
+    std::atomic<uint64_t> overruns{0};
+    std::atomic<uint64_t> timeouts{0};
+    std::atomic<uint64_t> failures{0};
+    std::atomic<uint64_t> skips{0};
+    std::atomic<double> last_cycle_us{0};
+    std::atomic<double> min_cycle_us{0};
+    std::atomic<double> max_cycle_us{0};
+    std::atomic<double> sum_cycle_us{0};
+};
+
+static ReactorStatsShared g_reactor_stats[NUM_CHANNELS];
+
+// 结束本周期，记录周期耗时
+static void reactor_finish_cycle(ReactorChannel& ch, int channel) {
+    ch.busy = false;
+    double cycle_us = std::chrono::duration<double, std::micro>(Clock::now() - ch.cycle_start).count();
+    motor_metrics_record_busy(channel, (uint32_t)cycle_us);
+    ReactorStatsShared& st = g_reactor_stats[channel];
+    uint64_t n = st.cycles.load(std::memory_order_relaxed);
+    st.last_cycle_us.store(cycle_us, std::memory_order_relaxed);
+    st.sum_cycle_us.store(st.sum_cycle_us.load(std::memory_order_relaxed) + cycle_us, std::memory_order_relaxed);
+    if (n == 0 || cycle_us < st.min_cycle_us.load(std::memory_order_relaxed)) {
+        st.min_cycle_us.store(cycle_us, std::memory_order_relaxed);
+    }
+    if (cycle_us > st.max_cycle_us.load(std::memory_order_relaxed)) {
+        st.max_cycle_us.store(cycle_us, std::memory_order_relaxed);
+    }
+    st.cycles.store(n + 1, std::memory_order_release);
+}
+
+/**
+ * 发送当前电机的命令并设置超时时刻
+ * 超时取该电机的RTT估计(与ChannelScheduler相同)，且不超过一个节拍；
+ * 本周期已有交互时，首次发送要求剩余预算不小于RTT p99，重试要求剩余预算不小于超时，
+ * 否则本电机和之后的电机顺延到下个周期，避免一个不应答的电机占住总线好几个节拍
+ */
+static void reactor_send(ReactorChannel& ch, int channel) {
+    const int m = ch.motor;
+    const long timeout_us = std::min(ch.rtt[m].timeout_us(ch.attempt[m]), (long)REACTOR_TICK_US);
+    const long required_us = ch.attempt[m] == 0 ? ch.rtt[m].quantile_us(0.99) : timeout_us;
+    auto now = Clock::now();
+    long remaining_us = std::chrono::duration_cast<std::chrono::microseconds>(ch.cycle_end - now).count();
+    if (ch.exchanges > 0 && remaining_us < required_us) {
+        bump(g_reactor_stats[channel].skips, MOTORS_PER_CHANNEL - ch.done);
+        ch.start_motor = m;
+        reactor_finish_cycle(ch, channel);
+        return;
+    }
+
+    ch.exchanges++;
+    ch.cmd = g_motors[channel][m].createControlPacket(m);
+    ch.parser.reset();
+    ssize_t bytes_written = write(ch.fd, &ch.cmd, sizeof(Motor::ControlData_t));
+    if (bytes_written != sizeof(Motor::ControlData_t)) {
+        std::cerr << "Failed to send command to motor " << m
+                  << ". Bytes written: " << bytes_written << std::endl;
+    }
+    ch.sent_at = Clock::now();
+    ch.deadline = ch.sent_at + std::chrono::microseconds(timeout_us);
+}
+
+// 当前电机处理完毕(成功或放弃)，切换到下一个电机或结束本周期
+static void reactor_advance(ReactorChannel& ch, int channel) {
+    ch.attempt[ch.motor] = 0;
+    if (++ch.done < MOTORS_PER_CHANNEL) {
+        ch.motor = (ch.start_motor + ch.done) % MOTORS_PER_CHANNEL;
+        reactor_send(ch, channel);
+        return;
+    }
+
+    // 所有电机都已处理，下个周期从头开始
+    ch.start_motor = 0;
+    reactor_finish_cycle(ch, channel);
+}
+
+// 串口可读：把数据读入解析器，收到当前电机的应答后推进序列
+static void reactor_on_readable(ReactorChannel& ch, int channel) {
+    if (ch.parser.read_from(ch.fd) <= 0) return;
+    if (!ch.busy) {
+        // 周期结束后才到的迟到应答直接丢弃
+        ch.parser.reset();
+        return;
+    }
+
+    while (const Motor::RecvData_t* recv_packet = ch.parser.next_frame()) {
+        if (recv_packet->mode.id != ch.motor) continue;
+        long rtt_us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - ch.sent_at).count();
+        ch.rtt[ch.motor].add(rtt_us);
+        motor_metrics_record_rtt(channel, ch.motor, (uint32_t)rtt_us);
+        motor_metrics_record_retries(channel, ch.motor, (uint32_t)ch.attempt[ch.motor]);
+        g_motors[channel][ch.motor].updateFeedback(*recv_packet);
+        g_motors[channel][ch.motor].incrementSendCount();
+        g_motors[channel][ch.motor].incrementReceiveCount();
+        reactor_advance(ch, channel);
+        return;
+    }
+}
+
+// 应答超时：预算允许时立即重试，重试耗尽后放弃该电机
+static void reactor_on_timeout(ReactorChannel& ch, int channel) {
+    bump(g_reactor_stats[channel].timeouts);
+    tcflush(ch.fd, TCIFLUSH);
+    if (++ch.attempt[ch.motor] < MAX_RETRY_COUNT) {
+        reactor_send(ch, channel);
+        return;
+    }
+
+    bump(g_reactor_stats[channel].failures);
+    motor_metrics_record_retries(channel, ch.motor, (uint32_t)ch.attempt[ch.motor]);
+    g_motors[channel][ch.motor].incrementSendCount();
+    std::cerr << "Failed to communicate with motor " << ch.motor
+              << " after " << MAX_RETRY_COUNT << " retries" << std::endl;
+    reactor_advance(ch, channel);
+}
+
+/**
+ * 反应器线程函数
+ * 一个timerfd提供1ms节拍，每个节拍启动所有空闲总线的一问一答序列；
+ * 各总线的应答通过epoll事件驱动推进，互不等待
+ */
+void motor_reactor_thread() {
+    ReactorChannel channels[NUM_CHANNELS];
+
+    int epfd = epoll_create1(0);
+    if (epfd < 0) {
+        std::cerr << "epoll_create1() failed: " << strerror(errno) << std::endl;
+        return;
+    }
+
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        char port_name[128];
+        snprintf(port_name, sizeof(port_name), "%s%c", g_motor_port_prefix, 'A' + i);
+
+        // 保持非阻塞模式，读取由epoll事件驱动
+        channels[i].fd = initialize_serial_port(port_name);
+        channels[i].motor = 0;
+        channels[i].done = 0;
+        channels[i].start_motor = 0;
+        channels[i].exchanges = 0;
+        std::fill(channels[i].attempt, channels[i].attempt + MOTORS_PER_CHANNEL, 0);
+        channels[i].busy = false;
+        channels[i].bus_version = 0;
+        if (channels[i].fd < 0) {
+            std::cerr << "Failed to initialize port " << port_name << std::endl;
+            continue;
+        }
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, channels[i].fd, &ev);
+    }
+
+    // 1ms周期节拍
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    struct itimerspec its;
+    its.it_interval.tv_sec = 0;
+    its.it_interval.tv_nsec = REACTOR_TICK_US * 1000;
+    its.it_value = its.it_interval;
+    timerfd_settime(tfd, 0, &its, NULL);
+    {
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u32 = NUM_CHANNELS;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, tfd, &ev);
+    }
+
+    struct epoll_event events[NUM_CHANNELS + 1];
+    uint32_t warmup = RT_ALLOC_WARMUP_CYCLES; // 热身结束后检查本线程的内存分配
+    while (g_running) {
+        // 计算最近的超时时刻，有半帧的通道使用更短的等待时间
+        // epoll_wait只有毫秒精度，但1ms节拍保证每毫秒至少唤醒一次
+        auto now = Clock::now();
+        auto wake = now + std::chrono::microseconds(REACTOR_TICK_US);
+        for (int i = 0; i < NUM_CHANNELS; ++i) {
+            ReactorChannel& ch = channels[i];
+            if (!ch.busy) continue;
+            auto t = ch.deadline;
+            if (ch.parser.pending() > 0) {
+                t = std::min(t, now + std::chrono::microseconds(RESYNC_POLL_US));
+            }
+            wake = std::min(wake, t);
+        }
+        int timeout_ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+            wake - now + std::chrono::microseconds(999)).count();
+
+        int n = epoll_wait(epfd, events, NUM_CHANNELS + 1, timeout_ms);
+        if (n < 0 && errno != EINTR) {
+            std::cerr << "epoll_wait() failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int e = 0; e < n; ++e) {
+            uint32_t idx = events[e].data.u32;
+            if (idx < NUM_CHANNELS) {
+                reactor_on_readable(channels[idx], idx);
+                continue;
+            }
+
+            // 1ms节拍：启动空闲总线的新周期，上一周期未完成的记为超期
+            uint64_t expirations = 0;
+            if (read(tfd, &expirations, sizeof(expirations)) != sizeof(expirations)) continue;
+            if (warmup > 0 && --warmup == 0) rt_alloc_guard_arm("motor_reactor");
+            for (int i = 0; i < NUM_CHANNELS; ++i) {
+                ReactorChannel& ch = channels[i];
+                if (ch.fd < 0) continue;
+                if (ch.busy) {
+                    bump(g_reactor_stats[i].overruns);
+                    continue;
+                }
+                ch.busy = true;
+                ch.done = 0;
+                ch.exchanges = 0;
+                ch.motor = ch.start_motor;
+                ch.cycle_start = Clock::now();
+                ch.cycle_end = ch.cycle_start + std::chrono::microseconds(REACTOR_TICK_US);
+                if (ch.last_cycle_start != Clock::time_point()) {
+                    motor_metrics_record_period(i, (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                        ch.cycle_start - ch.last_cycle_start).count());
+                }
+                ch.last_cycle_start = ch.cycle_start;
+                joint_bus_apply(i, ch.bus_version);
+                reactor_send(ch, i);
+            }
+        }
+
+        // 处理超时和半帧
+        now = Clock::now();
+        for (int i = 0; i < NUM_CHANNELS; ++i) {
+            ReactorChannel& ch = channels[i];
+            if (!ch.busy) continue;
+            if (now >= ch.deadline) {
+                reactor_on_timeout(ch, i);
+            } else if (ch.parser.pending() > 0) {
+                // 半帧剩余字节不足VMIN，不会触发epoll，非阻塞读取已到达的部分
+                reactor_on_readable(ch, i);
+            }
+        }
+    }
+
+    // 关闭串口
+    close(tfd);
+    close(epfd);
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        if (channels[i].fd >= 0) close(channels[i].fd);
+    }
+}
+
+ReactorChannelStats_t get_reactor_stats(int channel) {
+    const ReactorStatsShared& st = g_reactor_stats[channel];
+    ReactorChannelStats_t out;
+    out.cycles = st.cycles.load(std::memory_order_acquire);
+    out.overruns = st.overruns.load(std::memory_order_relaxed);
+    out.timeouts = st.timeouts.load(std::memory_order_relaxed);
+    out.failures = st.failures.load(std::memory_order_relaxed);
+    out.skips = st.skips.load(std::memory_order_relaxed);
+    out.last_cycle_us = st.last_cycle_us.load(std::memory_order_relaxed);
+    out.min_cycle_us = st.min_cycle_us.load(std::memory_order_relaxed);
+    out.max_cycle_us = st.max_cycle_us.load(std::memory_order_relaxed);
+    out.avg_cycle_us = out.cycles > 0 ? st.sum_cycle_us.load(std::memory_order_relaxed) / out.cycles : 0.0;
+    return out;
+}
+
+/**
+ * 打印所有通道的周期统计
+ */
+void print_reactor_statistics() {
+    std::cout << "Channel | Cycles | Overruns | Timeouts | Failures | Skips | Last(us) | Min(us) | Avg(us) | Max(us)\n";
+    std::cout << "--------|--------|----------|----------|----------|-------|----------|---------|---------|--------\n";
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        ReactorChannelStats_t st = get_reactor_stats(i);
+        printf("%7d | %6lu | %8lu | %8lu | %8lu | %5lu | %8.1f | %7.1f | %7.1f | %7.1f\n",
+               i, st.cycles, st.overruns, st.timeouts, st.failures, st.skips,
+               st.last_cycle_us, st.min_cycle_us, st.avg_cycle_us, st.max_cycle_us);
+    }
+    std::cout << std::endl;
+}
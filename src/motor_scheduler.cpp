@@ -0,0 +1,174 @@
+#include "motor_scheduler.hpp"
+#include <iostream>
+#include <atomic>
+#include <algorithm>
+#include <cstdio>
+#include "motor_control.hpp"
+#include "serial_init.hpp"
+#include "motor_metrics.hpp"
+#include "rt_util.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+static const long MAX_TIMEOUT_US = COMM_TIMEOUT_MS * 1000L;
+
+/**
+ * 跨线程发布的调度统计，通道线程写，其他线程只读
+ */
+struct MotorSchedStatsShared {
+    std::atomic<uint64_t> attempts{0};
+    std::atomic<uint64_t> successes{0};
+    std::atomic<uint64_t> timeouts{0};
+    std::atomic<uint64_t> failures{0};
+    std::atomic<uint64_t> skips{0};
+    std::atomic<uint64_t> lates{0};
+    std::atomic<uint32_t> timeout_us{0};
+    std::atomic<uint32_t> rtt_p50_us{0};
+    std::atomic<uint32_t> rtt_p99_us{0};
+};
+
+static MotorSchedStatsShared g_sched_stats[NUM_CHANNELS][MOTORS_PER_CHANNEL];
+
+RttEstimator::RttEstimator() : total(0) {
+    std::fill(counts, counts + NUM_BUCKETS, 0);
+}
+
+void RttEstimator::add(long rtt_us) {
+    int b = (int)(rtt_us / RTT_BUCKET_US);
+    if (b < 0) b = 0;
+    if (b >= NUM_BUCKETS) b = NUM_BUCKETS - 1;
+    counts[b]++;
+    if (++total >= MAX_SAMPLES) {
+        // 旧样本权重减半
+        total = 0;
+        for (int i = 0; i < NUM_BUCKETS; ++i) {
+            counts[i] >>= 1;
+            total += counts[i];
+        }
+    }
+}
+
+long RttEstimator::quantile_us(double q) const {
+    if (total == 0) return MAX_TIMEOUT_US;
+    uint32_t target = (uint32_t)(q * total);
+    uint32_t acc = 0;
+    for (int b = 0; b < NUM_BUCKETS - 1; ++b) {
+        acc += counts[b];
+        if (acc > target) return (long)(b + 1) * RTT_BUCKET_US;  // 取桶的上沿
+    }
+    return MAX_TIMEOUT_US;  // 落在溢出桶
+}
+
+long RttEstimator::timeout_us(int attempt) const {
+    if (total < RTT_MIN_SAMPLES) return MAX_TIMEOUT_US;
+    long t = std::max((long)RTT_TIMEOUT_MIN_US, 2 * quantile_us(0.99) + RTT_TIMEOUT_MARGIN_US);
+    if (attempt > 0) t *= 2;  // 超时过一次后放宽，避免总线变慢时估计值一直偏小
+    return std::min(t, MAX_TIMEOUT_US);
+}
+
+ChannelScheduler::ChannelScheduler(int channel) : channel(channel), start_motor(0) {
+    std::fill(attempt, attempt + MOTORS_PER_CHANNEL, 0);
+}
+
+/**
+ * 执行一个周期
+ * 每个周期至少进行一次交互，保证总线始终向前推进；之后的首次发送要求剩余预算不小于
+ * 该电机的RTT p99，重试要求剩余预算不小于超时估计。预算用完时剩下的电机记为跳过，
+ * 下个周期从第一个没有完成的电机开始
+ */
+void ChannelScheduler::run_cycle(int fd, MotorFrameParser& parser, Clock::time_point cycle_end) {
+    int exchanges = 0;
+
+    for (int n = 0; n < MOTORS_PER_CHANNEL; ++n) {
+        const int m = (start_motor + n) % MOTORS_PER_CHANNEL;
+        Motor& motor = g_motors[channel][m];
+        MotorSchedStatsShared& st = g_sched_stats[channel][m];
+
+        while (true) {
+            const long timeout_us = rtt[m].timeout_us(attempt[m]);
+            // 首次发送只要预计能在周期内收到应答即可；重试要求整段超时都在剩余预算内
+            const long required_us = attempt[m] == 0 ? rtt[m].quantile_us(0.99) : timeout_us;
+            auto now = Clock::now();
+            long remaining_us = std::chrono::duration_cast<std::chrono::microseconds>(cycle_end - now).count();
+            if (exchanges > 0 && remaining_us < required_us) {
+                // 预算不足：本电机和之后的电机顺延到下个周期
+                for (int k = n; k < MOTORS_PER_CHANNEL; ++k) {
+                    bump(g_sched_stats[channel][(start_motor + k) % MOTORS_PER_CHANNEL].skips);
+                }
+                start_motor = m;
+                return;
+            }
+
+            exchanges++;
+            bump(st.attempts);
+            Motor::ControlData_t cmd = motor.createControlPacket(m);
+            Motor::RecvData_t response;
+            bool success = send_command_and_wait(fd, cmd, response, m, parser, nullptr, timeout_us);
+            auto done = Clock::now();
+            motor.incrementSendCount();
+
+            if (success) {
+                long rtt_us = std::chrono::duration_cast<std::chrono::microseconds>(done - now).count();
+                rtt[m].add(rtt_us);
+                motor_metrics_record_rtt(channel, m, (uint32_t)rtt_us);
+                motor_metrics_record_retries(channel, m, (uint32_t)attempt[m]);
+                // 本线程是该电机反馈的唯一写者，无等待
+                motor.updateFeedback(response);
+                motor.incrementReceiveCount();
+                bump(st.successes);
+                if (done > cycle_end) bump(st.lates);
+                attempt[m] = 0;
+                break;
+            }
+
+            bump(st.timeouts);
+            if (++attempt[m] >= MAX_RETRY_COUNT) {
+                bump(st.failures);
+                motor_metrics_record_retries(channel, m, (uint32_t)attempt[m]);
+                std::cerr << "Failed to communicate with motor " << m
+                          << " after " << MAX_RETRY_COUNT << " retries" << std::endl;
+                attempt[m] = 0;
+                break;
+            }
+        }
+
+        st.timeout_us.store((uint32_t)rtt[m].timeout_us(0), std::memory_order_relaxed);
+        st.rtt_p50_us.store((uint32_t)rtt[m].quantile_us(0.5), std::memory_order_relaxed);
+        st.rtt_p99_us.store((uint32_t)rtt[m].quantile_us(0.99), std::memory_order_relaxed);
+    }
+
+    // 所有电机都已处理，下个周期从头开始
+    start_motor = 0;
+}
+
+MotorSchedStats_t get_motor_sched_stats(int channel, int motor) {
+    const MotorSchedStatsShared& st = g_sched_stats[channel][motor];
+    MotorSchedStats_t out;
+    out.attempts = st.attempts.load(std::memory_order_relaxed);
+    out.successes = st.successes.load(std::memory_order_relaxed);
+    out.timeouts = st.timeouts.load(std::memory_order_relaxed);
+    out.failures = st.failures.load(std::memory_order_relaxed);
+    out.skips = st.skips.load(std::memory_order_relaxed);
+    out.lates = st.lates.load(std::memory_order_relaxed);
+    out.timeout_us = st.timeout_us.load(std::memory_order_relaxed);
+    out.rtt_p50_us = st.rtt_p50_us.load(std::memory_order_relaxed);
+    out.rtt_p99_us = st.rtt_p99_us.load(std::memory_order_relaxed);
+    return out;
+}
+
+/**
+ * 打印所有电机的调度统计
+ */
+void print_motor_sched_statistics() {
+    std::cout << "Channel | Motor | Attempts | Success | Timeouts | Failures | Skips | Lates | RTT50(us) | RTT99(us) | Timeout(us)\n";
+    std::cout << "--------|-------|----------|---------|----------|----------|-------|-------|-----------|-----------|------------\n";
+    for (int i = 0; i < NUM_CHANNELS; ++i) {
+        for (int j = 0; j < MOTORS_PER_CHANNEL; ++j) {
+            MotorSchedStats_t st = get_motor_sched_stats(i, j);
+            printf("%7d | %5d | %8lu | %7lu | %8lu | %8lu | %5lu | %5lu | %9u | %9u | %11u\n",
+                   i, j, st.attempts, st.successes, st.timeouts, st.failures, st.skips, st.lates,
+                   st.rtt_p50_us, st.rtt_p99_us, st.timeout_us);
+        }
+    }
+    std::cout << std::endl;
+}
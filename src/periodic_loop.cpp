@@ -0,0 +1,167 @@
+#include "periodic_loop.hpp"
+#include "rt_executor.hpp"
+#include "rt_util.hpp"
+#include <iostream>
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * 登记表中的一个循环，所在线程写，其他线程只读
+ */
+struct PeriodicLoopShared {
+    std::atomic<bool> used{false};
+    char name[PERIODIC_LOOP_NAME_LEN];
+    std::atomic<uint32_t> period_us{0};
+    std::atomic<int> policy{0};
+    std::atomic<uint64_t> cycles{0};
+    std::atomic<uint64_t> overruns{0};
+    std::atomic<uint64_t> missed_ticks{0};
+    LatencyHistogram lateness_us;
+    LatencyHistogram work_us;
+};
+
+static PeriodicLoopShared g_loops[PERIODIC_LOOP_MAX];
+static std::atomic<int> g_loop_count(0);
+static std::mutex g_register_mutex;  // 只在线程启动登记时使用，不在周期路径上
+
+static inline uint32_t to_us(Clock::duration d) {
+    long long us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    return us < 0 ? 0 : (uint32_t)std::min<long long>(us, LATENCY_HIST_MAX_US);
+}
+
+// 按名称查找或新建登记项，登记表已满时返回-1
+static int register_loop(const char* name) {
+    std::lock_guard<std::mutex> lock(g_register_mutex);
+    int n = g_loop_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < n; ++i) {
+        if (strncmp(g_loops[i].name, name, PERIODIC_LOOP_NAME_LEN) == 0) return i;
+    }
+    if (n >= PERIODIC_LOOP_MAX) {
+        std::cerr << "Periodic loop table full, " << name << " is not instrumented" << std::endl;
+        return -1;
+    }
+    snprintf(g_loops[n].name, PERIODIC_LOOP_NAME_LEN, "%s", name);
+    g_loops[n].used.store(true, std::memory_order_release);
+    g_loop_count.store(n + 1, std::memory_order_release);
+    return n;
+}
+
+PeriodicLoop::PeriodicLoop(const char* name, std::chrono::microseconds period, OverrunPolicy policy, uint32_t spin_us)
+    : period(period), policy(policy), spin_us(spin_us), slot(register_loop(name)) {
+    // 由执行器启动的周期任务以任务描述为准
+    const RtTaskSpec_t* spec = rt_current_task();
+    if (spec != nullptr && spec->period_us > 0) {
+        this->period = std::chrono::microseconds(spec->period_us);
+        this->policy = spec->policy;
+        this->spin_us = spec->spin_us;
+    }
+    if (slot >= 0) {
+        g_loops[slot].period_us.store((uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(this->period).count(),
+                                      std::memory_order_relaxed);
+        g_loops[slot].policy.store((int)this->policy, std::memory_order_relaxed);
+    }
+    woke_at = Clock::now();
+    cycle_start = woke_at;
+    cycle_deadline = cycle_start + this->period;
+}
+
+void PeriodicLoop::setPolicy(OverrunPolicy p) {
+    policy = p;
+    if (slot >= 0) g_loops[slot].policy.store((int)p, std::memory_order_relaxed);
+}
+
+/**
+ * 结束本次迭代并等待下一个周期
+ * 工作结束时已过截止时刻记为一次超期，按策略决定下一次迭代的计划开始时刻
+ */
+void PeriodicLoop::wait() {
+    auto now = Clock::now();
+    auto next = cycle_deadline;
+    uint64_t missed = 0;
+    bool overrun = now > cycle_deadline;
+
+    if (overrun) {
+        switch (policy) {
+        case OverrunPolicy::SKIP:
+            // 跳到原相位上的下一个未来节拍
+            missed = (uint64_t)((now - cycle_deadline) / period) + 1;
+            next = cycle_deadline + period * (long)missed;
+            break;
+        case OverrunPolicy::CATCH_UP:
+            break;
+        case OverrunPolicy::REPHASE:
+            next = now;
+            break;
+        }
+    }
+
+    rt_sleep_until(next, spin_us);
+    auto woke = Clock::now();
+
+    if (slot >= 0) {
+        PeriodicLoopShared& st = g_loops[slot];
+        st.work_us.record(to_us(now - woke_at));
+        st.lateness_us.record(to_us(woke - next));
+        if (overrun) bump(st.overruns);
+        if (missed > 0) bump(st.missed_ticks, missed);
+        bump(st.cycles);
+    }
+
+    woke_at = woke;
+    cycle_start = next;
+    cycle_deadline = next + period;
+}
+
+int periodic_loop_count() {
+    return g_loop_count.load(std::memory_order_acquire);
+}
+
+bool get_periodic_loop_stats(int index, PeriodicLoopStats_t& out) {
+    if (index < 0 || index >= periodic_loop_count()) return false;
+    const PeriodicLoopShared& st = g_loops[index];
+    if (!st.used.load(std::memory_order_acquire)) return false;
+    memcpy(out.name, st.name, PERIODIC_LOOP_NAME_LEN);
+    out.period_us = st.period_us.load(std::memory_order_relaxed);
+    out.policy = (OverrunPolicy)st.policy.load(std::memory_order_relaxed);
+    out.cycles = st.cycles.load(std::memory_order_relaxed);
+    out.overruns = st.overruns.load(std::memory_order_relaxed);
+    out.missed_ticks = st.missed_ticks.load(std::memory_order_relaxed);
+    st.lateness_us.snapshot(out.lateness_us);
+    st.work_us.snapshot(out.work_us);
+    return true;
+}
+
+const char* overrun_policy_name(OverrunPolicy p) {
+    switch (p) {
+    case OverrunPolicy::SKIP: return "skip";
+    case OverrunPolicy::CATCH_UP: return "catch-up";
+    case OverrunPolicy::REPHASE: return "rephase";
+    }
+    return "?";
+}
+
+/**
+ * 打印全部周期循环的统计(自启动以来累计)
+ */
+void print_periodic_loop_statistics() {
+    std::cout << "Loop                 | Period(us) | Policy   |   Cycles | Overruns |  Missed | Late p50 | Late p99 | Late max | Work p50 | Work p99 | Work max (us)\n";
+    std::cout << "---------------------|------------|----------|----------|----------|---------|----------|----------|----------|----------|----------|--------------\n";
+    std::unique_ptr<PeriodicLoopStats_t> st(new PeriodicLoopStats_t);
+    int n = periodic_loop_count();
+    for (int i = 0; i < n; ++i) {
+        if (!get_periodic_loop_stats(i, *st)) continue;
+        printf("%-20s | %10u | %-8s | %8lu | %8lu | %7lu | %8u | %8u | %8u | %8u | %8u | %13u\n",
+               st->name, st->period_us, overrun_policy_name(st->policy), st->cycles, st->overruns, st->missed_ticks,
+               latency_hist_quantile(st->lateness_us, 0.5), latency_hist_quantile(st->lateness_us, 0.99),
+               latency_hist_max(st->lateness_us),
+               latency_hist_quantile(st->work_us, 0.5), latency_hist_quantile(st->work_us, 0.99),
+               latency_hist_max(st->work_us));
+    }
+    std::cout << std::endl;
+}
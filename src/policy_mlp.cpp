@@ -0,0 +1,745 @@
+#include "policy_mlp.hpp"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define POLICY_MLP_X86 1
+#endif
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+typedef void (*LinearKernel)(const float* w, const float* b, const float* x, uint32_t in, uint32_t out_pad, float* y);
+typedef void (*EluKernel)(float* x, uint32_t n);
+
+static inline uint32_t round_up(uint32_t v, uint32_t m) {
+    return (v + m - 1) / m * m;
+}
+
+//------------------------------------------------------------------ 标量内核
+// 块宽是编译期常量，块内的乘加可以被编译器自动向量化(aarch64上为NEON)
+
+template <int W>
+static inline void block_scalar(const float* w, const float* b, const float* x, uint32_t in, float* y) {
+    float acc[W];
+    for (int j = 0; j < W; ++j) acc[j] = b[j];
+    for (uint32_t i = 0; i < in; ++i) {
+        const float xi = x[i];
+        const float* wr = w + (size_t)i * W;
+        for (int j = 0; j < W; ++j) acc[j] += xi * wr[j];
+    }
+    for (int j = 0; j < W; ++j) y[j] = acc[j];
+}
+
+static void linear_scalar(const float* w, const float* b, const float* x, uint32_t in, uint32_t out_pad, float* y) {
+    for (uint32_t o0 = 0; o0 < out_pad; o0 += POLICY_MLP_BLOCK) {
+        const float* wb = w + (size_t)o0 * in;
+        switch (std::min<uint32_t>(POLICY_MLP_BLOCK, out_pad - o0) / 16) {
+            case 4: block_scalar<64>(wb, b + o0, x, in, y + o0); break;
+            case 3: block_scalar<48>(wb, b + o0, x, in, y + o0); break;
+            case 2: block_scalar<32>(wb, b + o0, x, in, y + o0); break;
+            default: block_scalar<16>(wb, b + o0, x, in, y + o0); break;
+        }
+    }
+}
+
+static void elu_scalar(float* x, uint32_t n) {
+    for (uint32_t i = 0; i < n; ++i) {
+        if (x[i] <= 0.0f) x[i] = expm1f(x[i]);
+    }
+}
+
+#ifdef POLICY_MLP_X86
+//------------------------------------------------------------------ AVX2 + FMA
+// exp按Cephes的做法：x = n*ln2 + r，|r| <= ln2/2，exp(r)用5阶多项式，2^n直接拼进指数位
+
+__attribute__((target("avx2,fma"))) static inline __m256 exp256(__m256 x) {
+    x = _mm256_max_ps(x, _mm256_set1_ps(-87.3f));
+    __m256 fx = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(fx, _mm256_set1_ps(0.693359375f), x);
+    r = _mm256_fnmadd_ps(fx, _mm256_set1_ps(-2.12194440e-4f), r);
+    __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+    p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+    __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(fx), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(e));
+}
+
+__attribute__((target("avx2,fma"))) static void elu_avx2(float* x, uint32_t n) {
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        __m256 neg = _mm256_sub_ps(exp256(_mm256_min_ps(v, zero)), one);
+        _mm256_storeu_ps(x + i, _mm256_blendv_ps(neg, v, _mm256_cmp_ps(v, zero, _CMP_GT_OQ)));
+    }
+    elu_scalar(x + i, n - i);
+}
+
+// 一块V*16个输出，每个输入广播一次，2V个累加器
+template <int V>
+__attribute__((target("avx2,fma"))) static inline void block_avx2(const float* w, const float* b, const float* x,
+                                                                   uint32_t in, float* y) {
+    __m256 acc[2 * V];
+    for (int v = 0; v < 2 * V; ++v) acc[v] = _mm256_load_ps(b + 8 * v);
+    for (uint32_t i = 0; i < in; ++i) {
+        const __m256 xi = _mm256_broadcast_ss(x + i);
+        const float* wr = w + (size_t)i * (16 * V);
+#pragma GCC unroll 8
+        for (int v = 0; v < 2 * V; ++v) acc[v] = _mm256_fmadd_ps(xi, _mm256_load_ps(wr + 8 * v), acc[v]);
+    }
+    for (int v = 0; v < 2 * V; ++v) _mm256_store_ps(y + 8 * v, acc[v]);
+}
+
+__attribute__((target("avx2,fma"))) static void linear_avx2(const float* w, const float* b, const float* x,
+                                                            uint32_t in, uint32_t out_pad, float* y) {
+    for (uint32_t o0 = 0; o0 < out_pad; o0 += POLICY_MLP_BLOCK) {
+        const float* wb = w + (size_t)o0 * in;
+        switch (std::min<uint32_t>(POLICY_MLP_BLOCK, out_pad - o0) / 16) {
+            case 4: block_avx2<4>(wb, b + o0, x, in, y + o0); break;
+            case 3: block_avx2<3>(wb, b + o0, x, in, y + o0); break;
+            case 2: block_avx2<2>(wb, b + o0, x, in, y + o0); break;
+            default: block_avx2<1>(wb, b + o0, x, in, y + o0); break;
+        }
+    }
+}
+
+//------------------------------------------------------------------ AVX-512
+
+// max/min/roundscale/scalef用全1掩码的maskz形式：GCC 12的avx512fintrin.h中不带掩码的形式以
+// _mm512_undefined_ps()(__m512 __Y = __Y)作源操作数，-Wall -O2下会误报-Wmaybe-uninitialized。
+// 掩码全1时编译结果相同
+#define AVX512_ALL ((__mmask16)0xFFFF)
+
+__attribute__((target("avx512f"))) static inline __m512 exp512(__m512 x) {
+    x = _mm512_maskz_max_ps(AVX512_ALL, x, _mm512_set1_ps(-87.3f));
+    __m512 fx = _mm512_maskz_roundscale_ps(AVX512_ALL, _mm512_mul_ps(x, _mm512_set1_ps(1.44269504088896341f)),
+                                           _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512 r = _mm512_fnmadd_ps(fx, _mm512_set1_ps(0.693359375f), x);
+    r = _mm512_fnmadd_ps(fx, _mm512_set1_ps(-2.12194440e-4f), r);
+    __m512 p = _mm512_set1_ps(1.9875691500e-4f);
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.3981999507e-3f));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(8.3334519073e-3f));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(4.1665795894e-2f));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.6666665459e-1f));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(5.0000001201e-1f));
+    p = _mm512_fmadd_ps(p, _mm512_mul_ps(r, r), _mm512_add_ps(r, _mm512_set1_ps(1.0f)));
+    return _mm512_maskz_scalef_ps(AVX512_ALL, p, fx);
+}
+
+__attribute__((target("avx512f"))) static void elu_avx512(float* x, uint32_t n) {
+    const __m512 zero = _mm512_setzero_ps(), one = _mm512_set1_ps(1.0f);
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = _mm512_loadu_ps(x + i);
+        __m512 neg = _mm512_sub_ps(exp512(_mm512_maskz_min_ps(AVX512_ALL, v, zero)), one);
+        _mm512_storeu_ps(x + i, _mm512_mask_blend_ps(_mm512_cmp_ps_mask(v, zero, _CMP_GT_OQ), neg, v));
+    }
+    elu_scalar(x + i, n - i);
+}
+
+// 一块V*16个输出；输入按奇偶分给两组累加器，V=4时有8条相互独立的FMA链
+template <int V>
+__attribute__((target("avx512f"))) static inline void block_avx512(const float* w, const float* b, const float* x,
+                                                                   uint32_t in, float* y) {
+    __m512 acc0[V], acc1[V];
+    for (int v = 0; v < V; ++v) {
+        acc0[v] = _mm512_load_ps(b + 16 * v);
+        acc1[v] = _mm512_setzero_ps();
+    }
+    uint32_t i = 0;
+    for (; i + 2 <= in; i += 2) {
+        const __m512 x0 = _mm512_set1_ps(x[i]), x1 = _mm512_set1_ps(x[i + 1]);
+        const float* wr = w + (size_t)i * (16 * V);
+#pragma GCC unroll 4
+        for (int v = 0; v < V; ++v) {
+            acc0[v] = _mm512_fmadd_ps(x0, _mm512_load_ps(wr + 16 * v), acc0[v]);
+            acc1[v] = _mm512_fmadd_ps(x1, _mm512_load_ps(wr + 16 * V + 16 * v), acc1[v]);
+        }
+    }
+    if (i < in) {
+        const __m512 x0 = _mm512_set1_ps(x[i]);
+        const float* wr = w + (size_t)i * (16 * V);
+        for (int v = 0; v < V; ++v) acc0[v] = _mm512_fmadd_ps(x0, _mm512_load_ps(wr + 16 * v), acc0[v]);
+    }
+    for (int v = 0; v < V; ++v) _mm512_store_ps(y + 16 * v, _mm512_add_ps(acc0[v], acc1[v]));
+}
+
+__attribute__((target("avx512f"))) static void linear_avx512(const float* w, const float* b, const float* x,
+                                                             uint32_t in, uint32_t out_pad, float* y) {
+    for (uint32_t o0 = 0; o0 < out_pad; o0 += POLICY_MLP_BLOCK) {
+        const float* wb = w + (size_t)o0 * in;
+        switch (std::min<uint32_t>(POLICY_MLP_BLOCK, out_pad - o0) / 16) {
+            case 4: block_avx512<4>(wb, b + o0, x, in, y + o0); break;
+            case 3: block_avx512<3>(wb, b + o0, x, in, y + o0); break;
+            case 2: block_avx512<2>(wb, b + o0, x, in, y + o0); break;
+            default: block_avx512<1>(wb, b + o0, x, in, y + o0); break;
+        }
+    }
+}
+#endif // POLICY_MLP_X86
+
+static void kernels_for(PolicyMlpIsa isa, LinearKernel& linear, EluKernel& elu) {
+    linear = linear_scalar;
+    elu = elu_scalar;
+#ifdef POLICY_MLP_X86
+    if (isa == MLP_ISA_AVX512) {
+        linear = linear_avx512;
+        elu = elu_avx512;
+    } else if (isa == MLP_ISA_AVX2) {
+        linear = linear_avx2;
+        elu = elu_avx2;
+    }
+#endif
+}
+
+static void layernorm(float* x, uint32_t n, const float* gamma, const float* beta, float eps) {
+    float mean = 0.0f;
+    for (uint32_t i = 0; i < n; ++i) mean += x[i];
+    mean /= (float)n;
+    float var = 0.0f;
+    for (uint32_t i = 0; i < n; ++i) var += (x[i] - mean) * (x[i] - mean);
+    const float inv = 1.0f / sqrtf(var / (float)n + eps);
+    for (uint32_t i = 0; i < n; ++i) x[i] = (x[i] - mean) * inv * gamma[i] + beta[i];
+}
+
+//------------------------------------------------------------------ CRC32C
+
+struct Crc32cTable {
+    uint32_t v[256];
+    Crc32cTable() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? (c >> 1) ^ 0x82F63B78u : c >> 1;
+            v[i] = c;
+        }
+    }
+};
+
+static uint32_t crc32c_table(uint32_t crc, const uint8_t* p, size_t len) {
+    static const Crc32cTable table;
+    for (size_t i = 0; i < len; ++i) crc = table.v[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+#ifdef POLICY_MLP_X86
+__attribute__((target("sse4.2"))) static uint32_t crc32c_sse42(uint32_t crc, const uint8_t* p, size_t len) {
+    uint64_t c = crc;
+    for (; len >= 8; len -= 8, p += 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        c = _mm_crc32_u64(c, v);
+    }
+    uint32_t c32 = (uint32_t)c;
+    for (; len > 0; --len, ++p) c32 = _mm_crc32_u8(c32, *p);
+    return c32;
+}
+#endif
+
+uint32_t policy_crc32c(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFFu;
+#if defined(POLICY_MLP_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) return crc32c_sse42(crc, p, len) ^ 0xFFFFFFFFu;
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+    for (; len >= 8; len -= 8, p += 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        crc = __crc32cd(crc, v);
+    }
+    for (; len > 0; --len, ++p) crc = __crc32cb(crc, *p);
+    return crc ^ 0xFFFFFFFFu;
+#endif
+    return crc32c_table(crc, p, len) ^ 0xFFFFFFFFu;
+}
+
+bool policy_source_id(const char* path, PolicySourceId_t& out) {
+    memset(&out, 0, sizeof(out));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror(path);
+        close(fd);
+        return false;
+    }
+    out.size = (uint64_t)st.st_size;
+    if (st.st_size == 0) {
+        close(fd);
+        out.crc = policy_crc32c(nullptr, 0);
+        return true;
+    }
+    void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+    madvise(base, st.st_size, MADV_SEQUENTIAL);
+    out.crc = policy_crc32c(base, st.st_size);
+    munmap(base, st.st_size);
+    return true;
+}
+
+//------------------------------------------------------------------ PolicyMlp
+
+PolicyMlp::PolicyMlp()
+    : is_ready(false), failed(false), kernel_isa(MLP_ISA_SCALAR), arena(nullptr), arena_cap(0), map_base(nullptr),
+      map_len(0), scratch(nullptr) {
+    memset(&src, 0, sizeof(src));
+    memset(&d, 0, sizeof(d));
+    memset(ops, 0, sizeof(ops));
+}
+
+PolicyMlp::~PolicyMlp() {
+    release();
+}
+
+void PolicyMlp::release() {
+    if (map_base != nullptr) {
+        munmap(map_base, map_len);
+    } else {
+        free(arena);
+    }
+    free(scratch);
+    map_base = nullptr;
+    map_len = 0;
+    memset(&src, 0, sizeof(src));
+    arena = nullptr;
+    scratch = nullptr;
+    arena_cap = 0;
+    is_ready = false;
+}
+
+PolicyMlpIsa PolicyMlp::best_isa() {
+#ifdef POLICY_MLP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return MLP_ISA_AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return MLP_ISA_AVX2;
+#endif
+    return MLP_ISA_SCALAR;
+}
+
+const char* PolicyMlp::isa_name(PolicyMlpIsa isa) {
+    static const char* names[] = {"scalar", "avx2", "avx512"};
+    return names[isa];
+}
+
+bool PolicyMlp::set_isa(PolicyMlpIsa isa) {
+    if (isa > best_isa()) return false;
+    kernel_isa = isa;
+    return true;
+}
+
+void PolicyMlp::begin(uint32_t obs_dim, uint32_t hist_rows) {
+    release();
+    memset(&d, 0, sizeof(d));
+    memset(ops, 0, sizeof(ops));
+    failed = false;
+    d.obs_dim = obs_dim;
+    d.hist_rows = hist_rows;
+    kernel_isa = best_isa();
+}
+
+/**
+ * 在arena末尾预留floats个float(起点对齐到64字节)并清零，返回偏移。容量不够时整体搬到更大的区域
+ */
+uint32_t PolicyMlp::arena_reserve(uint32_t floats) {
+    uint32_t offset = round_up(d.arena_floats, POLICY_MLP_LANES);
+    uint32_t need = offset + round_up(floats, POLICY_MLP_LANES);
+    if (need > arena_cap) {
+        uint32_t cap = std::max<uint32_t>(need, arena_cap * 2);
+        float* grown = (float*)aligned_alloc(64, (size_t)cap * sizeof(float));
+        if (arena != nullptr) memcpy(grown, arena, (size_t)d.arena_floats * sizeof(float));
+        free(arena);
+        arena = grown;
+        arena_cap = cap;
+    }
+    memset(arena + d.arena_floats, 0, (size_t)(need - d.arena_floats) * sizeof(float));
+    d.arena_floats = need;
+    return offset;
+}
+
+bool PolicyMlp::push_op(const PolicyMlpOp_t& op) {
+    if (d.num_ops >= POLICY_MLP_MAX_OPS) {
+        std::cerr << "PolicyMlp: more than " << POLICY_MLP_MAX_OPS << " ops" << std::endl;
+        failed = true;
+        return false;
+    }
+    if (d.num_ops > 0 && op.stage < ops[d.num_ops - 1].stage) {
+        std::cerr << "PolicyMlp: ops must be added encoder, gate, expert in order" << std::endl;
+        failed = true;
+        return false;
+    }
+    ops[d.num_ops++] = op;
+    is_ready = false;
+    return true;
+}
+
+/**
+ * 打包：第o个输出、第i个输入的权重位于 块起点o0*in + i*块宽 + (o-o0)，补齐的输出列为0
+ */
+bool PolicyMlp::add_linear(PolicyMlpStage stage, const float* w, const float* b, uint32_t in, uint32_t out) {
+    PolicyMlpOp_t op = {};
+    op.stage = stage;
+    op.type = MLP_OP_LINEAR;
+    op.in = in;
+    op.out = out;
+    op.out_pad = round_up(out, POLICY_MLP_LANES);
+    op.weight = arena_reserve(in * op.out_pad);
+    op.bias = arena_reserve(op.out_pad);
+    float* pw = arena + op.weight;
+    for (uint32_t o = 0; o < out; ++o) {
+        uint32_t o0 = o / POLICY_MLP_BLOCK * POLICY_MLP_BLOCK;
+        uint32_t width = std::min<uint32_t>(POLICY_MLP_BLOCK, op.out_pad - o0);
+        for (uint32_t i = 0; i < in; ++i) pw[(size_t)o0 * in + (size_t)i * width + (o - o0)] = w[(size_t)o * in + i];
+        arena[op.bias + o] = b[o];
+    }
+    return push_op(op);
+}
+
+/**
+ * 第k个专家的第o个输出作为合并后的第k*out+o列
+ */
+bool PolicyMlp::add_expert_linear(const float* w, const float* b, uint32_t experts, uint32_t in, uint32_t out) {
+    PolicyMlpOp_t op = {};
+    op.stage = MLP_STAGE_EXPERT;
+    op.type = MLP_OP_LINEAR;
+    op.in = in;
+    op.out = experts * out;
+    op.out_pad = round_up(op.out, POLICY_MLP_LANES);
+    op.weight = arena_reserve(in * op.out_pad);
+    op.bias = arena_reserve(op.out_pad);
+    if (d.experts != 0 && d.experts != experts) {
+        std::cerr << "PolicyMlp: expert layers disagree on the number of experts" << std::endl;
+        failed = true;
+        return false;
+    }
+    d.experts = experts;
+    float* pw = arena + op.weight;
+    for (uint32_t k = 0; k < experts; ++k) {
+        for (uint32_t oe = 0; oe < out; ++oe) {
+            uint32_t o = k * out + oe;
+            uint32_t o0 = o / POLICY_MLP_BLOCK * POLICY_MLP_BLOCK;
+            uint32_t width = std::min<uint32_t>(POLICY_MLP_BLOCK, op.out_pad - o0);
+            for (uint32_t i = 0; i < in; ++i) {
+                pw[(size_t)o0 * in + (size_t)i * width + (o - o0)] = w[((size_t)k * in + i) * out + oe];
+            }
+            arena[op.bias + o] = b[(size_t)k * out + oe];
+        }
+    }
+    return push_op(op);
+}
+
+bool PolicyMlp::add_elu(PolicyMlpStage stage) {
+    PolicyMlpOp_t op = {};
+    op.stage = stage;
+    op.type = MLP_OP_ELU;
+    return push_op(op);
+}
+
+bool PolicyMlp::add_layernorm(PolicyMlpStage stage, const float* gamma, const float* beta, uint32_t n, float eps) {
+    PolicyMlpOp_t op = {};
+    op.stage = stage;
+    op.type = MLP_OP_LAYERNORM;
+    op.in = n;
+    op.out = n;
+    op.out_pad = round_up(n, POLICY_MLP_LANES);
+    op.weight = arena_reserve(n);
+    op.bias = arena_reserve(n);
+    memcpy(arena + op.weight, gamma, n * sizeof(float));
+    memcpy(arena + op.bias, beta, n * sizeof(float));
+    op.eps = eps;
+    return push_op(op);
+}
+
+/**
+ * 沿算子序列跟踪当前维数：编码器输入为(hist_rows+1)*obs_dim，编码器输出为潜变量，
+ * 门控输入为[潜变量, 观测]、输出为专家数，专家层输入为[潜变量, 观测或上一层输出]
+ */
+bool PolicyMlp::finish() {
+    is_ready = false;
+    if (failed || d.num_ops == 0) return false;
+    uint32_t cur = (d.hist_rows + 1) * d.obs_dim;
+    uint32_t widest = cur;
+    uint32_t stage = MLP_STAGE_ENCODER;
+    uint32_t expert_out = 0;
+    bool has_gate = false, has_expert = false;
+    for (uint32_t n = 0; n < d.num_ops; ++n) {
+        const PolicyMlpOp_t& op = ops[n];
+        if (op.stage != stage) {
+            if (stage == MLP_STAGE_ENCODER) d.latent_dim = cur;
+            if (op.stage == MLP_STAGE_GATE) cur = d.latent_dim + d.obs_dim;
+            if (op.stage == MLP_STAGE_EXPERT) {
+                if (cur != d.experts) {
+                    std::cerr << "PolicyMlp: gate outputs " << cur << " values for " << d.experts << " experts" << std::endl;
+                    return false;
+                }
+                cur = d.latent_dim + d.obs_dim;
+            }
+            stage = op.stage;
+        }
+        if (op.stage > MLP_STAGE_EXPERT || op.type < MLP_OP_LINEAR || op.type > MLP_OP_LAYERNORM) {
+            std::cerr << "PolicyMlp: op " << n << " has unknown stage/type" << std::endl;
+            return false;
+        }
+        if (op.type == MLP_OP_ELU) continue;
+        // 权重和偏置必须落在arena内并且64字节对齐(映射的文件不经过add_*，这里一并检查)
+        const uint64_t w_len = op.type == MLP_OP_LINEAR ? (uint64_t)op.in * op.out_pad : op.out;
+        const uint64_t b_len = op.type == MLP_OP_LINEAR ? op.out_pad : op.out;
+        if (op.out_pad != round_up(op.out, POLICY_MLP_LANES) || op.weight % POLICY_MLP_LANES != 0 ||
+            op.bias % POLICY_MLP_LANES != 0 || op.weight + w_len > d.arena_floats || op.bias + b_len > d.arena_floats) {
+            std::cerr << "PolicyMlp: op " << n << " weights lie outside the arena" << std::endl;
+            return false;
+        }
+        if (op.stage == MLP_STAGE_EXPERT && op.type == MLP_OP_LINEAR && (d.experts == 0 || op.out % d.experts != 0)) {
+            std::cerr << "PolicyMlp: op " << n << " outputs " << op.out << " values for " << d.experts << " experts"
+                      << std::endl;
+            return false;
+        }
+        uint32_t expect = cur;
+        if (op.stage == MLP_STAGE_EXPERT && op.type == MLP_OP_LINEAR && expert_out != 0) expect = d.latent_dim + expert_out;
+        if (op.in != expect) {
+            std::cerr << "PolicyMlp: op " << n << " expects " << op.in << " inputs, previous op gives " << expect << std::endl;
+            return false;
+        }
+        widest = std::max(widest, std::max(op.in, op.out_pad));
+        if (op.stage == MLP_STAGE_EXPERT && op.type == MLP_OP_LINEAR) {
+            expert_out = op.out / d.experts;
+            cur = expert_out;
+        } else {
+            cur = op.out;
+        }
+        has_gate = has_gate || op.stage == MLP_STAGE_GATE;
+        has_expert = has_expert || op.stage == MLP_STAGE_EXPERT;
+    }
+    if (!has_gate || !has_expert) {
+        std::cerr << "PolicyMlp: missing gate or expert layers" << std::endl;
+        return false;
+    }
+    d.action_dim = cur;
+
+    // 暂存区：拼接输入、两个中间结果、潜变量、系数，各自对齐到64字节
+    const uint32_t w = round_up(widest, POLICY_MLP_LANES);
+    const uint32_t latent = round_up(d.latent_dim, POLICY_MLP_LANES);
+    const uint32_t coef = round_up(d.experts, POLICY_MLP_LANES);
+    d.scratch_floats = 3 * w + latent + coef;
+    free(scratch);
+    scratch = (float*)aligned_alloc(64, (size_t)d.scratch_floats * sizeof(float));
+    memset(scratch, 0, (size_t)d.scratch_floats * sizeof(float));
+    buf_x = scratch;
+    buf_a = buf_x + w;
+    buf_b = buf_a + w;
+    buf_latent = buf_b + w;
+    buf_coef = buf_latent + latent;
+    is_ready = true;
+    return true;
+}
+
+/**
+ * 文件头、填充到POLICY_FLAT_ALIGN、arena原样写出
+ */
+bool PolicyMlp::save(const char* path, const PolicySourceId_t& source) const {
+    if (!is_ready) {
+        std::cerr << "PolicyMlp: save() before finish()" << std::endl;
+        return false;
+    }
+    PolicyFlatHeader_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, POLICY_FLAT_MAGIC, sizeof(h.magic));
+    h.version = POLICY_FLAT_VERSION;
+    h.header_size = sizeof(PolicyFlatHeader_t);
+    h.endian_tag = 0x01020304u;
+    h.op_size = sizeof(PolicyMlpOp_t);
+    h.dims = d;
+    memcpy(h.ops, ops, sizeof(ops));
+    h.arena_offset = (sizeof(PolicyFlatHeader_t) + POLICY_FLAT_ALIGN - 1) / POLICY_FLAT_ALIGN * POLICY_FLAT_ALIGN;
+    h.arena_bytes = (uint64_t)d.arena_floats * sizeof(float);
+    h.source = source;
+    h.arena_crc = policy_crc32c(arena, h.arena_bytes);
+    h.header_crc = policy_crc32c(&h, sizeof(h));
+
+    std::string tmp = std::string(path) + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (f == nullptr) {
+        perror(tmp.c_str());
+        return false;
+    }
+    static const char zeros[POLICY_FLAT_ALIGN] = {};
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+              fwrite(zeros, h.arena_offset - sizeof(h), 1, f) == 1 &&
+              fwrite(arena, h.arena_bytes, 1, f) == 1;
+    ok = fflush(f) == 0 && fsync(fileno(f)) == 0 && ok;
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmp.c_str(), path) != 0) {
+        perror(path);
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool PolicyMlp::map(const char* path, bool verify_crc) {
+    release();
+    is_ready = false;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(PolicyFlatHeader_t)) {
+        std::cerr << "PolicyMlp: " << path << " is too short for a policy file" << std::endl;
+        close(fd);
+        return false;
+    }
+    // MAP_POPULATE：映射时一次读入并建好页表，执行时不再缺页
+    void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+
+    PolicyFlatHeader_t h;
+    memcpy(&h, base, sizeof(h));
+    const char* err = nullptr;
+    uint32_t header_crc = h.header_crc;
+    h.header_crc = 0;
+    if (memcmp(h.magic, POLICY_FLAT_MAGIC, sizeof(h.magic)) != 0) {
+        err = "not a policy file";
+    } else if (h.endian_tag != 0x01020304u) {
+        err = "written on a machine with different byte order";
+    } else if (h.version != POLICY_FLAT_VERSION || h.header_size != sizeof(PolicyFlatHeader_t) ||
+               h.op_size != sizeof(PolicyMlpOp_t)) {
+        err = "format version does not match this build, re-export it";
+    } else if (policy_crc32c(&h, sizeof(h)) != header_crc) {
+        err = "header checksum mismatch";
+    } else if (h.dims.num_ops == 0 || h.dims.num_ops > POLICY_MLP_MAX_OPS || h.arena_offset % POLICY_FLAT_ALIGN != 0 ||
+               h.arena_bytes != (uint64_t)h.dims.arena_floats * sizeof(float) ||
+               h.arena_offset + h.arena_bytes > (uint64_t)st.st_size) {
+        err = "truncated or inconsistent layout";
+    } else if (verify_crc && policy_crc32c((const uint8_t*)base + h.arena_offset, h.arena_bytes) != h.arena_crc) {
+        err = "weight checksum mismatch";
+    }
+    if (err != nullptr) {
+        std::cerr << "PolicyMlp: " << path << ": " << err << std::endl;
+        munmap(base, st.st_size);
+        return false;
+    }
+
+    map_base = base;
+    map_len = st.st_size;
+    // 只读映射：forward()只读arena，写入会触发SIGSEGV而不是悄悄改掉权重
+    arena = (float*)((uint8_t*)base + h.arena_offset);
+    arena_cap = 0;
+    src = h.source;
+    d = h.dims;
+    memcpy(ops, h.ops, sizeof(ops));
+    failed = false;
+    kernel_isa = best_isa();
+    if (!finish()) {
+        release();
+        return false;
+    }
+    return true;
+}
+
+void PolicyMlp::forward(const float* hist, const float* obs, float* action) {
+    LinearKernel linear;
+    EluKernel elu;
+    kernels_for(kernel_isa, linear, elu);
+
+    const uint32_t obs_dim = d.obs_dim;
+    const uint32_t hist_floats = d.hist_rows * obs_dim;
+    memcpy(buf_x, hist, hist_floats * sizeof(float));
+    memcpy(buf_x + hist_floats, obs, obs_dim * sizeof(float));
+    float* cur = buf_x;
+    uint32_t n = hist_floats + obs_dim;
+    uint32_t stage = MLP_STAGE_ENCODER;
+    bool first_expert = true;
+
+    for (uint32_t k = 0; k < d.num_ops; ++k) {
+        const PolicyMlpOp_t& op = ops[k];
+        if (op.stage != stage) {
+            if (stage == MLP_STAGE_ENCODER) {
+                // 潜变量保存下来，门控和第一个专家层的输入都是[潜变量, 观测]
+                memcpy(buf_latent, cur, d.latent_dim * sizeof(float));
+                memcpy(buf_x, buf_latent, d.latent_dim * sizeof(float));
+                memcpy(buf_x + d.latent_dim, obs, obs_dim * sizeof(float));
+                cur = buf_x;
+                n = d.latent_dim + obs_dim;
+            }
+            if (op.stage == MLP_STAGE_EXPERT) {
+                // softmax得到专家系数；buf_x中仍是[潜变量, 观测]
+                float m = cur[0];
+                for (uint32_t e = 1; e < d.experts; ++e) m = std::max(m, cur[e]);
+                float sum = 0.0f;
+                for (uint32_t e = 0; e < d.experts; ++e) {
+                    buf_coef[e] = expf(cur[e] - m);
+                    sum += buf_coef[e];
+                }
+                for (uint32_t e = 0; e < d.experts; ++e) buf_coef[e] /= sum;
+                cur = buf_x;
+                n = d.latent_dim + obs_dim;
+            }
+            stage = op.stage;
+        }
+
+        switch (op.type) {
+            case MLP_OP_LINEAR: {
+                float* z = cur == buf_a ? buf_b : buf_a;
+                if (op.stage == MLP_STAGE_EXPERT) {
+                    if (!first_expert) {
+                        memcpy(buf_x + d.latent_dim, cur, n * sizeof(float));
+                        cur = buf_x;
+                    }
+                    first_expert = false;
+                    z = buf_a;
+                    linear(arena + op.weight, arena + op.bias, cur, op.in, op.out_pad, z);
+                    // 合并：y[o] = sum_k c_k * z[k*out+o]，偏置已随各专家的列加入
+                    const uint32_t out = op.out / d.experts;
+                    float* y = buf_b;
+                    for (uint32_t o = 0; o < out; ++o) y[o] = buf_coef[0] * z[o];
+                    for (uint32_t e = 1; e < d.experts; ++e) {
+                        const float c = buf_coef[e];
+                        const float* ze = z + e * out;
+                        for (uint32_t o = 0; o < out; ++o) y[o] += c * ze[o];
+                    }
+                    cur = y;
+                    n = out;
+                } else {
+                    linear(arena + op.weight, arena + op.bias, cur, op.in, op.out_pad, z);
+                    cur = z;
+                    n = op.out;
+                }
+                break;
+            }
+            case MLP_OP_ELU:
+                elu(cur, n);
+                break;
+            case MLP_OP_LAYERNORM:
+                layernorm(cur, n, arena + op.weight, arena + op.bias, op.eps);
+                break;
+        }
+    }
+    memcpy(action, cur, d.action_dim * sizeof(float));
+}
@@ -0,0 +1,211 @@
+#include "policy_pipeline.hpp"
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include "triple_buffer.hpp"
+#include "rt_util.hpp"
+
+/**
+ * 动作槽和计数，published/rejected由推理线程写，其余计数由控制线程写，其他线程只读
+ */
+struct PolicyPipelineShared {
+    TripleBuffer<PolicyAction_t> slot;
+    uint32_t seq = 0;          // 最近发布的序号，只由推理线程访问
+    uint32_t rejects = 0;      // 连续拒绝的步数，只由推理线程访问
+    uint32_t applied_seq = 0;  // 最近取用的序号，只由控制线程访问
+    std::atomic<uint64_t> published{0};
+    std::atomic<uint64_t> applied{0};
+    std::atomic<uint64_t> superseded{0};
+    std::atomic<uint64_t> rejected[POLICY_REJECT_REASONS] = {};
+    std::atomic<uint64_t> missed{0};
+    std::atomic<uint64_t> escalations{0};
+    std::atomic<uint64_t> miss_runs[POLICY_MISS_RUN_BINS] = {};
+};
+
+static PolicyPipelineShared g_policy_pipeline;
+static LatencyHistogram g_policy_latency[POLICY_LAT_SOURCES];
+
+static const char* latency_source_names[POLICY_LAT_SOURCES] = {"obs->done", "obs->applied"};
+static const char* reject_names[POLICY_REJECT_REASONS] = {"late", "nan obs", "nan action"};
+
+static inline void record_us(PolicyLatencySource source, int64_t ns) {
+    g_policy_latency[source].record(ns > 0 ? (uint32_t)(ns / 1000) : 0);
+}
+
+void policy_action_publish(const float* target, int64_t obs_ns) {
+    PolicyPipelineShared& p = g_policy_pipeline;
+    PolicyAction_t a;
+    memcpy(a.target, target, sizeof(a.target));
+    a.obs_ns = obs_ns;
+    a.publish_ns = steady_ns();
+    a.seq = ++p.seq;
+    p.slot.store(a);
+    p.rejects = 0;
+    bump(p.published);
+}
+
+uint32_t policy_action_reject(PolicyRejectReason reason) {
+    PolicyPipelineShared& p = g_policy_pipeline;
+    bump(p.rejected[reason]);
+    return ++p.rejects;
+}
+
+bool policy_step_accept(const float* action, int64_t obs_ns, int64_t deadline_ns) {
+    int64_t elapsed_ns = steady_ns() - obs_ns;
+    record_us(POLICY_LAT_INFER, elapsed_ns);
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        if (!std::isfinite(action[i])) {
+            policy_action_reject(POLICY_REJECT_NAN_ACTION);
+            return false;
+        }
+    }
+    if (deadline_ns > 0 && elapsed_ns > deadline_ns) {
+        policy_action_reject(POLICY_REJECT_LATE);
+        return false;
+    }
+    return true;
+}
+
+ActionInterpolator::ActionInterpolator()
+    : profile(POLICY_PROFILE_HOLD), duration_ns(0), start_ns(0), period_ns(0), deadline_ns(0),
+      fallback(POLICY_FALLBACK_HOLD), decay_ns(0), max_misses(0), misses(0), stall_ns(0) {
+    memset(&cur, 0, sizeof(cur));
+    memset(from, 0, sizeof(from));
+    memset(out, 0, sizeof(out));
+    memset(rest, 0, sizeof(rest));
+    memset(stall, 0, sizeof(stall));
+}
+
+void ActionInterpolator::set_profile(PolicyActionProfile p, int64_t d_ns) {
+    profile = p;
+    duration_ns = d_ns;
+}
+
+void ActionInterpolator::set_watchdog(int64_t period, int64_t deadline, PolicyFallback fb, int64_t decay,
+                                      uint32_t max_miss) {
+    period_ns = period;
+    deadline_ns = deadline;
+    fallback = fb;
+    decay_ns = decay;
+    max_misses = max_miss;
+}
+
+void ActionInterpolator::reset(const float* target) {
+    memcpy(rest, target, sizeof(rest));
+    memcpy(cur.target, target, sizeof(cur.target));
+    memcpy(from, target, sizeof(from));
+    memcpy(out, target, sizeof(out));
+}
+
+/**
+ * 看门狗：最近一个好动作的观测时刻为t0时，第k个之后的策略步应在 t0 + k*周期 + 预算 之前到达，
+ * 过了这个时刻还没有新动作就计为错过。新动作到达时结束这一段连续错过，记入直方图
+ */
+bool ActionInterpolator::update(int64_t tick_ns) {
+    PolicyPipelineShared& p = g_policy_pipeline;
+    PolicyAction_t next;
+    bool fresh = p.slot.load(next);
+    if (fresh) {
+        if (next.seq > p.applied_seq + 1) bump(p.superseded, next.seq - p.applied_seq - 1);
+        p.applied_seq = next.seq;
+        bump(p.applied);
+        record_us(POLICY_LAT_APPLY, tick_ns - next.obs_ns);
+        // 达到上限的一段在触发保护时已经记过
+        if (misses > 0 && (max_misses == 0 || misses < max_misses)) {
+            bump(p.miss_runs[misses < POLICY_MISS_RUN_BINS ? misses : POLICY_MISS_RUN_BINS - 1]);
+        }
+        misses = 0;
+        // 从本节拍之前的目标开始过渡，目标曲线连续
+        memcpy(from, out, sizeof(from));
+        cur = next;
+        start_ns = tick_ns;
+    }
+
+    if (period_ns > 0 && cur.seq != 0) {
+        int64_t overdue = tick_ns - (cur.obs_ns + period_ns + deadline_ns);
+        uint32_t m = overdue >= 0 ? (uint32_t)(overdue / period_ns) + 1 : 0;
+        if (m > misses) {
+            if (misses == 0) {
+                memcpy(stall, out, sizeof(stall));
+                stall_ns = tick_ns;
+            }
+            bump(p.missed, m - misses);
+            if (max_misses > 0 && misses < max_misses && m >= max_misses) {
+                bump(p.escalations);
+                bump(p.miss_runs[m < POLICY_MISS_RUN_BINS ? m : POLICY_MISS_RUN_BINS - 1]);
+            }
+            misses = m;
+        }
+    }
+
+    if (misses > 0 && fallback == POLICY_FALLBACK_DECAY && decay_ns > 0) {
+        float k = expf(-(float)(tick_ns - stall_ns) / (float)decay_ns);
+        for (int i = 0; i < NUM_JOINTS; ++i) out[i] = rest[i] + (stall[i] - rest[i]) * k;
+        return fresh;
+    }
+    float s = 1.0f;
+    if (profile != POLICY_PROFILE_HOLD && duration_ns > 0 && tick_ns - start_ns < duration_ns) {
+        s = (float)(tick_ns - start_ns) / (float)duration_ns;
+        if (s < 0.0f) s = 0.0f;
+        if (profile == POLICY_PROFILE_SMOOTH) s = s * s * (3.0f - 2.0f * s);
+    }
+    // 过渡结束后直接取动作本身，保持的目标与策略输出逐位相同
+    if (s >= 1.0f) {
+        memcpy(out, cur.target, sizeof(out));
+    } else {
+        for (int i = 0; i < NUM_JOINTS; ++i) out[i] = from[i] + (cur.target[i] - from[i]) * s;
+    }
+    return fresh;
+}
+
+void get_policy_latency_snapshot(PolicyLatencySource source, LatencyHistSnapshot_t& out) {
+    g_policy_latency[source].snapshot(out);
+}
+
+PolicyPipelineStats_t get_policy_pipeline_stats() {
+    PolicyPipelineStats_t out;
+    out.published = g_policy_pipeline.published.load(std::memory_order_relaxed);
+    out.applied = g_policy_pipeline.applied.load(std::memory_order_relaxed);
+    out.superseded = g_policy_pipeline.superseded.load(std::memory_order_relaxed);
+    for (int r = 0; r < POLICY_REJECT_REASONS; ++r) {
+        out.rejected[r] = g_policy_pipeline.rejected[r].load(std::memory_order_relaxed);
+    }
+    out.missed = g_policy_pipeline.missed.load(std::memory_order_relaxed);
+    out.escalations = g_policy_pipeline.escalations.load(std::memory_order_relaxed);
+    for (int b = 0; b < POLICY_MISS_RUN_BINS; ++b) {
+        out.miss_runs[b] = g_policy_pipeline.miss_runs[b].load(std::memory_order_relaxed);
+    }
+    return out;
+}
+
+/**
+ * 打印动作交接计数和各段时延(自启动以来)
+ */
+void print_policy_pipeline_statistics() {
+    PolicyPipelineStats_t st = get_policy_pipeline_stats();
+    if (st.published == 0) return;
+    printf("Policy actions: %lu published, %lu applied, %lu superseded; rejected", st.published, st.applied,
+           st.superseded);
+    for (int r = 0; r < POLICY_REJECT_REASONS; ++r) printf(" %s %lu", reject_names[r], st.rejected[r]);
+    printf("; %lu steps missed, %lu escalations\n", st.missed, st.escalations);
+    if (st.missed > 0) {
+        std::cout << "Consecutive misses:";
+        for (int b = 1; b < POLICY_MISS_RUN_BINS; ++b) {
+            printf(" %d%s:%lu", b, b == POLICY_MISS_RUN_BINS - 1 ? "+" : "", st.miss_runs[b]);
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "Policy (us)   |   Samples |    p50 |    p99 |  p99.9 |    Max\n";
+    std::cout << "--------------|-----------|--------|--------|--------|-------\n";
+    LatencyHistSnapshot_t snap;
+    for (int s = 0; s < POLICY_LAT_SOURCES; ++s) {
+        get_policy_latency_snapshot((PolicyLatencySource)s, snap);
+        printf("%-13s | %9lu | %6u | %6u | %6u | %6u\n", latency_source_names[s], snap.total,
+               latency_hist_quantile(snap, 0.5), latency_hist_quantile(snap, 0.99),
+               latency_hist_quantile(snap, 0.999), latency_hist_max(snap));
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,192 @@
+#include "rt_executor.hpp"
+#include <iostream>
+#include <future>
+#include <mutex>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <alloca.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include "seqlock.hpp"
+#include "rt_util.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * 一个线程实际生效的设置，线程启动时写入一次，之后只读
+ */
+struct RtTaskReport {
+    RtTaskSpec_t spec;
+    pid_t tid;
+    int policy;          // 读回的调度策略
+    int priority;        // 读回的优先级
+    int nice;            // 读回的nice值
+    char cpus[64];       // 读回的CPU集合
+    char error[96];      // 设置失败的原因，空字符串表示全部成功
+};
+
+static std::mutex g_report_mutex;  // 只在线程启动和打印报告时使用
+static std::vector<RtTaskReport> g_reports;
+static thread_local const RtTaskSpec_t* t_current_spec = nullptr;
+
+// 写入栈的低地址部分，使这些页提前分配
+static void __attribute__((noinline)) prefault_stack(size_t bytes) {
+    volatile uint8_t* buf = (volatile uint8_t*)alloca(bytes);
+    for (size_t i = 0; i < bytes; i += 4096) buf[i] = 0;
+}
+
+static void append_error(char* buf, size_t len, const char* what, int err) {
+    size_t used = strlen(buf);
+    snprintf(buf + used, len - used, "%s%s: %s", used > 0 ? "; " : "", what, strerror(err));
+}
+
+static void format_cpus(const cpu_set_t& set, char* buf, size_t len) {
+    int count = CPU_COUNT(&set);
+    if (count == 0 || count == (int)sysconf(_SC_NPROCESSORS_ONLN)) {
+        snprintf(buf, len, "all");
+        return;
+    }
+    size_t used = 0;
+    buf[0] = '\0';
+    for (int c = 0; c < CPU_SETSIZE && used + 4 < len; ++c) {
+        if (CPU_ISSET(c, &set)) {
+            used += snprintf(buf + used, len - used, used > 0 ? ",%d" : "%d", c);
+        }
+    }
+}
+
+// 在新线程中应用任务描述并读回实际生效的值
+static RtTaskReport apply_spec(const RtTaskSpec_t& spec) {
+    RtTaskReport r;
+    memset(&r, 0, sizeof(r));
+    r.spec = spec;
+    r.tid = (pid_t)syscall(SYS_gettid);
+    pthread_t self = pthread_self();
+
+    char thread_name[16];
+    snprintf(thread_name, sizeof(thread_name), "%s", spec.name);
+    pthread_setname_np(self, thread_name);
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    if (spec.priority > 0) {
+        param.sched_priority = spec.priority;
+        int err = pthread_setschedparam(self, SCHED_FIFO, &param);
+        if (err != 0) append_error(r.error, sizeof(r.error), "SCHED_FIFO", err);
+    } else {
+        int err = pthread_setschedparam(self, SCHED_OTHER, &param);
+        if (err != 0) append_error(r.error, sizeof(r.error), "SCHED_OTHER", err);
+        if (setpriority(PRIO_PROCESS, (id_t)r.tid, spec.nice) != 0) {
+            append_error(r.error, sizeof(r.error), "nice", errno);
+        }
+    }
+
+    if (spec.cpu_mask != 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int c = 0; c < 64; ++c) {
+            if (spec.cpu_mask & RT_CPU(c)) CPU_SET(c, &set);
+        }
+        int err = pthread_setaffinity_np(self, sizeof(set), &set);
+        if (err != 0) append_error(r.error, sizeof(r.error), "affinity", err);
+    }
+
+    if (spec.stack_prefault > 0) prefault_stack(spec.stack_prefault);
+
+    // 读回实际生效的值
+    pthread_getschedparam(self, &r.policy, &param);
+    r.priority = param.sched_priority;
+    errno = 0;
+    r.nice = getpriority(PRIO_PROCESS, (id_t)r.tid);
+    cpu_set_t actual;
+    CPU_ZERO(&actual);
+    pthread_getaffinity_np(self, sizeof(actual), &actual);
+    format_cpus(actual, r.cpus, sizeof(r.cpus));
+
+    if (r.error[0] != '\0') {
+        std::cerr << "Thread " << spec.name << ": " << r.error << std::endl;
+    }
+    return r;
+}
+
+std::thread rt_spawn(const RtTaskSpec_t& spec, std::function<void()> body) {
+    std::promise<void> ready;
+    std::future<void> started = ready.get_future();
+    std::thread t([spec, body, &ready]() {
+        RtTaskReport r = apply_spec(spec);
+        {
+            std::lock_guard<std::mutex> lock(g_report_mutex);
+            g_reports.push_back(r);
+        }
+        RtTaskSpec_t my_spec = spec;
+        t_current_spec = &my_spec;
+        ready.set_value();  // 之后不能再访问ready
+        body();
+        t_current_spec = nullptr;
+    });
+    started.wait();
+    return t;
+}
+
+const RtTaskSpec_t* rt_current_task() {
+    return t_current_spec;
+}
+
+static struct timespec to_timespec(Clock::time_point t) {
+    // Linux上steady_clock即CLOCK_MONOTONIC
+    int64_t ns = steady_ns(t);
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000LL);
+    ts.tv_nsec = (long)(ns % 1000000000LL);
+    return ts;
+}
+
+void rt_sleep_until(Clock::time_point t, uint32_t spin_us) {
+    struct timespec ts = to_timespec(t - std::chrono::microseconds(spin_us));
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+    if (spin_us > 0) {
+        while (Clock::now() < t) CPU_RELAX();
+    }
+}
+
+static const char* policy_name(int policy) {
+    switch (policy) {
+    case SCHED_FIFO: return "FIFO";
+    case SCHED_RR: return "RR";
+    case SCHED_OTHER: return "OTHER";
+    case SCHED_BATCH: return "BATCH";
+    case SCHED_IDLE: return "IDLE";
+    }
+    return "?";
+}
+
+/**
+ * 打印全部线程实际生效的调度设置
+ * Requested列为任务描述中的值，Policy/Prio/Nice/CPUs为线程中读回的值
+ */
+void print_rt_task_report() {
+    std::lock_guard<std::mutex> lock(g_report_mutex);
+    std::cout << "Thread               |    TID | Period(us) | Requested       | Policy | Prio | Nice | CPUs     | Stack(KB) | Spin(us) | Overrun  | Error\n";
+    std::cout << "---------------------|--------|------------|-----------------|--------|------|------|----------|-----------|----------|----------|------\n";
+    for (const RtTaskReport& r : g_reports) {
+        char requested[32];
+        if (r.spec.priority > 0) {
+            snprintf(requested, sizeof(requested), "FIFO %d", r.spec.priority);
+        } else {
+            snprintf(requested, sizeof(requested), "OTHER nice %d", r.spec.nice);
+        }
+        printf("%-20s | %6d | %10u | %-15s | %-6s | %4d | %4d | %-8s | %9zu | %8u | %-8s | %s\n",
+               r.spec.name, (int)r.tid, r.spec.period_us, requested, policy_name(r.policy), r.priority, r.nice,
+               r.cpus, r.spec.stack_prefault / 1024, r.spec.spin_us,
+               r.spec.period_us > 0 ? overrun_policy_name(r.spec.policy) : "-",
+               r.error[0] != '\0' ? r.error : "ok");
+    }
+    std::cout << std::endl;
+}
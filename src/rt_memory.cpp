@@ -0,0 +1,238 @@
+#include "rt_memory.hpp"
+#include <iostream>
+#include <atomic>
+#include <mutex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <malloc.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "rt_executor.hpp"
+#include "rt_util.hpp"
+
+#ifndef MCL_ONFAULT
+#define MCL_ONFAULT 4
+#endif
+
+bool rt_memory_lock(size_t heap_prefault) {
+    bool ok = true;
+    if (mlockall(MCL_CURRENT | MCL_FUTURE | MCL_ONFAULT) != 0) {
+        // 4.4之前的内核不支持MCL_ONFAULT
+        if (errno != EINVAL || mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            std::cerr << "mlockall() failed: " << strerror(errno) << std::endl;
+            ok = false;
+        }
+    }
+
+    // 释放的内存留在堆中，大块分配不单独mmap，所有线程共用已预分配的主分配区
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    mallopt(M_ARENA_MAX, 1);
+
+    if (heap_prefault > 0) {
+        volatile uint8_t* heap = (volatile uint8_t*)malloc(heap_prefault);
+        if (heap == nullptr) {
+            std::cerr << "Failed to prefault " << heap_prefault << " bytes of heap" << std::endl;
+            return false;
+        }
+        long page = sysconf(_SC_PAGESIZE);
+        for (size_t i = 0; i < heap_prefault; i += (size_t)page) heap[i] = 0;
+        free((void*)heap);
+    }
+    std::cout << "Memory locked" << (ok ? "" : " (mlockall failed)") << ", " << heap_prefault / (1024 * 1024)
+              << " MB heap prefaulted" << std::endl;
+    return ok;
+}
+
+/**
+ * 登记表中的一个线程，所在线程在分配函数中写，其他线程只读
+ */
+struct RtAllocShared {
+    std::atomic<bool> used{false};
+    char name[RT_ALLOC_NAME_LEN];
+    std::atomic<uint64_t> allocs{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> exempt{0};
+    std::atomic<uint32_t> last_size{0};
+};
+
+static RtAllocShared g_threads[RT_ALLOC_MAX_THREADS];
+static std::atomic<int> g_thread_count(0);
+static std::mutex g_register_mutex;           // 只在登记时使用
+static uint64_t g_reported[RT_ALLOC_MAX_THREADS];  // rt_alloc_check()已报告的次数，只由报告线程访问
+
+// 分配函数中访问，使用initial-exec模型保证访问线程变量本身不会分配内存
+static thread_local int t_slot __attribute__((tls_model("initial-exec"))) = -1;
+static thread_local int t_exempt __attribute__((tls_model("initial-exec"))) = 0;
+
+// 按名称查找或新建登记项，登记表已满时返回-1
+static int register_thread(const char* name) {
+    std::lock_guard<std::mutex> lock(g_register_mutex);
+    int n = g_thread_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < n; ++i) {
+        if (strncmp(g_threads[i].name, name, RT_ALLOC_NAME_LEN) == 0) return i;
+    }
+    if (n >= RT_ALLOC_MAX_THREADS) {
+        std::cerr << "Allocation guard table full, " << name << " is not tracked" << std::endl;
+        return -1;
+    }
+    snprintf(g_threads[n].name, RT_ALLOC_NAME_LEN, "%s", name);
+    g_threads[n].used.store(true, std::memory_order_release);
+    g_thread_count.store(n + 1, std::memory_order_release);
+    return n;
+}
+
+void rt_alloc_guard_arm(const char* name) {
+    if (!rt_alloc_trace_enabled() || t_slot >= 0) return;
+    const RtTaskSpec_t* spec = rt_current_task();
+    if (spec != nullptr) name = spec->name;
+    t_slot = register_thread(name != nullptr ? name : "thread");
+}
+
+void rt_alloc_guard_disarm() {
+    t_slot = -1;
+}
+
+RtAllocExempt::RtAllocExempt() {
+    t_exempt++;
+}
+
+RtAllocExempt::~RtAllocExempt() {
+    t_exempt--;
+}
+
+#ifdef RT_ALLOC_TRACE
+
+// glibc的实际分配函数
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+}
+
+static inline void note_alloc(size_t size) {
+    int slot = t_slot;
+    if (slot < 0) return;
+    RtAllocShared& st = g_threads[slot];
+    if (t_exempt > 0) {
+        bump(st.exempt);
+        return;
+    }
+    bump(st.allocs);
+    bump(st.bytes, size);
+    st.last_size.store((uint32_t)size, std::memory_order_relaxed);
+}
+
+// 替换分配函数，程序中和动态库中(包括operator new)的分配都经过这里
+extern "C" {
+
+void* malloc(size_t size) {
+    note_alloc(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    note_alloc(n * size);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    note_alloc(size);
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    note_alloc(size);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    note_alloc(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+    note_alloc(size);
+    void* p = __libc_memalign(alignment, size);
+    if (p == nullptr) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+}
+
+bool rt_alloc_trace_enabled() {
+    return true;
+}
+
+#else
+
+bool rt_alloc_trace_enabled() {
+    return false;
+}
+
+#endif // RT_ALLOC_TRACE
+
+int rt_alloc_thread_count() {
+    return g_thread_count.load(std::memory_order_acquire);
+}
+
+bool get_rt_alloc_stats(int index, RtAllocStats_t& out) {
+    if (index < 0 || index >= rt_alloc_thread_count()) return false;
+    const RtAllocShared& st = g_threads[index];
+    if (!st.used.load(std::memory_order_acquire)) return false;
+    memcpy(out.name, st.name, RT_ALLOC_NAME_LEN);
+    out.allocs = st.allocs.load(std::memory_order_relaxed);
+    out.bytes = st.bytes.load(std::memory_order_relaxed);
+    out.exempt = st.exempt.load(std::memory_order_relaxed);
+    out.last_size = st.last_size.load(std::memory_order_relaxed);
+    return true;
+}
+
+uint64_t rt_alloc_total() {
+    uint64_t total = 0;
+    RtAllocStats_t st;
+    int n = rt_alloc_thread_count();
+    for (int i = 0; i < n; ++i) {
+        if (get_rt_alloc_stats(i, st)) total += st.allocs;
+    }
+    return total;
+}
+
+uint64_t rt_alloc_check() {
+    uint64_t fresh = 0;
+    RtAllocStats_t st;
+    int n = rt_alloc_thread_count();
+    for (int i = 0; i < n; ++i) {
+        if (!get_rt_alloc_stats(i, st) || st.allocs == g_reported[i]) continue;
+        uint64_t delta = st.allocs - g_reported[i];
+        std::cerr << "[RT][ALLOC] " << st.name << ": " << delta << " allocation(s) on the real-time path"
+                  << " (last " << st.last_size << " bytes)" << std::endl;
+        g_reported[i] = st.allocs;
+        fresh += delta;
+    }
+    return fresh;
+}
+
+/**
+ * 打印全部线程热身结束后的分配统计
+ */
+void print_rt_alloc_statistics() {
+    if (!rt_alloc_trace_enabled()) {
+        std::cout << "Allocation guard not compiled (RT_ALLOC_TRACE)\n" << std::endl;
+        return;
+    }
+    std::cout << "RT thread            |   Allocs |      Bytes | Last size | Exempt\n";
+    std::cout << "---------------------|----------|------------|-----------|---------\n";
+    RtAllocStats_t st;
+    int n = rt_alloc_thread_count();
+    for (int i = 0; i < n; ++i) {
+        if (!get_rt_alloc_stats(i, st)) continue;
+        printf("%-20s | %8lu | %10lu | %9u | %7lu\n", st.name, st.allocs, st.bytes, st.last_size, st.exempt);
+    }
+    std::cout << std::endl;
+}
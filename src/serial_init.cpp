@@ -4,72 +4,111 @@
 #include <unistd.h>
 #include <cstring>
 #include <cerrno>
+#include <algorithm>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
 #include "serial_init.hpp"
+#include "rt_util.hpp"
 #include <thread>
 /**
- * 发送数据包并等待响应
+ * 发送数据包并等待响应（使用临时解析器，兼容旧接口）
  */
 bool send_command_and_wait(int fd, Motor::ControlData_t& cmd, Motor::RecvData_t& response, int motor_id) {
-    // 清空输入缓冲区
-    tcflush(fd, TCIFLUSH);
+    MotorFrameParser parser;
+    return send_command_and_wait(fd, cmd, response, motor_id, parser);
+}
+
+/**
+ * 发送数据包并等待响应
+ * 串口数据经通道的流式解析器拼帧，半帧或错位的数据只需等待后续字节，不再触发超时重试。
+ * 串口配置为VMIN=sizeof(RecvData_t)、VTIME=0，ppoll在收齐一整帧时才唤醒，
+ * 正常情况下每条命令只有write、ppoll、read三次系统调用；只在超时后才清空输入缓冲区
+ */
+bool send_command_and_wait(int fd, Motor::ControlData_t& cmd, Motor::RecvData_t& response, int motor_id,
+                           MotorFrameParser& parser, SerialIoStats_t* stats, long timeout_us) {
+    SerialIoStats_t local_stats = {0, 0, 0, 0};
+    SerialIoStats_t& st = stats ? *stats : local_stats;
+    st.commands++;
+
+    // 丢弃上一条命令残留的半帧，迟到的整帧由电机ID过滤
+    parser.reset();
 
     // 发送命令
     ssize_t bytes_written = write(fd, &cmd, sizeof(Motor::ControlData_t));
+    st.syscalls++;
     if (bytes_written != sizeof(Motor::ControlData_t)) {
         std::cerr << "Failed to send command to motor " << motor_id
                   << ". Bytes written: " << bytes_written << std::endl;
         return false;
     }
 
-    // 设置超时计时器
-    auto start_time = std::chrono::steady_clock::now();
+    // 设置超时时刻
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_us);
 
     // 等待响应
-    uint8_t recv_buffer[MAX_BUFFER_SIZE];
-    while (std::chrono::duration_cast<std::chrono::milliseconds>(
-               std::chrono::steady_clock::now() - start_time).count() < COMM_TIMEOUT_MS) {
-
-        // 检查是否有数据可读
-        fd_set readfds;
-        FD_ZERO(&readfds);//清空readfds集合
-        FD_SET(fd, &readfds);//将fd添加到readfds集合中
-
-        struct timeval timeout;
-        timeout.tv_sec = 0;//s
-        timeout.tv_usec = 1000;  // 1ms
-
-        int ready = select(fd + 1, &readfds, NULL, NULL, &timeout);
-        if (ready > 0 && FD_ISSET(fd, &readfds)) {
-            // 读取数据
-            ssize_t bytes_read = read(fd, recv_buffer, MAX_BUFFER_SIZE);
-            if (bytes_read >= sizeof(Motor::RecvData_t)) {
-                Motor::RecvData_t* recv_packet = reinterpret_cast<Motor::RecvData_t*>(recv_buffer);//将缓冲区recv_buffer转换为接收数据包结构体指针
-
-                // 验证数据包头
-                if (recv_packet->head[0] == 0xFD && recv_packet->head[1] == 0xEE) {
-                    // 验证CRC
-                    uint16_t calculated_crc = crc_ccitt(0x2cbb, 
-                        reinterpret_cast<uint8_t*>(recv_packet), sizeof(Motor::RecvData_t) - 2);
-
-                    // 验证电机ID
-                    if (calculated_crc == recv_packet->CRC16 && 
-                        recv_packet->mode.id == motor_id) {
-
-                        // 复制有效响应
-                        response = *recv_packet;
-                        return true;
-                    } else if (calculated_crc != recv_packet->CRC16) {
-                        std::cerr << "CRC error in response from motor " 
-                                  << recv_packet->mode.id << std::endl;
-                    } else if (recv_packet->mode.id != motor_id) {
-                        std::cerr << "Unexpected motor ID in response: " 
-                                  << recv_packet->mode.id << " (expected " << motor_id << ")" << std::endl;
-                    }
-                }
+    while (true) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) break;
+
+        long wait_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count();
+        // 串口按整帧长度唤醒，半帧的剩余部分不足一帧，需要短超时后主动读取
+        bool partial = parser.pending() > 0;
+        if (partial && wait_ns > RESYNC_POLL_US * 1000L) {
+            wait_ns = RESYNC_POLL_US * 1000L;
+        }
+        struct timespec timeout;
+        timeout.tv_sec = wait_ns / 1000000000;
+        timeout.tv_nsec = wait_ns % 1000000000;
+
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int ready = ppoll(&pfd, 1, &timeout, NULL);
+        st.syscalls++;
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "ppoll() failed for motor " << motor_id << ": " << strerror(errno) << std::endl;
+            break;
+        }
+
+        ssize_t bytes_read = 0;
+        if (ready > 0) {
+            // 已收齐至少一整帧
+            st.wakeups++;
+            st.last_wake_ns = steady_ns();
+            bytes_read = parser.read_from(fd);
+            st.syscalls++;
+        } else if (partial) {
+            // 半帧的剩余字节不足VMIN，按实际可读字节数读取，阻塞模式下也不会卡住
+            int avail = 0;
+            ioctl(fd, FIONREAD, &avail);
+            st.syscalls++;
+            if (avail > 0) {
+                uint8_t* p = parser.write_ptr();
+                bytes_read = read(fd, p, std::min((size_t)avail, parser.write_space()));
+                st.syscalls++;
+                if (bytes_read > 0) parser.commit(bytes_read);
             }
         }
+        if (bytes_read <= 0) continue;
+
+        // 取出所有完整帧（帧头与CRC已由解析器验证）
+        while (const Motor::RecvData_t* recv_packet = parser.next_frame()) {
+            // 验证电机ID
+            if (recv_packet->mode.id == motor_id) {
+                // 复制有效响应
+                response = *recv_packet;
+                return true;
+            }
+            std::cerr << "Unexpected motor ID in response: "
+                      << (int)recv_packet->mode.id << " (expected " << motor_id << ")" << std::endl;
+        }
     }
 
+    // 超时后清空输入缓冲区，避免迟到的应答被下一条命令读到
+    tcflush(fd, TCIFLUSH);
+    st.syscalls++;
+    parser.reset();
+
     std::cerr << "Timeout waiting for response from motor " << motor_id << std::endl;
     return false;
 }
@@ -131,8 +170,9 @@ bool configure_serial_port(int fd) {
     tty.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
 
     // 控制字符配置
-    tty.c_cc[VMIN] = 0;               // 非规范模式读取时的最小字符数
-    tty.c_cc[VTIME] = 10;             // 非规范模式读取时的超时时间(0.1秒)
+    // VMIN为一个应答帧的长度且VTIME为0时，poll/read在收齐一整帧后才唤醒线程
+    tty.c_cc[VMIN] = sizeof(Motor::RecvData_t);  // 非规范模式读取时的最小字符数
+    tty.c_cc[VTIME] = 0;                          // 不使用字符间超时，超时由ppoll控制
 
     // 清空输入输出缓冲区
     tcflush(fd, TCIOFLUSH);
@@ -143,5 +183,14 @@ bool configure_serial_port(int fd) {
         return false;
     }
 
+    // 开启驱动的低延时模式(不支持的驱动忽略)，收到数据立即推送给行规程而不是等待批量处理
+    struct serial_struct serial;
+    if (ioctl(fd, TIOCGSERIAL, &serial) == 0) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        if (ioctl(fd, TIOCSSERIAL, &serial) != 0) {
+            std::cerr << "Warning: failed to enable low latency mode: " << strerror(errno) << std::endl;
+        }
+    }
+
     return true;
 }
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "telemetry.hpp"
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include "spsc_ring.hpp"
+#include "rt_executor.hpp"
+#include "rt_util.hpp"
+
+static SpscRing<TelemetryRecord_t, TELEMETRY_RING_SIZE> g_ring;
+static std::atomic<bool> g_active(false);   // 生产者是否写入队列
+static std::atomic<bool> g_draining(false); // 写盘线程是否继续等待新记录
+static std::thread g_writer;
+static int g_fd = -1;
+
+// 生产者写，其他线程只读
+static std::atomic<uint64_t> g_recorded(0);
+static std::atomic<uint64_t> g_dropped(0);
+static uint32_t g_seq = 0;
+// 写盘线程写，其他线程只读
+static std::atomic<uint64_t> g_written(0);
+static std::atomic<uint64_t> g_bytes(0);
+
+// 完整写入一段数据，被信号打断时继续
+static bool write_all(int fd, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+/**
+ * 写盘线程
+ * 由执行器以普通调度策略、较低的nice值启动。每次把队列中的记录拷到暂存区，
+ * 攒满TELEMETRY_WRITE_BATCH条或队列已空时一次性写入，避免每条记录一次系统调用
+ */
+static void telemetry_writer_thread() {
+    std::vector<TelemetryRecord_t> batch(TELEMETRY_WRITE_BATCH);
+    bool write_ok = true;
+    while (true) {
+        bool draining = g_draining.load(std::memory_order_acquire);
+        size_t n = 0;
+        while (n < batch.size()) {
+            const TelemetryRecord_t* rec = g_ring.peek();
+            if (rec == nullptr) break;
+            batch[n++] = *rec;
+            g_ring.release();
+        }
+
+        if (n > 0 && write_ok) {
+            size_t len = n * sizeof(TelemetryRecord_t);
+            if (!write_all(g_fd, batch.data(), len)) {
+                std::cerr << "Telemetry write failed: " << strerror(errno) << std::endl;
+                write_ok = false;  // 继续取出记录，保证生产者不会一直丢弃
+            } else {
+                bump(g_written, n);
+                bump(g_bytes, len);
+            }
+        }
+
+        if (n == batch.size()) continue;  // 可能还有积压
+        if (!draining) break;             // 已停止且队列已空
+        std::this_thread::sleep_for(std::chrono::milliseconds(TELEMETRY_FLUSH_MS));
+    }
+}
+
+bool telemetry_start(const char* path) {
+    if (g_fd >= 0) return false;
+    g_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (g_fd < 0) {
+        std::cerr << "Failed to open telemetry file " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    TelemetryFileHeader_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TELEMETRY_MAGIC, sizeof(TELEMETRY_MAGIC));
+    header.version = TELEMETRY_VERSION;
+    header.record_size = sizeof(TelemetryRecord_t);
+    header.num_joints = NUM_JOINTS;
+    header.start_steady_ns = steady_ns();
+    header.start_unix_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (!write_all(g_fd, &header, sizeof(header))) {
+        std::cerr << "Failed to write telemetry header: " << strerror(errno) << std::endl;
+        close(g_fd);
+        g_fd = -1;
+        return false;
+    }
+    g_bytes.store(sizeof(header), std::memory_order_relaxed);
+
+    // 预先分配队列内存，避免实时线程第一轮写入时触发缺页
+    g_ring.prefault();
+    g_draining.store(true, std::memory_order_release);
+    RtTaskSpec_t spec = {"telemetry_writer", 0, 0, 10, 0, 0, 0, OverrunPolicy::SKIP};
+    g_writer = rt_spawn(spec, telemetry_writer_thread);
+    g_active.store(true, std::memory_order_release);
+    std::cout << "Telemetry recording to " << path << " (" << sizeof(TelemetryRecord_t) << " bytes/record)" << std::endl;
+    return true;
+}
+
+void telemetry_stop() {
+    if (g_fd < 0) return;
+    g_active.store(false, std::memory_order_release);
+    g_draining.store(false, std::memory_order_release);
+    g_writer.join();
+    close(g_fd);
+    g_fd = -1;
+}
+
+TelemetryRecord_t* telemetry_begin() {
+    if (!g_active.load(std::memory_order_relaxed)) return nullptr;
+    TelemetryRecord_t* rec = g_ring.claim();
+    if (rec == nullptr) {
+        bump(g_dropped);
+        g_seq++;  // 序号照常递增，读取时可以看出丢弃的位置
+    }
+    return rec;
+}
+
+void telemetry_commit(TelemetryRecord_t* rec) {
+    rec->seq = g_seq++;
+    rec->stamp_ns = steady_ns();
+    g_ring.publish();
+    bump(g_recorded);
+}
+
+TelemetryStats_t get_telemetry_stats() {
+    TelemetryStats_t out;
+    out.recorded = g_recorded.load(std::memory_order_relaxed);
+    out.dropped = g_dropped.load(std::memory_order_relaxed);
+    out.written = g_written.load(std::memory_order_relaxed);
+    out.bytes = g_bytes.load(std::memory_order_relaxed);
+    out.queued = (uint32_t)g_ring.size();
+    out.active = g_active.load(std::memory_order_relaxed);
+    return out;
+}
+
+/**
+ * 打印遥测统计
+ */
+void print_telemetry_statistics() {
+    TelemetryStats_t st = get_telemetry_stats();
+    std::cout << "Telemetry | Recorded | Dropped |  Written | Queued | Bytes\n";
+    std::cout << "----------|----------|---------|----------|--------|---------\n";
+    printf("%9s | %8lu | %7lu | %8lu | %6u | %lu\n", st.active ? "on" : "off",
+           st.recorded, st.dropped, st.written, st.queued, st.bytes);
+    std::cout << std::endl;
+}
@@ -0,0 +1,57 @@
+/**
+ * 扁平权重导出
+ * 以POLICY_CPU_NATIVE加载TorchScript模型，把提取并打包好的权重写成PolicyMlp::map()可直接映射的文件，
+ * 文件头记录模型文件的指纹(大小和CRC32C)。再映射回来与内存中的执行器在随机输入上逐位比较输出。
+ * 机器人上的init_policy()找到该文件并且指纹与模型文件一致时不再加载TorchScript
+ *
+ * 用法: policy_export <模型文件> [输出文件，默认为POLICY_FLAT_PATH]
+ */
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include "algorithm_control.hpp"
+
+#define EXPORT_CHECK_TRIALS 100  // 导出后比较的随机输入组数
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <model.pt> [out.policy]\n";
+        return 1;
+    }
+    const char* out_path = argc > 2 ? argv[2] : POLICY_FLAT_PATH;
+
+    RL_ROTDOG policy;
+    policy.model_path = argv[1];
+    policy.use_cuda = false;
+    policy.cpu_mode = POLICY_CPU_NATIVE;
+    policy.load_policy();
+    if (!policy.native_active()) {
+        std::cerr << argv[1] << " cannot be run by the native executor, nothing exported" << std::endl;
+        return 1;
+    }
+    PolicySourceId_t source;
+    if (!policy_source_id(argv[1], source) || !policy.native.save(out_path, source)) return 1;
+
+    PolicyMlp mapped;
+    if (!mapped.map(out_path)) return 1;
+    const PolicyMlpDims_t& d = mapped.dims();
+    std::mt19937 rng(0);
+    std::normal_distribution<float> dist(0.0f, 0.5f);
+    std::vector<float> hist(d.hist_rows * d.obs_dim), obs(d.obs_dim), a(d.action_dim), b(d.action_dim);
+    for (int t = 0; t < EXPORT_CHECK_TRIALS; ++t) {
+        for (float& v : hist) v = dist(rng);
+        for (float& v : obs) v = dist(rng);
+        policy.native.forward(hist.data(), obs.data(), a.data());
+        mapped.forward(hist.data(), obs.data(), b.data());
+        if (memcmp(a.data(), b.data(), a.size() * sizeof(float)) != 0) {
+            std::cerr << out_path << ": mapped weights give different actions" << std::endl;
+            return 1;
+        }
+    }
+    printf("exported %s: %u ops, obs %u x (%u history + 1), latent %u, %u experts, %u actions, %u KB weights\n",
+           out_path, d.num_ops, d.obs_dim, d.hist_rows, d.latent_dim, d.experts, d.action_dim,
+           (unsigned)(d.arena_floats * sizeof(float) / 1024));
+    return 0;
+}